@@ -33,6 +33,12 @@ typedef struct List{
      Item *data;
 }List;
 
+#define LIST_JACCARD 0
+#define LIST_OVERLAP 1
+
+#define LIST_MERGE_HEAP_MAX 64
+#define LIST_MERGE_DENSE_FACTOR 8
+
 typedef struct Score{
 	double value;
 	uint index;
@@ -83,12 +89,15 @@ void list_append(List *, List *);
 void list_add(List *, List *);
 List list_union(List *, List *);
 uint list_union_size(List *, List *);
+List list_merge_multi(List **, uint);
 List list_intersection(List *, List *);
 uint list_intersection_size(List *, List *);
 List list_difference(List *, List *);
 uint list_difference_size(List *, List *);
 double list_jaccard(List *, List *);
 double list_overlap(List *, List *);
+uint list_min_intersection_size(uint, uint, int, double);
+int list_similarity_above(List *, List *, int, double);
 double list_weighted_similarity(List *, List *, double *);
 double list_histogram_intersection(List *, List *);
 double list_weighted_histogram_intersection(List *, List *, double *);
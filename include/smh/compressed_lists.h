@@ -0,0 +1,118 @@
+/**
+ * @file compressed_lists.h
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Declaration of structures and functions on compressed lists
+ *        (blocks of delta-encoded and bit-packed sorted items)
+ */
+#ifndef COMPRESSED_LISTS_H
+#define COMPRESSED_LISTS_H
+
+#include "listdb.h"
+
+#define CLIST_BLOCK_SIZE 128
+#define CLISTDB_MAGIC "SMHCLSDB"
+#define CLISTDB_VERSION 1
+#define CLISTDB_ZLIB 1 // blocks are compressed with zlib
+#define CLISTDB_BLOCK_BYTES 1048576 // encoded bytes of lists per block
+
+/**
+ * A compressed list stores its items in blocks of CLIST_BLOCK_SIZE. The
+ * buffer starts with a directory holding the first item and the byte
+ * offset of each block, followed by the blocks. Each block has a byte with
+ * the bit width of the deltas, a byte with the bit width of the
+ * frequencies (0 when all frequencies are 1) and the packed values.
+ */
+typedef struct CList {
+     uint size;
+     uint bytes;
+     uchar *data;
+} CList;
+
+typedef struct CListIter {
+     CList *list;
+     uint block;
+     uint position;
+     uint count;
+     Item items[CLIST_BLOCK_SIZE];
+} CListIter;
+
+typedef struct CListDB {
+     uint size;
+     uint dim;
+     CList *lists;
+} CListDB;
+
+/**
+ * A list database container starts with a CListDBHeader, followed by the
+ * block index (one CListDBBlock per block) and the blocks, each aligned to
+ * 8 bytes. A block holds consecutive lists encoded as compressed lists
+ * (size, number of bytes and data padded to 4 bytes). When CLISTDB_ZLIB is
+ * set, blocks that shrink are additionally compressed with zlib, which is
+ * signaled by a stored size smaller than the raw size.
+ */
+typedef struct CListDBHeader {
+     char magic[8];
+     uint version;
+     uint flags;
+     ullong size;
+     ullong dim;
+     ullong number_of_blocks;
+} CListDBHeader;
+
+typedef struct CListDBBlock {
+     ullong offset;
+     ullong first;
+     ullong stored;
+     ullong raw;
+} CListDBBlock;
+
+typedef struct CListDBFile {
+     CListDBHeader *header;
+     CListDBBlock *index;
+     size_t mapping_size;
+} CListDBFile;
+
+/************************ Function prototypes ************************/
+void clist_init(CList *);
+CList clist_encode(List *);
+List clist_decode(CList *);
+void clist_decode_into(CList *, List *);
+void clist_destroy(CList *);
+void clist_print(CList *);
+uint clist_number_of_blocks(CList *);
+void clist_iter_init(CListIter *, CList *);
+Item *clist_iter_next(CListIter *);
+Item *clist_iter_seek(CListIter *, uint);
+List clist_union(CList *, CList *);
+List clist_intersection(CList *, CList *);
+uint clist_intersection_size(CList *, CList *);
+uint clist_intersection_size_list(CList *, List *);
+double clist_jaccard(CList *, CList *);
+double clist_overlap(CList *, CList *);
+void clistdb_init(CListDB *);
+CListDB clistdb_from_listdb(ListDB *);
+ListDB clistdb_to_listdb(CListDB *);
+void clistdb_destroy(CListDB *);
+size_t clistdb_memory(CListDB *);
+void clistdb_save(char *, ListDB *, uint);
+int clistdb_is_container(char *);
+void clistdb_file_open(CListDBFile *, char *);
+void clistdb_file_close(CListDBFile *);
+List clistdb_file_get(CListDBFile *, uint);
+ListDB clistdb_file_range(CListDBFile *, uint, uint);
+ListDB clistdb_load(char *);
+#endif
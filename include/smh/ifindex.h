@@ -21,14 +21,159 @@
 #define IFINDEX_H
 
 #include "listdb.h"
+#include "compressed_lists.h"
+#include "roaring.h"
 #include "weights.h"
 
+#define IFINDEX_QUERY_BATCH 4096 // queries answered at once when pruning
+#define IFINDEX_SKIP_MAGIC "SMHIFSKP"
+#define IFINDEX_SKIP_BLOCK 128 // postings covered by each skip entry
+#define IFINDEX_SKIP_FACTOR 8 // lists searched with skips are this many times longer
+#define IFINDEX_CACHE_CAPACITY 67108864 // default bytes of cached query results
+#define IFINDEX_CACHE_BUCKETS 65536
+
+/**
+ * Skip entry of a block of a posting list: document id of the last
+ * posting of the block and position of its first posting in the list.
+ */
+typedef struct IFSkip {
+     uint last;
+     uint position;
+} IFSkip;
+
+/**
+ * Trailer of an inverted file saved by ifindex_save, after the items of
+ * the binary list database. It is followed by the largest frequency of
+ * each list (uint, padded to 8 bytes), size + 1 offsets (ullong) to the
+ * first skip entry of each list and the skip entries. Lists with at
+ * most block_size postings have no skip entries. Document frequencies
+ * are the sizes of the lists, given by the offsets of the list database.
+ */
+typedef struct IFSkipHeader {
+     char magic[8];
+     uint block_size;
+     uint reserved;
+     ullong number_of_skips;
+} IFSkipHeader;
+
+/**
+ * Skip pointers and list metadata of a mapped inverted file.
+ */
+typedef struct IFSkips {
+     uint block_size;
+     uint *maxfreq;
+     ullong *starts;
+     IFSkip *skips;
+} IFSkips;
+
+/**
+ * Dense accumulator of document hits used by queries. counts holds the
+ * hits of every document and touched the documents with a nonzero count,
+ * so it is cleared in time proportional to the retrieved documents and
+ * can be reused by all the queries of a thread.
+ */
+typedef struct IFAccumulator {
+     uint dim;
+     uint size;
+     uint *counts;
+     uint *touched;
+} IFAccumulator;
+
+/**
+ * Inverted file split into partitions of consecutive documents, which
+ * are built, stored and queried independently. Partition i holds the
+ * documents offsets[i] .. offsets[i] + parts[i].dim - 1 with local ids
+ * starting at 0, and may have fewer lists than the vocabulary (vocsize)
+ * if the last items do not occur in its documents. skips are the skip
+ * pointers of mapped partitions and maxfreq the largest frequency of
+ * each list of the other ones (NULL for mapped partitions).
+ */
+typedef struct IFPartitions {
+     uint size;
+     uint dim;
+     uint vocsize;
+     ListDB *parts;
+     uint *offsets;
+     IFSkips *skips;
+     uint **maxfreq;
+} IFPartitions;
+
+/**
+ * Cached result of a query, stored as raw bytes. param is the other
+ * argument of the query (e.g. its minimum number of hits or number of
+ * retrieved documents). Entries are chained in their bucket (next) and
+ * from the most to the least recently used (older/newer).
+ */
+typedef struct IFCacheEntry {
+     ullong key;
+     List query;
+     uint param;
+     void *value;
+     size_t bytes;
+     struct IFCacheEntry *next;
+     struct IFCacheEntry *newer;
+     struct IFCacheEntry *older;
+} IFCacheEntry;
+
+/**
+ * Bounded cache of query results of one inverted file (and weighting).
+ * The least recently used entries are evicted to keep the memory of the
+ * cached queries and results (bytes) below capacity. It can be shared
+ * by threads.
+ */
+typedef struct IFCache {
+     size_t capacity;
+     size_t bytes;
+     uint size;
+     IFCacheEntry **buckets;
+     IFCacheEntry *newest;
+     IFCacheEntry *oldest;
+     ullong hits;
+     ullong misses;
+     ullong evictions;
+} IFCache;
+
 /************************ Function prototypes ************************/
+IFAccumulator ifindex_accumulator_create(uint);
+void ifindex_accumulator_destroy(IFAccumulator *);
+List ifindex_query_threshold(ListDB *, List *, uint, IFAccumulator *);
 List ifindex_query(ListDB *, List *);
+IFCache ifindex_cache_create(size_t);
+void ifindex_cache_destroy(IFCache *);
+void *ifindex_cache_get(IFCache *, List *, uint, size_t *);
+void ifindex_cache_put(IFCache *, List *, uint, void *, size_t);
+List ifindex_query_cached(ListDB *, List *, uint, IFCache *, IFAccumulator *);
+void ifindex_max_frequencies(ListDB *, uint *);
+uint ifindex_query_topk(ListDB *, List *, double *, uint *, uint, Score *);
+void ifindex_query_batch(ListDB *, ListDB *, uint *, IFCache *, ListDB *);
 ListDB ifindex_query_multi(ListDB *, ListDB *);
+List ifindex_query_compressed(CListDB *, List *);
+List ifindex_query_compressed_threshold(CListDB *, List *, uint, IFAccumulator *);
+List ifindex_query_roaring(RoaringDB *, List *);
+List ifindex_query_roaring_threshold(RoaringDB *, List *, uint, IFAccumulator *);
 void ifindex_discard_less_frequent(ListDB *, uint);
 void ifindex_discard_more_frequent(ListDB *, uint);
 void ifindex_rank_more_frequent(ListDB *);
 ListDB ifindex_make_from_corpus(ListDB *);
+ListDB ifindex_make_from_corpus_arena(ListDB *);
+ListDB ifindex_make_from_reader(ListDBReader *);
+ListDB ifindex_merge(ListDB *, uint, uint *);
+ListDB ifindex_make_from_manifest(ListDBManifest *);
+void ifindex_append(ListDB *, ListDB *, uint);
+void ifindex_save(char *, ListDB *);
+int ifindex_skips_open(IFSkips *, ListDB *);
+uint ifindex_skip_seek(ListDB *, IFSkips *, uint, uint, uint);
+uint ifindex_intersection_size(ListDB *, IFSkips *, uint, List *);
+IFPartitions ifindex_partitions_make(ListDB *, uint);
+IFPartitions ifindex_partitions_from_manifest(ListDBManifest *);
+IFPartitions ifindex_partitions_load(char *);
+void ifindex_partitions_save(char *, IFPartitions *, uint);
+void ifindex_partitions_destroy(IFPartitions *);
+List ifindex_partitions_query(IFPartitions *, List *);
+void ifindex_partitions_query_batch(IFPartitions *, ListDB *, uint *, ListDB *);
+uint ifindex_partitions_query_topk(IFPartitions *, List *, double *, uint, Score *);
+void ifindex_partitions_split(IFPartitions *, List *, List *);
+uint ifindex_partitions_intersection_size(IFPartitions *, uint, List *);
 void ifindex_weight(ListDB *, ListDB *, double (*)(uint, uint, uint, uint, uint, uint));
+void ifindex_weight_stats(ListDB *, StatsFile *, double (*)(uint, uint, uint, uint, uint, uint));
 #endif
@@ -20,20 +20,120 @@
 #ifndef LISTDB_H
 #define LISTDB_H
 
+#include <stdio.h>
 #include "array_lists.h"
 
+#define LISTDB_MAGIC "SMHLSTDB"
+#define LISTDB_VERSION 1
+#define LISTDB_FREQ 1 // items are stored with their frequencies
+#define LISTDB_TRAILER 2 // more sections follow the items (e.g. skip pointers)
+#define LISTDB_CHUNK_SIZE 4194304 // bytes of text parsed by each task
+#define LISTDB_BATCH_ITEMS 16777216 // default number of items read in a batch
+#define LISTDB_WRITE_GROUP 16 // chunks formatted in parallel before being written
+#define LISTDB_MANIFEST_MAGIC "#smh-manifest"
+#define LISTDB_HEAP 0 // each list owns its items
+#define LISTDB_MAPPED 1 // lists are views of a file mapping
+#define LISTDB_ARENA 2 // lists are slices of a single heap buffer
+#define LISTDB_ACCESS_NORMAL 0 // no particular order of access to a mapping
+#define LISTDB_ACCESS_SEQUENTIAL 1 // lists are read in order (e.g. sketching)
+#define LISTDB_ACCESS_RANDOM 2 // lists are read in any order (e.g. queries)
+
+/**
+ * Access statistics of a database. Pages are the pages of the storage
+ * covered by the lists that were read, each one counted once.
+ */
+typedef struct ListDBAccess{
+     ullong lists;
+     ullong bytes;
+     ullong pages;
+     size_t page_size;
+     uchar *touched;
+}ListDBAccess;
+
+/**
+ * Lists of a memory-mapped database are read-only views of the mapping
+ * and lists of an arena database are slices of a single buffer. In both
+ * cases the storage is released at once when the database is destroyed.
+ * A list is copied out of the storage by listdb_detach_list before it is
+ * resized (detached is then set), and listdb_destroy_list only frees the
+ * lists that own their items. Reads are only counted if access is set
+ * (see listdb_track_access).
+ */
 typedef struct ListDB{
      uint size;
      uint dim;
      List *lists;
+     void *mapping;
+     size_t mapping_size;
+     uint storage;
+     uint detached;
+     ListDBAccess *access;
 }ListDB;
 
+/**
+ * Header of the binary format. It is followed by size + 1 offsets
+ * (ullong) to the first item of each list and by the items, stored as
+ * Item records if LISTDB_FREQ is set and as uint ids otherwise. If
+ * LISTDB_TRAILER is set, the file goes on after the items with sections
+ * that list database readers ignore (see ifindex_save).
+ */
+typedef struct ListDBHeader{
+     char magic[8];
+     uint version;
+     uint flags;
+     ullong size;
+     ullong dim;
+     ullong number_of_items;
+}ListDBHeader;
+
+/**
+ * Shards of a list database. The lists of shard i get ids starting at
+ * offsets[i].
+ */
+typedef struct ListDBManifest{
+     uint size;
+     char **paths;
+     uint *offsets;
+}ListDBManifest;
+
+/**
+ * Reads a text or binary list database in batches of bounded size, so
+ * databases larger than memory can be processed. The number of lists
+ * and the dimensionality are known once a whole pass has been done
+ * (counted = 1), or right away for binary files. The shards of a
+ * manifest are read one at a time (source is the file being read).
+ */
+typedef struct ListDBReader{
+     char *filename;
+     uint max_items;
+     uint position;
+     uint batch_start;
+     uint size;
+     uint dim;
+     ullong number_of_items;
+     ullong item_position;
+     int counted;
+     FILE *file;
+     char *line;
+     size_t line_size;
+     ListDBHeader *header;
+     size_t mapping_size;
+     char *source;
+     uint source_position;
+     ListDBManifest manifest;
+     uint shard;
+}ListDBReader;
+
 /************************ Function prototypes ************************/
 void listdb_init(ListDB *);
 ListDB listdb_create(uint, uint);
+ListDB listdb_create_arena(uint, uint, uint *);
+ListDB listdb_create_sized(uint, uint, uint *);
 ListDB listdb_random(uint, uint, uint);
 void listdb_clear(ListDB *);
 void listdb_destroy(ListDB *);
+void listdb_detach_list(ListDB *, uint);
+void listdb_destroy_list(ListDB *, uint);
 void listdb_print(ListDB *);
 void listdb_print_multi(ListDB *, List *);
 void listdb_print_range(ListDB *, uint, uint);
@@ -60,10 +160,36 @@ void listdb_delete_smallest(ListDB *, uint);
 void listdb_delete_largest(ListDB *, uint);
 void listdb_insert(ListDB *, List *, uint);
 void listdb_append(ListDB *, ListDB *);
+void listdb_similarity_batch(ListDB *, List *, List *, int, double, ullong *);
 void listdb_append_lists_delete(ListDB *, uint, uint);
 void listdb_append_lists_destroy(ListDB *, uint, uint);
 void listdb_add_lists_delete(ListDB *, uint, uint);
 void listdb_add_lists_destroy(ListDB *, uint, uint);
+ListDB listdb_from_csr(uint, uint, ullong *, uint *, uint *);
+void listdb_csr_indptr(ListDB *, ullong *);
+Item *listdb_contiguous_items(ListDB *);
+void listdb_to_csr(ListDB *, uint *, uint *);
+void listdb_to_dense(ListDB *, double *);
 ListDB listdb_load_from_file(char *);
+ListDB listdb_load_from_file_arena(char *);
+void listdb_write_buffer(int, char *, size_t, char *);
 void listdb_save_to_file(char *, ListDB *);
+void listdb_save_binary(char *, ListDB *);
+ListDB listdb_open_mmap(char *);
+void listdb_unmap(ListDB *);
+void listdb_advise(ListDB *, int);
+void listdb_track_access(ListDB *);
+void listdb_record_access(ListDB *, uint);
+int listdb_is_binary(char *);
+ListDB listdb_load(char *);
+ListDB listdb_load_arena(char *);
+int listdb_is_manifest(char *);
+ListDBManifest listdb_manifest_load(char *);
+void listdb_manifest_destroy(ListDBManifest *);
+ListDB listdb_load_manifest(ListDBManifest *);
+void listdb_reader_open(ListDBReader *, char *, uint);
+uint listdb_reader_next_batch(ListDBReader *, ListDB *);
+void listdb_reader_rewind(ListDBReader *);
+void listdb_reader_count(ListDBReader *);
+void listdb_reader_close(ListDBReader *);
 #endif
@@ -23,10 +23,44 @@
 
 #include "minhash.h"
 
+/**
+ * Database clustered by mhlink_cluster_db. store hashes its lists into a
+ * hash table, neighbors links a list with the lists of its bucket that
+ * are more similar than thres according to sim and member gives the
+ * items of a list, decoding them into a buffer if needed. name tells
+ * what is clustered in progress messages.
+ */
+typedef struct MHLinkDB {
+     void *db;
+     uint size;
+     uint dim;
+     char *name;
+     double thres;
+     union {
+          double (*lists)(List *, List *);
+          double (*clists)(CList *, CList *);
+          double (*sets)(Set *, Set *);
+     } sim;
+     void (*store)(struct MHLinkDB *, HashTable *, uint *);
+     void (*neighbors)(struct MHLinkDB *, ListDB *, uint, List *, uint *, uint *);
+     List *(*member)(struct MHLinkDB *, uint, List *);
+} MHLinkDB;
+
+ListDB mhlink_make_model_db(MHLinkDB *, ListDB *);
 ListDB mhlink_make_model(ListDB *, ListDB *);
+ListDB mhlink_make_model_compressed(CListDB *, ListDB *);
+ListDB mhlink_make_model_sets(SetDB *, ListDB *);
 void mhlink_add_neighbors(ListDB *, ListDB *, uint , List *, uint *, uint *, 
 			  double (*)(List *, List *), double);
+void mhlink_add_neighbors_compressed(CListDB *, ListDB *, uint , List *, uint *, uint *, 
+                                     double (*)(CList *, CList *), double);
+void mhlink_add_neighbors_sets(SetDB *, ListDB *, uint , List *, uint *, uint *, 
+                               double (*)(Set *, Set *), double);
+ListDB mhlink_cluster_db(MHLinkDB *, uint, uint, uint, uint);
 ListDB mhlink_cluster(ListDB *, uint, uint, uint, double (*)(List *, List *), double, uint);
 ListDB mhlink_cluster_weighted(ListDB *, uint, uint, uint, double *,
                                double (*)(List *, List *), double, uint);
+ListDB mhlink_cluster_compressed(CListDB *, uint, uint, uint, double (*)(CList *, CList *),
+                                 double, uint);
+ListDB mhlink_cluster_sets(SetDB *, uint, uint, uint, double (*)(Set *, Set *), double, uint);
 #endif
@@ -21,6 +21,8 @@
 #define MINHASH_H
 
 #include "listdb.h"
+#include "compressed_lists.h"
+#include "sets.h"
 
 typedef struct RandomValue
 {
@@ -66,10 +68,19 @@ void mh_weight_permutations(uint, uint, RandomValue *, double *);
 int mh_random_value_compare(const void *, const void *);
 ullong mh_compute_minhash(List *, RandomValue *);
 void mh_univhash(List *, HashTable *, uint *, uint *);
+ullong mh_compute_minhash_set(Set *, RandomValue *);
+void mh_univhash_set(Set *, HashTable *, uint *, uint *);
 uint mh_get_index(List *, HashTable *);
+uint mh_get_index_set(Set *, HashTable *);
 uint mh_store_list(List *, uint, HashTable *);
+uint mh_store_set(Set *, uint, HashTable *);
+void mh_store_id(uint, uint, HashTable *);
 void mh_store_listdb(ListDB *, HashTable *, uint *);
+void mh_store_setdb(SetDB *, HashTable *, uint *);
+void mh_store_reader(ListDBReader *, HashTable *, uint *);
+void mh_store_clistdb(CListDB *, HashTable *, uint *);
 uint *mh_get_cumulative_frequency(ListDB *, ListDB *);
 ListDB mh_expand_listdb(ListDB *, uint *);
+SetDB mh_expand_setdb(ListDB *, uint *);
 double *mh_expand_weights(uint, uint *, double *);
 #endif
@@ -0,0 +1,75 @@
+/**
+ * @file roaring.h
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Declaration of structures and functions on roaring bitmaps
+ */
+#ifndef ROARING_H
+#define ROARING_H
+
+#include "listdb.h"
+
+#define ROARING_ARRAY 0
+#define ROARING_BITMAP 1
+#define ROARING_RUN 2
+
+#define ROARING_CHUNK_SIZE 65536
+#define ROARING_BITMAP_WORDS 1024
+#define ROARING_ARRAY_MAX 4096
+
+/**
+ * Each container holds the ids of a 64K chunk that share the same 16
+ * high bits (key). Array containers store the sorted low 16 bits, bitmap
+ * containers store 1024 64-bit words and run containers store pairs of
+ * (start, length - 1).
+ */
+typedef struct RoaringContainer {
+     ushort key;
+     uchar type;
+     uint cardinality;
+     uint size;
+     void *data;
+} RoaringContainer;
+
+typedef struct Roaring {
+     uint size;
+     RoaringContainer *containers;
+} Roaring;
+
+typedef struct RoaringDB {
+     uint size;
+     uint dim;
+     Roaring *bitmaps;
+} RoaringDB;
+
+/************************ Function prototypes ************************/
+void roaring_init(Roaring *);
+Roaring roaring_from_list(List *);
+List roaring_to_list(Roaring *);
+void roaring_destroy(Roaring *);
+void roaring_print(Roaring *);
+uint roaring_cardinality(Roaring *);
+int roaring_contains(Roaring *, uint);
+void roaring_accumulate(Roaring *, uint *, uint *, uint *);
+Roaring roaring_and(Roaring *, Roaring *);
+Roaring roaring_or(Roaring *, Roaring *);
+uint roaring_and_cardinality(Roaring *, Roaring *);
+size_t roaring_memory(Roaring *);
+void roaringdb_init(RoaringDB *);
+RoaringDB roaringdb_from_listdb(ListDB *);
+void roaringdb_destroy(RoaringDB *);
+size_t roaringdb_memory(RoaringDB *);
+#endif
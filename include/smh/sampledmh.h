@@ -21,11 +21,42 @@
 #define  SAMPLEDMH_H
 
 #include "minhash.h"
+#include "ifindex.h"
+
+/**
+ * Inverted file used to prune co-occurring sets (see sampledmh_prune_index).
+ * A batch of sets is answered by query_batch or, if it is NULL, by query
+ * one set at a time with an accumulator of each thread. prepare builds the
+ * state used by cooccurrences to count the documents retrieved by a set
+ * that contain an item and release destroys it (both can be NULL). skips
+ * and cache are only used by uncompressed inverted files.
+ */
+typedef struct SMHPruneIndex {
+     void *index;
+     uint dim;
+     IFSkips skips;
+     IFCache *cache;
+     void (*query_batch)(struct SMHPruneIndex *, ListDB *, uint *, ListDB *);
+     List (*query)(struct SMHPruneIndex *, List *, uint, IFAccumulator *);
+     void *(*prepare)(struct SMHPruneIndex *, List *);
+     uint (*cooccurrences)(struct SMHPruneIndex *, void *, uint, List *);
+     void (*release)(struct SMHPruneIndex *, void *);
+} SMHPruneIndex;
 
 void sampledmh_get_coitems(ListDB *, HashTable *, uint);
+void sampledmh_get_cosets(SetDB *, HashTable *, uint);
 ListDB sampledmh_expand_frequencies(ListDB *, ListDB *);
 ListDB sampledmh_expand_frequencies_and_weights(ListDB *, ListDB *, double *, double *);
 ListDB sampledmh_mine(ListDB *, uint, uint, uint, uint);
 ListDB sampledmh_mine_weighted(ListDB *, uint, uint, uint, double *, uint);
+SetDB sampledmh_mine_sets(SetDB *, uint, uint, uint, uint);
+SetDB sampledmh_mine_weighted_sets(SetDB *, uint, uint, uint, double *, uint);
+SetDB sampledmh_mine_reader(ListDBReader *, uint, uint, uint, uint);
+SetDB sampledmh_mine_weighted_reader(ListDBReader *, uint, uint, uint, double *, uint);
+void sampledmh_prune_index(SMHPruneIndex *, ListDB *, uint, uint, double, double);
 void sampledmh_prune(ListDB *, ListDB *, uint, uint, double, double);
+void sampledmh_prune_cached(ListDB *, ListDB *, uint, uint, double, double, IFCache *);
+void sampledmh_prune_partitioned(IFPartitions *, ListDB *, uint, uint, double, double);
+void sampledmh_prune_compressed(CListDB *, ListDB *, uint, uint, double, double);
+void sampledmh_prune_roaring(RoaringDB *, ListDB *, uint, uint, double, double);
 #endif
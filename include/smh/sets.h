@@ -0,0 +1,64 @@
+/**
+ * @file sets.h
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Declaration of structures and functions on sets (lists without frequencies)
+ */
+#ifndef SETS_H
+#define SETS_H
+
+#include "listdb.h"
+
+/**
+ * A set stores only the sorted ids of its items, so it uses half the
+ * memory of a List whose frequencies are all 1.
+ */
+typedef struct Set {
+     uint size;
+     uint *data;
+} Set;
+
+typedef struct SetDB {
+     uint size;
+     uint dim;
+     Set *sets;
+} SetDB;
+
+/************************ Function prototypes ************************/
+void set_init(Set *);
+void set_destroy(Set *);
+void set_push(Set *, uint);
+void set_print(Set *);
+Set set_from_list(List *);
+List set_to_list(Set *);
+uint set_intersection_size(Set *, Set *);
+double set_jaccard(Set *, Set *);
+double set_overlap(Set *, Set *);
+int set_similarity_above(Set *, Set *, int, double);
+void setdb_init(SetDB *);
+SetDB setdb_create(uint, uint);
+void setdb_destroy(SetDB *);
+void setdb_print(SetDB *);
+void setdb_push(SetDB *, Set *);
+void setdb_sort_by_size_back(SetDB *);
+void setdb_delete_smallest(SetDB *, uint);
+SetDB setdb_from_listdb(ListDB *);
+ListDB setdb_to_listdb(SetDB *);
+void setdb_similarity_batch(SetDB *, Set *, List *, int, double, ullong *);
+void setdb_save_to_file(char *, SetDB *);
+void setdb_save_binary(char *, SetDB *);
+size_t setdb_memory(SetDB *);
+#endif
@@ -23,6 +23,74 @@
 #include "listdb.h"
 #include "types.h"
 
+#define WEIGHTS_CHUNK_SIZE 65536 // weights formatted by each task
+#define WEIGHTS_MAGIC "SMHWEIGH"
+#define WEIGHTS_VERSION 2
+#define WEIGHTS_FINGERPRINT_SEED 0x9e3779b97f4a7c15ULL
+#define WEIGHTS_UNKNOWN 0 // weighting schemes stored in the header
+#define WEIGHTS_IDF 1
+#define WEIGHTS_IDS 2
+#define STATS_MAGIC "SMHSTATS"
+#define STATS_VERSION 1
+#define WEIGHTS_DEPENDS_TF 1 // arguments read by a weighting function
+#define WEIGHTS_DEPENDS_DF 2
+#define WEIGHTS_DEPENDS_DOC 4 // size or number of terms of the document
+#define WEIGHTS_TF_TABLE 256 // term frequencies with precomputed weights
+
+/**
+ * Header of the binary weights format, followed by size doubles. The
+ * fingerprint identifies the list database whose items are weighted
+ * (see weights_fingerprint), so weights computed for another corpus are
+ * rejected.
+ */
+typedef struct WeightsHeader{
+     char magic[8];
+     uint version;
+     uint scheme;
+     ullong size;
+     ullong fingerprint;
+}WeightsHeader;
+
+/**
+ * Binary weights file mapped in memory. weights points into the mapping.
+ */
+typedef struct WeightsFile{
+     WeightsHeader *header;
+     double *weights;
+     size_t mapping_size;
+}WeightsFile;
+
+/**
+ * Header of the corpus statistics file written by weights_stats_save,
+ * followed by the collection frequency of each term (ullong), the
+ * length (sum of frequencies) and number of terms of each document, and
+ * the document frequency, largest frequency and cumulative largest
+ * frequency (see mh_get_cumulative_frequency) of each term (uint).
+ */
+typedef struct StatsHeader{
+     char magic[8];
+     uint version;
+     uint reserved;
+     ullong number_of_docs;
+     ullong number_of_terms;
+     ullong number_of_items;
+}StatsHeader;
+
+/**
+ * Corpus statistics file mapped in memory. The arrays point into the
+ * mapping.
+ */
+typedef struct StatsFile{
+     StatsHeader *header;
+     ullong *cf;
+     uint *doclens;
+     uint *docterms;
+     uint *df;
+     uint *maxfreq;
+     uint *cumfreq;
+     size_t mapping_size;
+}StatsFile;
+
 double weights_termfreq(uint, uint, uint, uint, uint, uint);
 double weights_logtf(uint, uint, uint, uint, uint, uint);
 double weights_bintf(uint, uint, uint, uint, uint, uint);
@@ -42,7 +110,25 @@ double weights_logtfdr(uint, uint, uint, uint, uint, uint);
 double weights_drtf(uint, uint, uint, uint, uint, uint);
 double weights_drlogtf(uint, uint, uint, uint, uint, uint);
 uint weights_intweight(double);
+uint weights_dependencies(double (*)(uint,uint,uint,uint,uint,uint));
 double *weights_from_corpus_and_ifindex(ListDB *, ListDB *, double (*)(uint,uint,uint,uint,uint,uint));
+double *weights_from_readers(ListDBReader *, ListDBReader *, double (*)(uint,uint,uint,uint,uint,uint));
 double *weights_load_from_file(char *);
 void weights_save_to_file(char *, uint, double *);
+ullong weights_fingerprint(uint *, uint);
+ullong weights_fingerprint_listdb(ListDB *);
+ullong weights_fingerprint_reader(ListDBReader *);
+void weights_save_binary(char *, uint, double *, uint, ullong);
+int weights_is_binary(char *);
+void weights_open_mmap(WeightsFile *, char *);
+void weights_validate(WeightsFile *, ullong, uint);
+void weights_validate_listdb(WeightsFile *, ListDB *);
+void weights_close(WeightsFile *);
+void weights_stats_save(char *, ListDBReader *);
+int weights_is_stats(char *);
+void weights_stats_open(StatsFile *, char *);
+void weights_stats_validate_listdb(StatsFile *, ListDB *);
+double *weights_from_stats(StatsFile *, double (*)(uint,uint,uint,uint,uint,uint));
+double *weights_documents_from_stats(StatsFile *, double (*)(uint,uint,uint,uint,uint,uint));
+void weights_stats_close(StatsFile *);
 #endif
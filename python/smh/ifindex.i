@@ -5,5 +5,37 @@
 %}
  
 extern ListDB ifindex_make_from_corpus(ListDB *corpus);
+extern ListDB ifindex_make_from_corpus_arena(ListDB *corpus);
+extern List ifindex_query(ListDB *, List *);
+extern void ifindex_append(ListDB *, ListDB *, uint);
 
+%apply void *BUFFER { uint *query_items, uint *query_freqs, double *item_weights, uint *bounds };
+%apply void *WRITABLE_BUFFER { uint *out_maxfreq, uint *out_docs, double *out_scores };
 
+extern void ifindex_max_frequencies(ListDB *, uint *out_maxfreq);
+
+%inline %{
+/* top-k query with its terms, bounds and results in NumPy arrays */
+uint ifindex_query_topk_arrays(ListDB *ifindex, uint size, uint *query_items, uint *query_freqs,
+                               double *item_weights, uint *bounds, uint k,
+                               uint *out_docs, double *out_scores)
+{
+     uint i;
+     List query = list_create(size);
+     for (i = 0; i < size; i++) {
+          query.data[i].item = query_items[i];
+          query.data[i].freq = query_freqs != NULL ? query_freqs[i] : 1;
+     }
+
+     Score *results = (Score *) malloc(k * sizeof(Score));
+     uint retrieved = ifindex_query_topk(ifindex, &query, item_weights, bounds, k, results);
+     for (i = 0; i < retrieved; i++) {
+          out_docs[i] = results[i].index;
+          out_scores[i] = results[i].value;
+     }
+     free(results);
+     list_destroy(&query);
+
+     return retrieved;
+}
+%}
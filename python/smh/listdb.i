@@ -11,12 +11,18 @@
      static int myErr = 0;
 
      %}
+
+typedef unsigned long long ullong;
  
 extern void listdb_init(ListDB *);
 extern ListDB listdb_create(int, int);
 extern ListDB listdb_random(uint, uint, uint);
 extern void listdb_clear(ListDB *);
 extern void listdb_destroy(ListDB *);
+extern ListDB listdb_create_arena(uint, uint, uint *);
+extern ListDB listdb_create_sized(uint, uint, uint *);
+extern void listdb_detach_list(ListDB *, uint);
+extern void listdb_destroy_list(ListDB *, uint);
 extern void listdb_push(ListDB *listdb, List *list);
 extern void listdb_print(ListDB *);
 extern void listdb_print_multi(ListDB *, List *);
@@ -24,13 +30,63 @@ extern void listdb_print_range(ListDB *, uint, uint);
 extern void listdb_delete_smallest(ListDB *, uint);
 extern void listdb_delete_largest(ListDB *, uint);
 extern ListDB listdb_load_from_file(char *);
+extern ListDB listdb_load_from_file_arena(char *);
 extern void listdb_save_to_file(char *, ListDB *);
+extern void listdb_save_binary(char *, ListDB *);
+extern ListDB listdb_open_mmap(char *);
+extern void listdb_unmap(ListDB *);
+extern ListDB listdb_load(char *);
+extern ListDB listdb_load_arena(char *);
+extern void listdb_advise(ListDB *, int);
+extern void listdb_track_access(ListDB *);
 extern void listdb_apply_to_all(ListDB *, void (*)(List *));
 
+/* arrays of NumPy (or any object with the buffer protocol) are passed
+   as pointers to their memory, without copying */
+%typemap(in) void *BUFFER (Py_buffer view) {
+     if ($input != Py_None) {
+          if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS) == -1)
+               SWIG_fail;
+          $1 = ($1_ltype) view.buf;
+     }
+}
+%typemap(freearg) void *BUFFER {
+     if ($1 != NULL)
+          PyBuffer_Release(&view$argnum);
+}
+%typemap(in) void *WRITABLE_BUFFER (Py_buffer view) {
+     if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) == -1)
+          SWIG_fail;
+     $1 = ($1_ltype) view.buf;
+}
+%typemap(freearg) void *WRITABLE_BUFFER {
+     if ($1 != NULL)
+          PyBuffer_Release(&view$argnum);
+}
+%apply void *BUFFER { ullong *csr_indptr, uint *csr_indices, uint *csr_data };
+%apply void *WRITABLE_BUFFER { ullong *out_indptr, uint *out_indices, uint *out_data, double *out_array };
+
+extern ListDB listdb_from_csr(uint, uint, ullong *csr_indptr, uint *csr_indices, uint *csr_data);
+extern void listdb_csr_indptr(ListDB *, ullong *out_indptr);
+extern Item *listdb_contiguous_items(ListDB *);
+extern void listdb_to_csr(ListDB *, uint *out_indices, uint *out_data);
+extern void listdb_to_dense(ListDB *, double *out_array);
+
+typedef struct ListDBAccess{
+     ullong lists;
+     ullong bytes;
+     ullong pages;
+}ListDBAccess;
+
 typedef struct ListDB{
      uint size;
      uint dim;
      List *lists;
+     void *mapping;
+     size_t mapping_size;
+     uint storage;
+     uint detached;
+     ListDBAccess *access;
 }ListDB;
 
 typedef unsigned int uint;
@@ -60,6 +116,7 @@ typedef unsigned int uint;
                myErr = 1;
           } else{
                Item item = {id, freq};
+               listdb_detach_list($self, pos);
                list_push($self->lists + pos, item);
           }
      }
@@ -68,6 +125,7 @@ typedef unsigned int uint;
           if (pos >= $self->size) {
                myErr = 1;
           } else{
+               listdb_detach_list($self, pos);
                list_push($self->lists + pos, item);
           }
      }
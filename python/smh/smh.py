@@ -24,9 +24,10 @@
 Wrapper classes and functions for working with Sampled Min-Hashing
 """
 
-import itertools
+import ctypes
 import numpy as np
 import os
+import weakref
 from scipy.sparse import csr_matrix
 import smh_api as sa
 from math import log
@@ -36,10 +37,10 @@ def rng_init(seed):
 
 def listdb_load(filename):
     """
-    Loads a ListDB array from a given file
+    Loads a ListDB array from a given text or binary file
     """
     if os.path.isfile(filename):
-        ldb = sa.listdb_load_from_file(filename)
+        ldb = sa.listdb_load(filename)
         return ListDB(ldb = ldb)
     else:
         print filename, "does not exists"
@@ -49,28 +50,17 @@ def csr_load_from_listdb_file(listdb_file):
     """
     Returns the ListDB structure as a Compressed Sparse Row (CSR) matrix
     """
-    with open(listdb_file, 'r') as f:
-        content = f.readlines()
-        indptr = [0]
-        indices = []
-        data = []
-        for line in content:
-            for entry in line.split()[1:]:
-                term,value = entry.split(':')
-                indices.append(int(term))
-                data.append(int(value))
-            indptr.append(len(indices))
-
-    return csr_matrix((data, indices, indptr), dtype=np.uint32)
+    return listdb_load(listdb_file).tocsr()
 
 def csr_to_listdb(csr):
     """
     Converts a Compressed Sparse Row (CSR) matrix to a ListDB structure
     """
-    ldb = sa.listdb_create(csr.shape[0], csr.shape[1])
-    coo = csr.tocoo()    
-    for i,j,v in itertools.izip(coo.row, coo.col, coo.data):
-        ldb.push(int(i), int(j), int(round(v)))
+    csr = csr_matrix(csr)
+    indptr = np.ascontiguousarray(csr.indptr, dtype=np.uint64)
+    indices = np.ascontiguousarray(csr.indices, dtype=np.uint32)
+    data = np.ascontiguousarray(np.floor(csr.data + 0.5), dtype=np.uint32)
+    ldb = sa.listdb_from_csr(csr.shape[0], csr.shape[1], indptr, indices, data)
 
     return ListDB(ldb=ldb)
 
@@ -78,12 +68,7 @@ def ndarray_to_listdb(arr):
     """
     Converts a numpy multidimensional array to a ListDB structure
     """
-    ldb = sa.listdb_create(arr.shape[0], arr.shape[1])
-    for i,row in enumerate(arr):
-        for j,v in enumerate(row):
-            if v != 0:
-                ldb.push(int(i), int(j), int(round(v)))
-    return ListDB(ldb=ldb)
+    return csr_to_listdb(csr_matrix(arr))
 
 def array_to_listdb(X):
     """
@@ -140,24 +125,29 @@ class ListDB:
         Destroys ListDB structure
         """
         sa.listdb_destroy(self.ldb)
+        for ldb in getattr(self, 'retired', []):
+            sa.listdb_destroy(ldb)
 
     def push(self, arraylist):
         """
         Appends list to a ListDB structure
         """
         sa.listdb_push(self.ldb, arraylist)
+        self.maxfreq = None
 
     def pop(self):
         """
         Pops a list from a ListDB structure
         """
         sa.listdb_pop(self.ldb)
+        self.maxfreq = None
 
     def load(self, filename):
         """
-        Loads a ListDB structure from a file
+        Loads a ListDB structure from a text or binary file
         """
-        self.ldb = sa.listdb_load_from_file(filename)
+        self.ldb = sa.listdb_load(filename)
+        self.maxfreq = None
 
     def save(self, filename):
         """
@@ -165,6 +155,12 @@ class ListDB:
         """
         sa.listdb_save_to_file(filename, self.ldb)
 
+    def save_binary(self, filename):
+        """
+        Saves ListDB structure to a binary file that can be mapped in memory
+        """
+        sa.listdb_save_binary(filename, self.ldb)
+
     def show(self):
         """
         Prints ListDB structure
@@ -179,6 +175,7 @@ class ListDB:
             sa.listdb_delete_smallest(self.ldb, minsize)
         if maxsize:
             sa.listdb_delete_largest(self.ldb, maxsize)
+        self.maxfreq = None
 
     def size(self):
         """
@@ -194,9 +191,17 @@ class ListDB:
 
     def destroy(self):
         """
-        Destroys the ListDB structure
+        Destroys the ListDB structure. If arrays returned by csr_arrays
+        still borrow its memory, the structure is emptied and its memory
+        is freed when the object is collected, after the arrays.
         """
-        sa.listdb_destroy(self.ldb)
+        if any(ref() is not None for ref in getattr(self, 'borrowed', [])):
+            self.retired = getattr(self, 'retired', []) + [self.ldb]
+            self.ldb = sa.ListDB()
+            sa.listdb_init(self.ldb)
+        else:
+            sa.listdb_destroy(self.ldb)
+        self.maxfreq = None
 
     def invert(self):
         """
@@ -205,29 +210,82 @@ class ListDB:
         ifs = sa.ifindex_make_from_corpus(self.ldb)
         return ListDB(ldb = ifs)
 
-    def tocsr(self):
+    def csr_arrays(self, copy = False):
+        """
+        Returns the indptr, indices and data arrays of the ListDB structure
+        as a CSR matrix. If the lists are stored back to back (arena or
+        mapped databases) and copy is False, indices and data are read-only
+        views of the memory of the ListDB, which is kept alive while they
+        are used; otherwise they are copied into arrays owned by NumPy.
+        """
+        indptr = np.empty(self.size() + 1, dtype=np.int64)
+        sa.listdb_csr_indptr(self.ldb, indptr)
+        nnz = int(indptr[-1])
+
+        items = None
+        if not copy and nnz > 0:
+            items = sa.listdb_contiguous_items(self.ldb)
+        if items is not None:
+            buf = (ctypes.c_uint32 * (2 * nnz)).from_address(int(items))
+            buf.owner = self
+            self.borrowed = [ref for ref in getattr(self, 'borrowed', []) if ref() is not None]
+            self.borrowed.append(weakref.ref(buf))
+            pairs = np.frombuffer(buf, dtype=np.uint32).reshape(nnz, 2)
+            pairs.flags.writeable = False # mapped storage is read-only
+            indices = pairs[:, 0]
+            data = pairs[:, 1]
+        else:
+            indices = np.empty(nnz, dtype=np.uint32)
+            data = np.empty(nnz, dtype=np.uint32)
+            sa.listdb_to_csr(self.ldb, indices, data)
+
+        return indptr, indices, data
+
+    def tocsr(self, copy = False):
         """
         Returns the ListDB structure as a Compressed Sparse Row (CSR) matrix
         """
-        indptr = [0]
-        indices = []
-        data = []
-        for l in self.ldb:
-            for i in l:
-                indices.append(i.item)
-                data.append(i.freq)
-            indptr.append(len(indices))
-
-        return csr_matrix((data, indices, indptr), dtype=np.uint32)
+        indptr, indices, data = self.csr_arrays(copy)
+        return csr_matrix((data, indices.view(np.int32), indptr), dtype=np.uint32)
+
+    def query(self, items, freqs = None, k = 10, weights = None):
+        """
+        Retrieves the k documents with the largest scores for a query on
+        an inverted file: the sum over the query items of their query
+        frequency, their weight and their frequency in the document.
+        Only the top k documents are kept while the query is evaluated.
+        The largest frequency of each list is computed on the first query
+        and again after the ListDB is modified.
+        Returns the documents and their scores sorted by decreasing score.
+        """
+        items = np.ascontiguousarray(items, dtype=np.uint32)
+        if np.any(items >= self.size()):
+            raise IndexError('Query items out of the inverted file')
+        if freqs is not None:
+            freqs = np.ascontiguousarray(freqs, dtype=np.uint32)
+            if freqs.shape[0] != items.shape[0]:
+                raise ValueError('There must be one frequency per query item')
+        if weights is not None:
+            weights = np.ascontiguousarray(weights, dtype=np.float64)
+            if weights.shape[0] < self.size():
+                raise ValueError('There are fewer weights than items')
+        if getattr(self, 'maxfreq', None) is None:
+            self.maxfreq = np.empty(self.size(), dtype=np.uint32)
+            sa.ifindex_max_frequencies(self.ldb, self.maxfreq)
+
+        docs = np.empty(k, dtype=np.uint32)
+        scores = np.empty(k, dtype=np.float64)
+        size = sa.ifindex_query_topk_arrays(self.ldb, items.shape[0], items, freqs, weights,
+                                            self.maxfreq, k, docs, scores)
+
+        return docs[:size], scores[:size]
 
     def toarray(self):
         """
         Converts a listdb structure to a numpy multidimensional array
         """
         arr = np.zeros((self.size(), self.dim()))
-        for i, l in enumerate(self.ldb):
-            for j in l:
-                arr[i, j.item] = j.freq
+        sa.listdb_to_dense(self.ldb, arr)
 
         return arr
 
@@ -834,6 +834,161 @@ uint list_union_size(List *list1, List *list2)
      return union_size;
 }
 
+/**
+ * @brief Moves down the top of a heap of lists ordered by their current
+ *        item until the heap property is restored.
+ *
+ * @param lists Lists to be merged
+ * @param positions Current position in each list
+ * @param heap Heap of list indices
+ * @param heap_size Number of lists in the heap
+ */
+static void list_merge_sift_down(List **lists, uint *positions, uint *heap, uint heap_size)
+{
+     uint parent = 0;
+     uint top = heap[0];
+     uint top_item = lists[top]->data[positions[top]].item;
+
+     while (2 * parent + 1 < heap_size) {
+          uint child = 2 * parent + 1;
+          uint child_item = lists[heap[child]]->data[positions[heap[child]]].item;
+          if (child + 1 < heap_size) {
+               uint right_item = lists[heap[child + 1]]->data[positions[heap[child + 1]]].item;
+               if (right_item < child_item) {
+                    child++;
+                    child_item = right_item;
+               }
+          }
+          if (top_item <= child_item)
+               break;
+          heap[parent] = heap[child];
+          parent = child;
+     }
+     heap[parent] = top;
+}
+
+/**
+ * @brief Merges many lists sorted by item with a heap, adding up the
+ *        frequencies of equal items.
+ *
+ * @param lists Lists to be merged
+ * @param number_of_lists Number of lists
+ * @param merged List where the merged items are stored (preallocated)
+ */
+static void list_merge_heap(List **lists, uint number_of_lists, List *merged)
+{
+     uint i;
+     uint *positions = (uint *) calloc(number_of_lists, sizeof(uint));
+     uint *heap = (uint *) malloc(number_of_lists * sizeof(uint));
+     uint heap_size = 0;
+
+     for (i = 0; i < number_of_lists; i++) {
+          if (lists[i]->size > 0) {
+               // inserts list and moves it up the heap
+               uint child = heap_size++;
+               uint item = lists[i]->data[0].item;
+               while (child > 0 && lists[heap[(child - 1) / 2]]->data[0].item > item) {
+                    heap[child] = heap[(child - 1) / 2];
+                    child = (child - 1) / 2;
+               }
+               heap[child] = i;
+          }
+     }
+
+     while (heap_size > 0) {
+          uint top = heap[0];
+          Item *current = &lists[top]->data[positions[top]];
+          if (merged->size > 0 && merged->data[merged->size - 1].item == current->item)
+               merged->data[merged->size - 1].freq += current->freq;
+          else
+               merged->data[merged->size++] = *current;
+
+          positions[top]++;
+          if (positions[top] == lists[top]->size) // list exhausted
+               heap[0] = heap[--heap_size];
+          if (heap_size > 0)
+               list_merge_sift_down(lists, positions, heap, heap_size);
+     }
+
+     free(positions);
+     free(heap);
+}
+
+/**
+ * @brief Merges many lists sorted by item with a dense accumulator
+ *        indexed by item, adding up the frequencies of equal items.
+ *
+ * @param lists Lists to be merged
+ * @param number_of_lists Number of lists
+ * @param dim Largest item value in the lists plus one
+ * @param merged List where the merged items are stored (preallocated)
+ */
+static void list_merge_dense(List **lists, uint number_of_lists, uint dim, List *merged)
+{
+     uint i, j;
+     uint *freqs = (uint *) calloc(dim, sizeof(uint));
+     uchar *seen = (uchar *) calloc(dim, sizeof(uchar));
+
+     for (i = 0; i < number_of_lists; i++) {
+          for (j = 0; j < lists[i]->size; j++) {
+               freqs[lists[i]->data[j].item] += lists[i]->data[j].freq;
+               seen[lists[i]->data[j].item] = 1;
+          }
+     }
+
+     for (i = 0; i < dim; i++) {
+          if (seen[i]) {
+               merged->data[merged->size].item = i;
+               merged->data[merged->size].freq = freqs[i];
+               merged->size++;
+          }
+     }
+
+     free(freqs);
+     free(seen);
+}
+
+/**
+ * @brief Computes the union of many lists sorted by item, adding up the
+ *        frequencies of equal items. This is equivalent to appending all
+ *        the lists, sorting the result and calling list_unique, but
+ *        without sorting. A heap is used for merging a small number of
+ *        lists and a dense accumulator for a large number of lists.
+ *
+ * @param lists Lists to be merged (sorted by item)
+ * @param number_of_lists Number of lists
+ *
+ * @return Merged list sorted by item
+ */
+List list_merge_multi(List **lists, uint number_of_lists)
+{
+     uint i;
+     uint total = 0, dim = 0;
+     List merged;
+     list_init(&merged);
+
+     for (i = 0; i < number_of_lists; i++) {
+          if (lists[i]->size > 0) {
+               total += lists[i]->size;
+               if (dim < lists[i]->data[lists[i]->size - 1].item + 1)
+                    dim = lists[i]->data[lists[i]->size - 1].item + 1;
+          }
+     }
+     if (total == 0)
+          return merged;
+
+     merged.data = (Item *) malloc(total * sizeof(Item));
+     if (number_of_lists > LIST_MERGE_HEAP_MAX && dim <= LIST_MERGE_DENSE_FACTOR * total)
+          list_merge_dense(lists, number_of_lists, dim, &merged);
+     else
+          list_merge_heap(lists, number_of_lists, &merged);
+
+     // shrinks to the exact size
+     merged.data = realloc(merged.data, merged.size * sizeof(Item));
+
+     return merged;
+}
+
 /**
  * @brief Computes the intersection list from two lists
  *
@@ -994,6 +1149,113 @@ double list_overlap(List *list1, List *list2)
      }
 }
 
+/**
+ * @brief Computes the similarity of two lists from their sizes and the
+ *        size of their intersection.
+ *
+ * @param size1 Size of the first list
+ * @param size2 Size of the second list
+ * @param intersection_size Size of the intersection
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ *
+ * @return Similarity between lists
+ */
+static double list_similarity_from_sizes(uint size1, uint size2, uint intersection_size,
+                                         int measure)
+{
+     if (size1 == 0 || size2 == 0)
+          return 0.0;
+
+     if (measure == LIST_OVERLAP) {
+          uint min_size = min(size1, size2);
+          return (double) intersection_size / min_size;
+     } else {
+          uint union_size = (size1 + size2) - intersection_size;
+          return (double) intersection_size / (double) union_size;
+     }
+}
+
+/**
+ * @brief Computes the smallest intersection size for which the
+ *        similarity of two lists of the given sizes is greater than a
+ *        threshold.
+ *
+ * @param size1 Size of the first list
+ * @param size2 Size of the second list
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ * @param thres Similarity threshold
+ *
+ * @return Minimum intersection size, or min(size1, size2) + 1 if the
+ *         threshold can not be reached
+ */
+uint list_min_intersection_size(uint size1, uint size2, int measure, double thres)
+{
+     uint low = 0;
+     uint high = min(size1, size2);
+
+     if (list_similarity_from_sizes(size1, size2, high, measure) <= thres)
+          return high + 1;
+
+     // the similarity grows with the intersection size
+     while (low < high) {
+          uint mid = low + (high - low) / 2;
+          if (list_similarity_from_sizes(size1, size2, mid, measure) > thres)
+               high = mid;
+          else
+               low = mid + 1;
+     }
+
+     return low;
+}
+
+/**
+ * @brief Checks if the similarity of a pair of lists is greater than a
+ *        threshold. The intersection stops as soon as the threshold is
+ *        reached or can no longer be reached.
+ *
+ * @param list1 First list
+ * @param list2 Second list
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ * @param thres Similarity threshold
+ *
+ * @return 1 if the similarity is greater than the threshold, 0 otherwise
+ */
+int list_similarity_above(List *list1, List *list2, int measure, double thres)
+{
+     uint needed = list_min_intersection_size(list1->size, list2->size, measure, thres);
+     uint bound = min(list1->size, list2->size);
+     if (needed > bound)
+          return 0;
+     if (needed == 0)
+          return 1;
+
+     uint i = 0, j = 0;
+     uint intersection_size = 0;
+     while (i < list1->size && j < list2->size) {
+          if (list1->data[i].item == list2->data[j].item) {
+               intersection_size++;
+               if (intersection_size >= needed)
+                    return 1;
+               i++;
+               j++;
+          } else {
+               if (list1->data[i].item < list2->data[j].item)
+                    i++;
+               else
+                    j++;
+
+               // stop if the remaining items can not reach the threshold
+               uint left1 = list1->size - i;
+               uint left2 = list2->size - j;
+               uint left = min(left1, left2);
+               if (intersection_size + left < needed)
+                    return 0;
+          }
+     }
+
+     return 0;
+}
+
 /**
  * @brief Computes the weighted similarity of a pair of lists
  *
@@ -0,0 +1,1080 @@
+/**
+ * @file compressed_lists.c
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Operations on compressed lists. Items of a sorted list are
+ *        split into blocks whose deltas (and frequencies, if any is
+ *        different from 1) are bit-packed with the smallest width that
+ *        fits the block. Databases of lists can be stored in a container
+ *        of independently compressed blocks of lists.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include "compressed_lists.h"
+
+/**
+ * @brief Computes the number of bits needed to represent a value
+ *
+ * @param value Value to be represented
+ *
+ * @return Number of bits
+ */
+static uint clist_bit_width(uint value)
+{
+     uint bits = 0;
+
+     while (value) {
+          bits++;
+          value >>= 1;
+     }
+
+     return bits;
+}
+
+/**
+ * @brief Packs values using a fixed number of bits per value
+ *
+ * @param out Output buffer
+ * @param values Values to be packed
+ * @param number Number of values
+ * @param bits Number of bits per value
+ *
+ * @return Pointer to the byte following the packed values
+ */
+static uchar *clist_pack(uchar *out, uint *values, uint number, uint bits)
+{
+     uint i;
+     uint used = 0;
+     ullong acc = 0;
+
+     for (i = 0; i < number; i++) {
+          acc |= (ullong) values[i] << used;
+          used += bits;
+          while (used >= 8) {
+               *out++ = (uchar) (acc & 0xFF);
+               acc >>= 8;
+               used -= 8;
+          }
+     }
+
+     if (used > 0)
+          *out++ = (uchar) (acc & 0xFF);
+
+     return out;
+}
+
+/**
+ * @brief Unpacks values stored with a fixed number of bits per value
+ *
+ * @param in Input buffer
+ * @param values Unpacked values
+ * @param number Number of values
+ * @param bits Number of bits per value
+ */
+static void clist_unpack(uchar *in, uint *values, uint number, uint bits)
+{
+     uint i;
+     uint avail = 0;
+     ullong acc = 0;
+     ullong mask = (1ULL << bits) - 1;
+
+     for (i = 0; i < number; i++) {
+          while (avail < bits) {
+               acc |= (ullong) *in++ << avail;
+               avail += 8;
+          }
+          values[i] = (uint) (acc & mask);
+          acc >>= bits;
+          avail -= bits;
+     }
+}
+
+/**
+ * @brief Decodes a block of a compressed list
+ *
+ * @param list Compressed list
+ * @param block Number of the block to be decoded
+ * @param items Buffer where the items of the block are stored
+ *
+ * @return Number of decoded items
+ */
+static uint clist_decode_block(CList *list, uint block, Item *items)
+{
+     uint i;
+     uint values[CLIST_BLOCK_SIZE];
+     uint *directory = (uint *) list->data;
+     uint count = list->size - block * CLIST_BLOCK_SIZE;
+     if (count > CLIST_BLOCK_SIZE)
+          count = CLIST_BLOCK_SIZE;
+
+     uchar *in = list->data + directory[2 * block + 1];
+     uint delta_bits = in[0];
+     uint freq_bits = in[1];
+     in += 2;
+
+     // rebuilds items from the deltas
+     clist_unpack(in, values, count - 1, delta_bits);
+     items[0].item = directory[2 * block];
+     for (i = 1; i < count; i++)
+          items[i].item = items[i - 1].item + values[i - 1];
+
+     // frequencies are only stored when some of them is different from 1
+     if (freq_bits > 0) {
+          in += ((count - 1) * delta_bits + 7) / 8;
+          clist_unpack(in, values, count, freq_bits);
+          for (i = 0; i < count; i++)
+               items[i].freq = values[i];
+     } else {
+          for (i = 0; i < count; i++)
+               items[i].freq = 1;
+     }
+
+     return count;
+}
+
+/**
+ * @brief Initializes a compressed list
+ *
+ * @param list Compressed list to be initialized
+ */
+void clist_init(CList *list)
+{
+     list->size = 0;
+     list->bytes = 0;
+     list->data = NULL;
+}
+
+/**
+ * @brief Gets the number of blocks of a compressed list
+ *
+ * @param list Compressed list
+ *
+ * @return Number of blocks
+ */
+uint clist_number_of_blocks(CList *list)
+{
+     return (list->size + CLIST_BLOCK_SIZE - 1) / CLIST_BLOCK_SIZE;
+}
+
+/**
+ * @brief Compresses a list sorted by item in ascending order
+ *
+ * @param list List to be compressed
+ *
+ * @return Compressed list
+ */
+CList clist_encode(List *list)
+{
+     CList clist;
+     clist_init(&clist);
+     if (list->size == 0)
+          return clist;
+
+     clist.size = list->size;
+     uint number_of_blocks = clist_number_of_blocks(&clist);
+     size_t directory_bytes = 2 * number_of_blocks * sizeof(uint);
+
+     // allocates the worst case and shrinks the buffer at the end
+     clist.data = (uchar *) malloc(directory_bytes + number_of_blocks *
+                                   (2 + 2 * CLIST_BLOCK_SIZE * sizeof(uint)));
+     uint *directory = (uint *) clist.data;
+     uchar *out = clist.data + directory_bytes;
+
+     uint b, i;
+     uint deltas[CLIST_BLOCK_SIZE];
+     uint freqs[CLIST_BLOCK_SIZE];
+     for (b = 0; b < number_of_blocks; b++) {
+          Item *items = list->data + b * CLIST_BLOCK_SIZE;
+          uint count = list->size - b * CLIST_BLOCK_SIZE;
+          if (count > CLIST_BLOCK_SIZE)
+               count = CLIST_BLOCK_SIZE;
+
+          uint max_delta = 0, max_freq = 0, binary = 1;
+          for (i = 0; i < count; i++) {
+               if (i > 0) {
+                    deltas[i - 1] = items[i].item - items[i - 1].item;
+                    if (deltas[i - 1] > max_delta)
+                         max_delta = deltas[i - 1];
+               }
+               freqs[i] = items[i].freq;
+               if (freqs[i] > max_freq)
+                    max_freq = freqs[i];
+               if (freqs[i] != 1)
+                    binary = 0;
+          }
+
+          directory[2 * b] = items[0].item;
+          directory[2 * b + 1] = (uint) (out - clist.data);
+
+          uint delta_bits = clist_bit_width(max_delta);
+          uint freq_bits = binary ? 0 : clist_bit_width(max_freq);
+          if (!binary && freq_bits == 0)
+               freq_bits = 1;
+          *out++ = (uchar) delta_bits;
+          *out++ = (uchar) freq_bits;
+          out = clist_pack(out, deltas, count - 1, delta_bits);
+          if (freq_bits > 0)
+               out = clist_pack(out, freqs, count, freq_bits);
+     }
+
+     clist.bytes = (uint) (out - clist.data);
+     clist.data = realloc(clist.data, clist.bytes);
+
+     return clist;
+}
+
+/**
+ * @brief Decompresses a list into a list that is reused as buffer
+ *
+ * @param clist Compressed list
+ * @param list List where the items are decompressed
+ */
+void clist_decode_into(CList *clist, List *list)
+{
+     uint b;
+     uint number_of_blocks = clist_number_of_blocks(clist);
+
+     if (list->size != clist->size)
+          list->data = realloc(list->data, clist->size * sizeof(Item));
+     list->size = clist->size;
+
+     for (b = 0; b < number_of_blocks; b++)
+          clist_decode_block(clist, b, list->data + b * CLIST_BLOCK_SIZE);
+}
+
+/**
+ * @brief Decompresses a list
+ *
+ * @param clist Compressed list
+ *
+ * @return Decompressed list
+ */
+List clist_decode(CList *clist)
+{
+     List list;
+
+     list_init(&list);
+     clist_decode_into(clist, &list);
+
+     return list;
+}
+
+/**
+ * @brief Destroys a compressed list
+ *
+ * @param list Compressed list to be destroyed
+ */
+void clist_destroy(CList *list)
+{
+     free(list->data);
+     clist_init(list);
+}
+
+/**
+ * @brief Prints in screen the items of a compressed list
+ *
+ * @param list Compressed list to be printed
+ */
+void clist_print(CList *list)
+{
+     uint i = 0;
+     Item *item;
+     CListIter iter;
+
+     printf ("%d (%d bytes) -- ", list->size, list->bytes);
+     clist_iter_init(&iter, list);
+     while ((item = clist_iter_next(&iter)) != NULL)
+          printf ("%d:%d[%d] ", item->item, item->freq, i++);
+     printf("\n");
+}
+
+/**
+ * @brief Initializes an iterator over a compressed list
+ *
+ * @param iter Iterator
+ * @param list Compressed list to be traversed
+ */
+void clist_iter_init(CListIter *iter, CList *list)
+{
+     iter->list = list;
+     iter->block = 0;
+     iter->position = 0;
+     iter->count = 0;
+}
+
+/**
+ * @brief Gets the next item of a compressed list
+ *
+ * @param iter Iterator
+ *
+ * @return Pointer to the next item (valid until the iterator moves) or
+ *         NULL if the end of the list was reached
+ */
+Item *clist_iter_next(CListIter *iter)
+{
+     if (iter->position == iter->count) {
+          if (iter->block >= clist_number_of_blocks(iter->list))
+               return NULL;
+          iter->count = clist_decode_block(iter->list, iter->block, iter->items);
+          iter->block++;
+          iter->position = 0;
+     }
+
+     return &iter->items[iter->position++];
+}
+
+/**
+ * @brief Moves the iterator to the first item greater or equal than a
+ *        given item without decoding the blocks in between. The found
+ *        item is not consumed, so it is returned again by the next call
+ *        to clist_iter_next or clist_iter_seek.
+ *
+ * @param iter Iterator
+ * @param target Item to be searched
+ *
+ * @return Pointer to the found item or NULL if there are no items
+ *         greater or equal than the target
+ */
+Item *clist_iter_seek(CListIter *iter, uint target)
+{
+     uint *directory = (uint *) iter->list->data;
+     uint number_of_blocks = clist_number_of_blocks(iter->list);
+
+     while (1) {
+          if (iter->count > 0 && iter->items[iter->count - 1].item < target)
+               iter->position = iter->count;
+          while (iter->position < iter->count && iter->items[iter->position].item < target)
+               iter->position++;
+          if (iter->position < iter->count)
+               return &iter->items[iter->position];
+
+          // skips the blocks that end before the target
+          if (iter->block >= number_of_blocks)
+               return NULL;
+          uint b = iter->block;
+          while (b + 1 < number_of_blocks && directory[2 * (b + 1)] <= target)
+               b++;
+          iter->count = clist_decode_block(iter->list, b, iter->items);
+          iter->block = b + 1;
+          iter->position = 0;
+     }
+}
+
+/**
+ * @brief Computes the union list from two compressed lists
+ *
+ * @param list1 First compressed list
+ * @param list2 Second compressed list
+ *
+ * @return Union list
+ */
+List clist_union(CList *list1, CList *list2)
+{
+     CListIter iter1, iter2;
+     List union_list;
+
+     union_list.size = 0;
+     union_list.data = (Item *) malloc((list1->size + list2->size) * sizeof(Item));
+
+     clist_iter_init(&iter1, list1);
+     clist_iter_init(&iter2, list2);
+     Item *item1 = clist_iter_next(&iter1);
+     Item *item2 = clist_iter_next(&iter2);
+     while (item1 != NULL && item2 != NULL) {
+          if (item1->item == item2->item) {
+               union_list.data[union_list.size].item = item1->item;
+               union_list.data[union_list.size++].freq = max(item1->freq, item2->freq);
+               item1 = clist_iter_next(&iter1);
+               item2 = clist_iter_next(&iter2);
+          } else if (item1->item < item2->item) {
+               union_list.data[union_list.size++] = *item1;
+               item1 = clist_iter_next(&iter1);
+          } else {
+               union_list.data[union_list.size++] = *item2;
+               item2 = clist_iter_next(&iter2);
+          }
+     }
+
+     for (; item1 != NULL; item1 = clist_iter_next(&iter1))
+          union_list.data[union_list.size++] = *item1;
+
+     for (; item2 != NULL; item2 = clist_iter_next(&iter2))
+          union_list.data[union_list.size++] = *item2;
+
+     union_list.data = realloc(union_list.data, union_list.size * sizeof(Item));
+
+     return union_list;
+}
+
+/**
+ * @brief Computes the intersection list from two compressed lists
+ *
+ * @param list1 First compressed list
+ * @param list2 Second compressed list
+ *
+ * @return Intersection list
+ */
+List clist_intersection(CList *list1, CList *list2)
+{
+     CListIter iter1, iter2;
+     List intersection_list;
+
+     // iterates over the shortest list and seeks in the longest one
+     if (list1->size > list2->size) {
+          CList *tmp = list1;
+          list1 = list2;
+          list2 = tmp;
+     }
+
+     intersection_list.size = 0;
+     intersection_list.data = (Item *) malloc(list1->size * sizeof(Item));
+
+     Item *item1, *item2;
+     clist_iter_init(&iter1, list1);
+     clist_iter_init(&iter2, list2);
+     while ((item1 = clist_iter_next(&iter1)) != NULL) {
+          if ((item2 = clist_iter_seek(&iter2, item1->item)) == NULL)
+               break;
+          if (item2->item == item1->item) {
+               intersection_list.data[intersection_list.size].item = item1->item;
+               intersection_list.data[intersection_list.size++].freq = min(item1->freq, item2->freq);
+          }
+     }
+
+     intersection_list.data = realloc(intersection_list.data,
+                                      intersection_list.size * sizeof(Item));
+
+     return intersection_list;
+}
+
+/**
+ * @brief Computes the size of the intersection of a pair of compressed lists
+ *
+ * @param list1 First compressed list
+ * @param list2 Second compressed list
+ *
+ * @return Size of the intersection
+ */
+uint clist_intersection_size(CList *list1, CList *list2)
+{
+     CListIter iter1, iter2;
+     uint intersection_size = 0;
+
+     // iterates over the shortest list and seeks in the longest one
+     if (list1->size > list2->size) {
+          CList *tmp = list1;
+          list1 = list2;
+          list2 = tmp;
+     }
+
+     Item *item1, *item2;
+     clist_iter_init(&iter1, list1);
+     clist_iter_init(&iter2, list2);
+     while ((item1 = clist_iter_next(&iter1)) != NULL) {
+          if ((item2 = clist_iter_seek(&iter2, item1->item)) == NULL)
+               break;
+          if (item2->item == item1->item)
+               intersection_size++;
+     }
+
+     return intersection_size;
+}
+
+/**
+ * @brief Computes the size of the intersection of a compressed list
+ *        and a sorted list
+ *
+ * @param clist Compressed list
+ * @param list List sorted by item in ascending order
+ *
+ * @return Size of the intersection
+ */
+uint clist_intersection_size_list(CList *clist, List *list)
+{
+     uint i;
+     uint intersection_size = 0;
+     CListIter iter;
+     Item *found;
+
+     clist_iter_init(&iter, clist);
+     for (i = 0; i < list->size; i++) {
+          if ((found = clist_iter_seek(&iter, list->data[i].item)) == NULL)
+               break;
+          if (found->item == list->data[i].item)
+               intersection_size++;
+     }
+
+     return intersection_size;
+}
+
+/**
+ * @brief Computes the jaccard similarity coefficient of a pair of
+ *        compressed lists.
+ *
+ * @param list1 First compressed list
+ * @param list2 Second compressed list
+ *
+ * @return Jaccard similarity coefficient between lists
+ */
+double clist_jaccard(CList *list1, CList *list2)
+{
+     if (list1->size > 0 && list2->size > 0){
+          uint intersection_size = clist_intersection_size(list1, list2);
+          uint union_size = (list1->size + list2->size) - intersection_size;
+          return (double) intersection_size / (double) union_size;
+     } else {
+          return 0.0;
+     }
+}
+
+/**
+ * @brief Computes the overlap coefficient of a pair of compressed lists.
+ *
+ * @param list1 First compressed list
+ * @param list2 Second compressed list
+ *
+ * @return Overlap coefficient between lists
+ */
+double clist_overlap(CList *list1, CList *list2)
+{
+     if (list1->size > 0 && list2->size > 0){
+          uint intersection_size = clist_intersection_size(list1, list2);
+          uint min_size = min(list1->size, list2->size);
+          return (double) intersection_size / min_size;
+     } else {
+          return 0.0;
+     }
+}
+
+/**
+ * @brief Initializes a database of compressed lists
+ *
+ * @param listdb Database of compressed lists to be initialized
+ */
+void clistdb_init(CListDB *listdb)
+{
+     listdb->size = 0;
+     listdb->dim = 0;
+     listdb->lists = NULL;
+}
+
+/**
+ * @brief Compresses a database of lists. Lists must be sorted by item
+ *        in ascending order.
+ *
+ * @param listdb Database of lists
+ *
+ * @return Database of compressed lists
+ */
+CListDB clistdb_from_listdb(ListDB *listdb)
+{
+     uint i;
+     CListDB clistdb;
+
+     clistdb.size = listdb->size;
+     clistdb.dim = listdb->dim;
+     clistdb.lists = (CList *) malloc(listdb->size * sizeof(CList));
+     for (i = 0; i < listdb->size; i++)
+          clistdb.lists[i] = clist_encode(&listdb->lists[i]);
+
+     return clistdb;
+}
+
+/**
+ * @brief Decompresses a database of compressed lists
+ *
+ * @param clistdb Database of compressed lists
+ *
+ * @return Database of lists
+ */
+ListDB clistdb_to_listdb(CListDB *clistdb)
+{
+     uint i;
+     ListDB listdb = listdb_create(clistdb->size, clistdb->dim);
+
+     for (i = 0; i < clistdb->size; i++)
+          listdb.lists[i] = clist_decode(&clistdb->lists[i]);
+
+     return listdb;
+}
+
+/**
+ * @brief Destroys a database of compressed lists
+ *
+ * @param listdb Database of compressed lists to be destroyed
+ */
+void clistdb_destroy(CListDB *listdb)
+{
+     uint i;
+
+     for (i = 0; i < listdb->size; i++)
+          clist_destroy(&listdb->lists[i]);
+
+     free(listdb->lists);
+     clistdb_init(listdb);
+}
+
+/**
+ * @brief Computes the memory used by a database of compressed lists
+ *
+ * @param listdb Database of compressed lists
+ *
+ * @return Number of bytes
+ */
+size_t clistdb_memory(CListDB *listdb)
+{
+     uint i;
+     size_t bytes = listdb->size * sizeof(CList);
+
+     for (i = 0; i < listdb->size; i++)
+          bytes += listdb->lists[i].bytes;
+
+     return bytes;
+}
+
+/**
+ * @brief Computes the number of bytes used by a compressed list inside a
+ *        block of a container
+ *
+ * @param list Compressed list
+ *
+ * @return Number of bytes
+ */
+static size_t clistdb_entry_bytes(CList *list)
+{
+     return 2 * sizeof(uint) + ((list->bytes + 3) & ~3u);
+}
+
+/**
+ * @brief Saves a database of lists in a container of compressed blocks.
+ *        Lists must be sorted by item in ascending order.
+ *
+ * @param filename File where the container is saved
+ * @param listdb Database of lists
+ * @param flags CLISTDB_ZLIB to compress blocks with zlib, 0 otherwise
+ */
+void clistdb_save(char *filename, ListDB *listdb, uint flags)
+{
+#ifndef HAVE_ZLIB
+     if (flags & CLISTDB_ZLIB) {
+          fprintf(stderr,"Error: zlib compression is not available\n");
+          exit(EXIT_FAILURE);
+     }
+#endif
+     int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if (fd == -1) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     uint i;
+     CList *encoded = (CList *) malloc(listdb->size * sizeof(CList));
+#pragma omp parallel for schedule(dynamic)
+     for (i = 0; i < listdb->size; i++)
+          encoded[i] = clist_encode(&listdb->lists[i]);
+
+     // groups consecutive lists in blocks of about CLISTDB_BLOCK_BYTES
+     uint number_of_blocks = 0, capacity = 0;
+     CListDBBlock *index = NULL;
+     for (i = 0; i < listdb->size; i++) {
+          if (number_of_blocks == 0 ||
+              index[number_of_blocks - 1].raw >= CLISTDB_BLOCK_BYTES) {
+               if (number_of_blocks == capacity) {
+                    capacity = capacity ? 2 * capacity : 64;
+                    index = (CListDBBlock *) realloc(index, capacity * sizeof(CListDBBlock));
+               }
+               index[number_of_blocks].first = i;
+               index[number_of_blocks].raw = 0;
+               number_of_blocks++;
+          }
+          index[number_of_blocks - 1].raw += clistdb_entry_bytes(&encoded[i]);
+     }
+
+     // fills and compresses the blocks in parallel
+     uchar **blocks = (uchar **) malloc(number_of_blocks * sizeof(uchar *));
+     uint b;
+#pragma omp parallel for schedule(dynamic)
+     for (b = 0; b < number_of_blocks; b++) {
+          ullong last = b + 1 < number_of_blocks ? index[b + 1].first : listdb->size;
+          uchar *block = (uchar *) malloc(index[b].raw);
+          uchar *p = block;
+          ullong j;
+          for (j = index[b].first; j < last; j++) {
+               uint header[2] = {encoded[j].size, encoded[j].bytes};
+               size_t padded = clistdb_entry_bytes(&encoded[j]) - sizeof(header);
+               memcpy(p, header, sizeof(header));
+               p += sizeof(header);
+               memset(p, 0, padded);
+               if (encoded[j].bytes > 0)
+                    memcpy(p, encoded[j].data, encoded[j].bytes);
+               p += padded;
+               clist_destroy(&encoded[j]);
+          }
+
+          index[b].stored = index[b].raw;
+#ifdef HAVE_ZLIB
+          if (flags & CLISTDB_ZLIB) {
+               uLongf length = compressBound(index[b].raw);
+               uchar *packed = (uchar *) malloc(length);
+               if (compress2(packed, &length, block, index[b].raw, Z_DEFAULT_COMPRESSION) == Z_OK
+                   && length < index[b].raw) {
+                    free(block);
+                    block = packed;
+                    index[b].stored = length;
+               } else {
+                    free(packed);
+               }
+          }
+#endif
+          blocks[b] = block;
+     }
+     free(encoded);
+
+     CListDBHeader header;
+     memset(&header, 0, sizeof(header));
+     memcpy(header.magic, CLISTDB_MAGIC, sizeof(header.magic));
+     header.version = CLISTDB_VERSION;
+     header.flags = flags;
+     header.size = listdb->size;
+     header.dim = listdb->dim;
+     header.number_of_blocks = number_of_blocks;
+
+     ullong offset = sizeof(CListDBHeader) + number_of_blocks * sizeof(CListDBBlock);
+     for (b = 0; b < number_of_blocks; b++) {
+          index[b].offset = offset;
+          offset += (index[b].stored + 7) & ~7ull;
+     }
+
+     static char padding[8];
+     listdb_write_buffer(fd, (char *) &header, sizeof(header), filename);
+     listdb_write_buffer(fd, (char *) index, number_of_blocks * sizeof(CListDBBlock), filename);
+     for (b = 0; b < number_of_blocks; b++) {
+          listdb_write_buffer(fd, (char *) blocks[b], index[b].stored, filename);
+          listdb_write_buffer(fd, padding, ((index[b].stored + 7) & ~7ull) - index[b].stored,
+                              filename);
+          free(blocks[b]);
+     }
+     free(blocks);
+     free(index);
+
+     if (close(fd)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Checks if a file is a container of compressed lists
+ *
+ * @param filename Name of the file
+ *
+ * @return 1 if the file starts with the container magic, 0 otherwise
+ */
+int clistdb_is_container(char *filename)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"rb"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     char magic[8];
+     int container = fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic) &&
+          memcmp(magic, CLISTDB_MAGIC, sizeof(magic)) == 0;
+     fclose(file);
+
+     return container;
+}
+
+/**
+ * @brief Opens a container of compressed lists. The file is mapped and
+ *        blocks are only decompressed when their lists are requested.
+ *
+ * @param file Container to be opened
+ * @param filename Name of the file
+ */
+void clistdb_file_open(CListDBFile *file, char *filename)
+{
+     int fd;
+     if ((fd = open(filename, O_RDONLY)) == -1) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     struct stat st;
+     if (fstat(fd, &st) == -1 || st.st_size < sizeof(CListDBHeader)) {
+          fprintf(stderr,"Error: %s is not a compressed list container\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     file->mapping_size = st.st_size;
+     void *mapping = mmap(NULL, file->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (mapping == MAP_FAILED) {
+          fprintf(stderr,"Error: Could not map file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // checking header and block index
+     file->header = (CListDBHeader *) mapping;
+     file->index = (CListDBBlock *) (file->header + 1);
+     if (memcmp(file->header->magic, CLISTDB_MAGIC, sizeof(file->header->magic)) != 0) {
+          fprintf(stderr,"Error: %s is not a compressed list container\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     if (file->header->version != CLISTDB_VERSION) {
+          fprintf(stderr,"Error: Unsupported version %u of compressed list container %s\n",
+                  file->header->version, filename);
+          exit(EXIT_FAILURE);
+     }
+#ifndef HAVE_ZLIB
+     if (file->header->flags & CLISTDB_ZLIB) {
+          fprintf(stderr,"Error: %s needs zlib, which is not available\n", filename);
+          exit(EXIT_FAILURE);
+     }
+#endif
+
+     ullong b;
+     ullong number_of_blocks = file->header->number_of_blocks;
+     int corrupted = (file->mapping_size - sizeof(CListDBHeader)) / sizeof(CListDBBlock)
+          < number_of_blocks || (number_of_blocks == 0 && file->header->size > 0);
+     for (b = 0; !corrupted && b < number_of_blocks; b++) {
+          CListDBBlock *block = &file->index[b];
+          corrupted = (b == 0 ? block->first != 0 : block->first <= file->index[b - 1].first)
+               || block->first >= file->header->size
+               || block->stored > block->raw
+               || (block->stored < block->raw && !(file->header->flags & CLISTDB_ZLIB))
+               || block->offset > file->mapping_size
+               || block->stored > file->mapping_size - block->offset;
+     }
+     if (corrupted) {
+          fprintf(stderr,"Error: Compressed list container %s is truncated or corrupted\n",
+                  filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Closes a container of compressed lists
+ *
+ * @param file Container to be closed
+ */
+void clistdb_file_close(CListDBFile *file)
+{
+     munmap(file->header, file->mapping_size);
+     file->header = NULL;
+     file->index = NULL;
+     file->mapping_size = 0;
+}
+
+/**
+ * @brief Finds the block of a container that holds a list
+ *
+ * @param file Container
+ * @param position Position of the list
+ *
+ * @return Number of the block
+ */
+static uint clistdb_find_block(CListDBFile *file, uint position)
+{
+     uint low = 0, high = file->header->number_of_blocks - 1;
+     while (low < high) {
+          uint middle = low + (high - low + 1) / 2;
+          if (file->index[middle].first <= position)
+               low = middle;
+          else
+               high = middle - 1;
+     }
+
+     return low;
+}
+
+/**
+ * @brief Checks that the directory and the blocks of a compressed list
+ *        read from a container lie within its bytes
+ *
+ * @param list Compressed list
+ *
+ * @return 1 if the list can be decoded, 0 otherwise
+ */
+static int clistdb_list_is_valid(CList *list)
+{
+     uint b;
+     uint number_of_blocks = clist_number_of_blocks(list);
+     if ((ullong) number_of_blocks * 2 * sizeof(uint) > list->bytes)
+          return 0;
+
+     uint *directory = (uint *) list->data;
+     for (b = 0; b < number_of_blocks; b++) {
+          ullong offset = directory[2 * b + 1];
+          if (offset + 2 > list->bytes)
+               return 0;
+
+          uint count = list->size - b * CLIST_BLOCK_SIZE;
+          if (count > CLIST_BLOCK_SIZE)
+               count = CLIST_BLOCK_SIZE;
+          uint delta_bits = list->data[offset];
+          uint freq_bits = list->data[offset + 1];
+          if (delta_bits > 32 || freq_bits > 32)
+               return 0;
+
+          // packed deltas and frequencies
+          offset += 2 + ((ullong) (count - 1) * delta_bits + 7) / 8;
+          if (freq_bits > 0)
+               offset += ((ullong) count * freq_bits + 7) / 8;
+          if (offset > list->bytes)
+               return 0;
+     }
+
+     return 1;
+}
+
+/**
+ * @brief Decodes the lists of a block that fall in a range
+ *
+ * @param file Container
+ * @param block Number of the block
+ * @param first First list of the range
+ * @param last List after the last one of the range
+ * @param lists Array where the list at position i is stored in i - first
+ */
+static void clistdb_decode_block(CListDBFile *file, uint block, uint first, uint last,
+                                 List *lists)
+{
+     CListDBBlock *entry = &file->index[block];
+     ullong end = block + 1 < file->header->number_of_blocks ?
+          file->index[block + 1].first : file->header->size;
+     uchar *data = (uchar *) file->header + entry->offset;
+
+#ifdef HAVE_ZLIB
+     if (entry->stored < entry->raw) {
+          uLongf length = entry->raw;
+          uchar *raw = (uchar *) malloc(entry->raw);
+          if (uncompress(raw, &length, data, entry->stored) != Z_OK || length != entry->raw) {
+               fprintf(stderr,"Error: Could not decompress block %u\n", block);
+               exit(EXIT_FAILURE);
+          }
+          data = raw;
+     }
+#endif
+
+     uchar *p = data;
+     ullong i;
+     for (i = entry->first; i < end && i < last; i++) {
+          uint header[2];
+          if (p + sizeof(header) > data + entry->raw) {
+               fprintf(stderr,"Error: Block %u is corrupted\n", block);
+               exit(EXIT_FAILURE);
+          }
+          memcpy(header, p, sizeof(header));
+          p += sizeof(header);
+          if (p + header[1] > data + entry->raw) {
+               fprintf(stderr,"Error: Block %u is corrupted\n", block);
+               exit(EXIT_FAILURE);
+          }
+
+          if (i >= first) {
+               CList clist = {header[0], header[1], p};
+               if (!clistdb_list_is_valid(&clist)) {
+                    fprintf(stderr,"Error: List %llu of block %u is corrupted\n", i, block);
+                    exit(EXIT_FAILURE);
+               }
+               lists[i - first] = clist_decode(&clist);
+          }
+          p += ((ullong) header[1] + 3) & ~3ULL;
+     }
+
+     if (entry->stored < entry->raw)
+          free(data);
+}
+
+/**
+ * @brief Loads a single list of a container. Only the block that holds
+ *        the list is decompressed.
+ *
+ * @param file Container
+ * @param position Position of the list
+ *
+ * @return Decompressed list
+ */
+List clistdb_file_get(CListDBFile *file, uint position)
+{
+     if (position >= file->header->size) {
+          fprintf(stderr,"Error: List %u is out of range\n", position);
+          exit(EXIT_FAILURE);
+     }
+
+     List list;
+     clistdb_decode_block(file, clistdb_find_block(file, position), position, position + 1, &list);
+
+     return list;
+}
+
+/**
+ * @brief Loads a range of lists of a container. Only the blocks that hold
+ *        lists of the range are decompressed, in parallel.
+ *
+ * @param file Container
+ * @param first First list of the range
+ * @param last List after the last one of the range
+ *
+ * @return Database with the lists of the range
+ */
+ListDB clistdb_file_range(CListDBFile *file, uint first, uint last)
+{
+     if (first > last || last > file->header->size) {
+          fprintf(stderr,"Error: Range [%u, %u) is out of range\n", first, last);
+          exit(EXIT_FAILURE);
+     }
+
+     ListDB listdb = listdb_create(last - first, file->header->dim);
+     if (first == last)
+          return listdb;
+
+     uint first_block = clistdb_find_block(file, first);
+     uint last_block = clistdb_find_block(file, last - 1);
+     uint b;
+#pragma omp parallel for schedule(dynamic)
+     for (b = first_block; b <= last_block; b++)
+          clistdb_decode_block(file, b, first, last, listdb.lists);
+
+     return listdb;
+}
+
+/**
+ * @brief Loads all the lists of a container of compressed lists
+ *
+ * @param filename Name of the file
+ *
+ * @return Database of lists
+ */
+ListDB clistdb_load(char *filename)
+{
+     CListDBFile file;
+     clistdb_file_open(&file, filename);
+     ListDB listdb = clistdb_file_range(&file, 0, file.header->size);
+     clistdb_file_close(&file);
+
+     return listdb;
+}
@@ -21,136 +21,2107 @@
 #include <stdlib.h>
 #include <string.h>
 #include <float.h>
+#include <limits.h>
+#include <stddef.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "weights.h"
 #include "ifindex.h"
 
 /**
- * @brief Makes a query to the database
+ * @brief Creates a dense accumulator of document hits
  *
+ * @param dim Number of documents
+ *
+ * @return Accumulator with all counts set to zero
+ */
+IFAccumulator ifindex_accumulator_create(uint dim)
+{
+     IFAccumulator acc;
+     acc.dim = dim;
+     acc.size = 0;
+     acc.counts = (uint *) calloc(dim, sizeof(uint));
+     acc.touched = (uint *) malloc(dim * sizeof(uint));
+
+     return acc;
+}
+
+/**
+ * @brief Destroys a dense accumulator of document hits
+ *
+ * @param acc Accumulator
+ */
+void ifindex_accumulator_destroy(IFAccumulator *acc)
+{
+     free(acc->counts);
+     free(acc->touched);
+     acc->counts = NULL;
+     acc->touched = NULL;
+     acc->dim = 0;
+     acc->size = 0;
+}
+
+/**
+ * @brief Collects the documents of an accumulator with a minimum number
+ *        of hits and clears the accumulator
+ *
+ * @param acc Accumulator
+ * @param min_hits Minimum number of hits of a retrieved document
+ *
+ * @return Retrieved documents sorted by item, with their hits as frequency
+ */
+static List ifindex_accumulator_collect(IFAccumulator *acc, uint min_hits)
+{
+     uint i;
+     List query_result;
+     list_init(&query_result);
+     if (acc->size > 0)
+          query_result.data = (Item *) malloc(acc->size * sizeof(Item));
+     if (acc->size > acc->dim / LIST_MERGE_DENSE_FACTOR) { // scanning is cheaper than sorting
+          for (i = 0; i < acc->dim; i++) {
+               if (acc->counts[i] > 0 && acc->counts[i] >= min_hits) {
+                    query_result.data[query_result.size].item = i;
+                    query_result.data[query_result.size].freq = acc->counts[i];
+                    query_result.size++;
+               }
+               acc->counts[i] = 0;
+          }
+     } else {
+          for (i = 0; i < acc->size; i++) {
+               uint doc = acc->touched[i];
+               if (acc->counts[doc] >= min_hits) {
+                    query_result.data[query_result.size].item = doc;
+                    query_result.data[query_result.size].freq = acc->counts[doc];
+                    query_result.size++;
+               }
+               acc->counts[doc] = 0;
+          }
+          list_sort_by_item(&query_result);
+     }
+     acc->size = 0;
+
+     if (query_result.size == 0) {
+          free(query_result.data);
+          query_result.data = NULL;
+     } else {
+          query_result.data = realloc(query_result.data, query_result.size * sizeof(Item));
+     }
+
+     return query_result;
+}
+
+/**
+ * @brief Makes a query to the database keeping only the documents with
+ *        a minimum number of hits. Hits (the frequencies of the query
+ *        items in each document) are added up in a dense accumulator, so
+ *        posting lists are neither copied nor sorted.
+ *
+ * @param ifindex Inverted file index
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param acc Accumulator with at least ifindex->dim documents
+ *
+ * @return Retrieved documents sorted by item, with their hits as frequency
+ */
+List ifindex_query_threshold(ListDB *ifindex, List *query, uint min_hits, IFAccumulator *acc)
+{
+     uint i, j;
+     for (i = 0; i < query->size; i++) { //retrieves each list in inverted
+          List *posting = &ifindex->lists[query->data[i].item];
+          if (ifindex->access != NULL)
+               listdb_record_access(ifindex, query->data[i].item);
+          for (j = 0; j < posting->size; j++) {
+               uint doc = posting->data[j].item;
+               if (posting->data[j].freq == 0) // never retrieves a document
+                    continue;
+               if (acc->counts[doc] == 0)
+                    acc->touched[acc->size++] = doc;
+               acc->counts[doc] += posting->data[j].freq;
+          }
+     }
+
+     return ifindex_accumulator_collect(acc, min_hits);
+}
+
+/**
+ * @brief Makes a query to the database. The posting lists of the query
+ *        are merged, so its cost depends on the retrieved postings and
+ *        not on the number of documents. Many queries are answered with
+ *        a reusable accumulator by ifindex_query_threshold.
+ *
+ * @param ifindex Inverted file index
+ * @param query Query list
+ *
+ * @return Query result
+ */
+List ifindex_query(ListDB *ifindex, List *query)
+{
+     uint i;
+     List **postings = (List **) malloc(query->size * sizeof(List *));
+     for (i = 0; i < query->size; i++) { //retrieves each list in inverted
+          postings[i] = &ifindex->lists[query->data[i].item];
+          if (ifindex->access != NULL)
+               listdb_record_access(ifindex, query->data[i].item);
+     }
+     List query_result = list_merge_multi(postings, query->size);
+     free(postings);
+
+     return query_result;
+}
+
+/**
+ * @brief Creates a cache of query results
+ *
+ * @param capacity Largest number of bytes of cached queries and results
+ *
+ * @return Empty cache
+ */
+IFCache ifindex_cache_create(size_t capacity)
+{
+     IFCache cache;
+     cache.capacity = capacity;
+     cache.bytes = 0;
+     cache.size = 0;
+     cache.buckets = (IFCacheEntry **) calloc(IFINDEX_CACHE_BUCKETS, sizeof(IFCacheEntry *));
+     cache.newest = NULL;
+     cache.oldest = NULL;
+     cache.hits = 0;
+     cache.misses = 0;
+     cache.evictions = 0;
+
+     return cache;
+}
+
+/**
+ * @brief Destroys a cache of query results
+ *
+ * @param cache Cache
+ */
+void ifindex_cache_destroy(IFCache *cache)
+{
+     IFCacheEntry *entry = cache->newest;
+     while (entry != NULL) {
+          IFCacheEntry *older = entry->older;
+          list_destroy(&entry->query);
+          free(entry->value);
+          free(entry);
+          entry = older;
+     }
+     free(cache->buckets);
+     cache->buckets = NULL;
+     cache->newest = NULL;
+     cache->oldest = NULL;
+     cache->size = 0;
+     cache->bytes = 0;
+}
+
+/**
+ * @brief Hashes the items and frequencies of a query and its parameter
+ *
+ * @param query Query list
+ * @param param Parameter of the query
+ *
+ * @return Key of the query
+ */
+static ullong ifindex_cache_key(List *query, uint param)
+{
+     uint i;
+     ullong hash = 0x9e3779b97f4a7c15ULL ^ param;
+     for (i = 0; i < query->size; i++) {
+          ullong item = ((ullong) query->data[i].item << 32) | query->data[i].freq;
+          hash ^= item + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+     }
+     hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+
+     return hash ^ (hash >> 31);
+}
+
+/**
+ * @brief Finds the entry of a query in a cache
+ *
+ * @param cache Cache
+ * @param key Key of the query
+ * @param query Query list
+ * @param param Parameter of the query
+ *
+ * @return Entry of the query or NULL if it is not cached
+ */
+static IFCacheEntry *ifindex_cache_find(IFCache *cache, ullong key, List *query, uint param)
+{
+     IFCacheEntry *entry;
+     for (entry = cache->buckets[key % IFINDEX_CACHE_BUCKETS]; entry != NULL; entry = entry->next)
+          if (entry->key == key && entry->param == param && entry->query.size == query->size &&
+              (query->size == 0 ||
+               memcmp(entry->query.data, query->data, query->size * sizeof(Item)) == 0))
+               return entry;
+
+     return NULL;
+}
+
+/**
+ * @brief Removes an entry from the order of use of a cache
+ *
+ * @param cache Cache
+ * @param entry Entry
+ */
+static void ifindex_cache_unlink(IFCache *cache, IFCacheEntry *entry)
+{
+     if (entry->newer != NULL)
+          entry->newer->older = entry->older;
+     else
+          cache->newest = entry->older;
+     if (entry->older != NULL)
+          entry->older->newer = entry->newer;
+     else
+          cache->oldest = entry->newer;
+}
+
+/**
+ * @brief Makes an entry the most recently used one of a cache
+ *
+ * @param cache Cache
+ * @param entry Entry
+ */
+static void ifindex_cache_push(IFCache *cache, IFCacheEntry *entry)
+{
+     entry->newer = NULL;
+     entry->older = cache->newest;
+     if (cache->newest != NULL)
+          cache->newest->newer = entry;
+     else
+          cache->oldest = entry;
+     cache->newest = entry;
+}
+
+/**
+ * @brief Evicts the least recently used entry of a cache
+ *
+ * @param cache Cache with at least one entry
+ */
+static void ifindex_cache_evict(IFCache *cache)
+{
+     IFCacheEntry *entry = cache->oldest;
+     IFCacheEntry **link = &cache->buckets[entry->key % IFINDEX_CACHE_BUCKETS];
+     while (*link != entry)
+          link = &(*link)->next;
+     *link = entry->next;
+     ifindex_cache_unlink(cache, entry);
+
+     cache->bytes -= sizeof(IFCacheEntry) + entry->query.size * sizeof(Item) + entry->bytes;
+     cache->size--;
+     cache->evictions++;
+     list_destroy(&entry->query);
+     free(entry->value);
+     free(entry);
+}
+
+/**
+ * @brief Looks up the result of a query in a cache. Queries are equal if
+ *        they have the same items and frequencies in the same order, so
+ *        they should be sorted by item.
+ *
+ * @param cache Cache
+ * @param query Query list
+ * @param param Parameter of the query
+ * @param bytes Size of the result (set if it is cached)
+ *
+ * @return Copy of the cached result or NULL if it is not cached
+ */
+void *ifindex_cache_get(IFCache *cache, List *query, uint param, size_t *bytes)
+{
+     ullong key = ifindex_cache_key(query, param);
+     void *value = NULL;
+#pragma omp critical (ifindex_cache)
+     {
+          IFCacheEntry *entry = ifindex_cache_find(cache, key, query, param);
+          if (entry != NULL) {
+               ifindex_cache_unlink(cache, entry);
+               ifindex_cache_push(cache, entry);
+               *bytes = entry->bytes;
+               value = malloc(entry->bytes > 0 ? entry->bytes : 1);
+               memcpy(value, entry->value, entry->bytes);
+               cache->hits++;
+          } else {
+               cache->misses++;
+          }
+     }
+
+     return value;
+}
+
+/**
+ * @brief Adds the result of a query to a cache, evicting the least
+ *        recently used results to make room for it. Results larger than
+ *        the cache are not added.
+ *
+ * @param cache Cache
+ * @param query Query list
+ * @param param Parameter of the query
+ * @param value Result of the query (copied)
+ * @param bytes Size of the result
+ */
+void ifindex_cache_put(IFCache *cache, List *query, uint param, void *value, size_t bytes)
+{
+     size_t size = sizeof(IFCacheEntry) + query->size * sizeof(Item) + bytes;
+     if (size > cache->capacity)
+          return;
+
+     ullong key = ifindex_cache_key(query, param);
+     IFCacheEntry *entry = (IFCacheEntry *) malloc(sizeof(IFCacheEntry));
+     entry->key = key;
+     entry->query = list_duplicate(query);
+     entry->param = param;
+     entry->value = malloc(bytes > 0 ? bytes : 1);
+     if (bytes > 0) // empty results have no data
+          memcpy(entry->value, value, bytes);
+     entry->bytes = bytes;
+
+#pragma omp critical (ifindex_cache)
+     {
+          // another thread may have added the same query meanwhile
+          if (ifindex_cache_find(cache, key, query, param) == NULL) {
+               while (cache->bytes + size > cache->capacity)
+                    ifindex_cache_evict(cache);
+               entry->next = cache->buckets[key % IFINDEX_CACHE_BUCKETS];
+               cache->buckets[key % IFINDEX_CACHE_BUCKETS] = entry;
+               ifindex_cache_push(cache, entry);
+               cache->bytes += size;
+               cache->size++;
+               entry = NULL;
+          }
+     }
+
+     if (entry != NULL) {
+          list_destroy(&entry->query);
+          free(entry->value);
+          free(entry);
+     }
+}
+
+/**
+ * @brief Makes a query keeping only the documents with a minimum number
+ *        of hits (see ifindex_query_threshold), reusing the result of a
+ *        previous query with the same items and threshold if it is in the
+ *        cache
+ *
+ * @param ifindex Inverted file index
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param cache Cache of results of the inverted file or NULL
+ * @param acc Accumulator with at least ifindex->dim documents
+ *
+ * @return Retrieved documents sorted by item, with their hits as frequency
+ */
+List ifindex_query_cached(ListDB *ifindex, List *query, uint min_hits, IFCache *cache,
+                          IFAccumulator *acc)
+{
+     if (cache == NULL)
+          return ifindex_query_threshold(ifindex, query, min_hits, acc);
+
+     size_t bytes;
+     List result;
+     list_init(&result);
+     result.data = (Item *) ifindex_cache_get(cache, query, min_hits, &bytes);
+     if (result.data != NULL) {
+          result.size = bytes / sizeof(Item);
+          if (result.size == 0) {
+               free(result.data);
+               result.data = NULL;
+          }
+          return result;
+     }
+
+     result = ifindex_query_threshold(ifindex, query, min_hits, acc);
+     ifindex_cache_put(cache, query, min_hits, result.data, result.size * sizeof(Item));
+
+     return result;
+}
+
+/**
+ * @brief Computes the largest frequency of each posting list, which
+ *        bounds the score a list can add to a document in top-k queries
+ *
+ * @param ifindex Inverted file index
+ * @param maxfreq Largest frequency of each list (ifindex->size)
+ */
+void ifindex_max_frequencies(ListDB *ifindex, uint *maxfreq)
+{
+     int i;
+#pragma omp parallel for schedule(dynamic, 1024)
+     for (i = 0; i < ifindex->size; i++) {
+          uint j;
+          maxfreq[i] = 0;
+          for (j = 0; j < ifindex->lists[i].size; j++)
+               if (maxfreq[i] < ifindex->lists[i].data[j].freq)
+                    maxfreq[i] = ifindex->lists[i].data[j].freq;
+     }
+}
+
+/**
+ * @brief Compares two results of a top-k query. A result is worse than
+ *        another if it has a lower score or the same score and a larger
+ *        document id.
+ *
+ * @param a First result
+ * @param b Second result
+ *
+ * @return Nonzero if the first result is worse than the second one
+ */
+static int ifindex_worse(Score *a, Score *b)
+{
+     return a->value < b->value || (a->value == b->value && a->index > b->index);
+}
+
+/**
+ * @brief Restores the order of a heap of results whose root (the worst
+ *        result) was replaced
+ *
+ * @param heap Results with the worst one at the root
+ * @param size Number of results
+ */
+static void ifindex_heap_sift_down(Score *heap, uint size)
+{
+     uint parent = 0;
+     Score top = heap[0];
+     while (2 * parent + 1 < size) {
+          uint child = 2 * parent + 1;
+          if (child + 1 < size && ifindex_worse(&heap[child + 1], &heap[child]))
+               child++;
+          if (!ifindex_worse(&heap[child], &top))
+               break;
+          heap[parent] = heap[child];
+          parent = child;
+     }
+     heap[parent] = top;
+}
+
+/**
+ * @brief Finds the first posting of a list with a document id that is
+ *        not smaller than a given one, galloping from a position
+ *
+ * @param list Posting list
+ * @param position Position to start from
+ * @param doc Document id
+ *
+ * @return Position of the posting or list->size if there is none
+ */
+static uint ifindex_seek(List *list, uint position, uint doc)
+{
+     uint step = 1;
+     uint low = position, high = position;
+     while (high < list->size && list->data[high].item < doc) {
+          low = high + 1;
+          high += step;
+          step *= 2;
+     }
+     if (high > list->size)
+          high = list->size;
+
+     while (low < high) {
+          uint middle = low + (high - low) / 2;
+          if (list->data[middle].item < doc)
+               low = middle + 1;
+          else
+               high = middle;
+     }
+
+     return low;
+}
+
+/**
+ * @brief Compares scores in increasing order, breaking ties by index
+ *        (list_score_compare truncates differences smaller than 1). Used
+ *        to order query terms by bound and queries by cost.
+ *
+ * @param a First score
+ * @param b Second score
+ *
+ * @return Negative if the first bound is smaller, positive if it is
+ *         larger and 0 if both are equal
+ */
+static int ifindex_score_compare(const void *a, const void *b)
+{
+     Score *sa = (Score *) a, *sb = (Score *) b;
+     if (sa->value != sb->value)
+          return sa->value < sb->value ? -1 : 1;
+
+     return (sa->index > sb->index) - (sa->index < sb->index);
+}
+
+/**
+ * @brief Retrieves the k documents with the largest scores for a query.
+ *        The score of a document is the sum over the query items of the
+ *        item frequency in the query, its weight and its frequency in the
+ *        document. Queries are evaluated document at a time with MaxScore
+ *        dynamic pruning: lists whose upper bounds add up to less than the
+ *        k-th best score can not retrieve a document on their own, so they
+ *        are only probed for documents found in the other lists, and
+ *        documents are dropped as soon as their remaining bound can not
+ *        reach the k-th best score. Weights must not be negative.
+ *
+ * @param ifindex Inverted file index with lists sorted by document id
+ * @param query Query list
+ * @param weights Weight of each item or NULL for weights equal to 1
+ * @param maxfreq Largest frequency of each posting list (see
+ *        ifindex_max_frequencies) or NULL to take it from the file saved
+ *        by ifindex_save or compute it for the query
+ * @param k Number of documents to retrieve
+ * @param results Retrieved documents (at least k), sorted by decreasing
+ *        score and then by increasing document id
+ *
+ * @return Number of retrieved documents (at most k)
+ */
+uint ifindex_query_topk(ListDB *ifindex, List *query, double *weights, uint *maxfreq, uint k,
+                        Score *results)
+{
+     uint i, j;
+     uint n = query->size;
+     if (k == 0 || n == 0)
+          return 0;
+
+     IFSkips skips;
+     if (ifindex_skips_open(&skips, ifindex) && maxfreq == NULL)
+          maxfreq = skips.maxfreq;
+
+     // upper bound of each term, slightly inflated against rounding errors
+     Score *terms = (Score *) malloc(n * sizeof(Score));
+     for (i = 0; i < n; i++) {
+          uint t = query->data[i].item;
+          uint tmax = 0;
+          if (maxfreq != NULL) {
+               tmax = maxfreq[t];
+          } else {
+               for (j = 0; j < ifindex->lists[t].size; j++)
+                    if (tmax < ifindex->lists[t].data[j].freq)
+                         tmax = ifindex->lists[t].data[j].freq;
+          }
+          terms[i].index = i;
+          terms[i].value = (double) query->data[i].freq * (weights != NULL ? weights[t] : 1.0) *
+               tmax * (1.0 + 1e-9);
+          if (ifindex->access != NULL)
+               listdb_record_access(ifindex, t);
+     }
+     qsort(terms, n, sizeof(Score), ifindex_score_compare);
+
+     // bounds[i] is the largest score terms 0..i (by increasing bound) can add
+     List **lists = (List **) malloc(n * sizeof(List *));
+     uint *ids = (uint *) malloc(n * sizeof(uint));
+     double *factors = (double *) malloc(n * sizeof(double));
+     double *bounds = (double *) malloc(n * sizeof(double));
+     uint *positions = (uint *) calloc(n, sizeof(uint));
+     for (i = 0; i < n; i++) {
+          Item *q = &query->data[terms[i].index];
+          lists[i] = &ifindex->lists[q->item];
+          ids[i] = q->item;
+          factors[i] = (double) q->freq * (weights != NULL ? weights[q->item] : 1.0);
+          bounds[i] = terms[i].value + (i > 0 ? bounds[i - 1] : 0.0);
+     }
+
+     uint size = 0;
+     uint essential = 0; // terms before it are non-essential
+     double threshold = -1.0; // score to beat once k documents are found
+     for (;;) {
+          // next candidate is the smallest document in the essential lists
+          uint doc = UINT_MAX;
+          for (i = essential; i < n; i++)
+               if (positions[i] < lists[i]->size && lists[i]->data[positions[i]].item < doc)
+                    doc = lists[i]->data[positions[i]].item;
+          if (doc == UINT_MAX)
+               break;
+
+          double score = 0.0;
+          for (i = essential; i < n; i++) {
+               if (positions[i] < lists[i]->size && lists[i]->data[positions[i]].item == doc) {
+                    score += factors[i] * lists[i]->data[positions[i]].freq;
+                    positions[i]++;
+               }
+          }
+
+          // probes non-essential lists while the document can still get in
+          for (i = essential; i > 0; i--) {
+               if (score + bounds[i - 1] <= threshold)
+                    break;
+               positions[i - 1] = ifindex_skip_seek(ifindex, &skips, ids[i - 1], positions[i - 1],
+                                                    doc);
+               if (positions[i - 1] < lists[i - 1]->size &&
+                   lists[i - 1]->data[positions[i - 1]].item == doc)
+                    score += factors[i - 1] * lists[i - 1]->data[positions[i - 1]].freq;
+          }
+          if (i > 0 || (size == k && score <= threshold))
+               continue;
+
+          Score result = {score, doc};
+          if (size < k) {
+               // inserts and moves the result up the heap
+               uint child = size++;
+               while (child > 0 && ifindex_worse(&result, &results[(child - 1) / 2])) {
+                    results[child] = results[(child - 1) / 2];
+                    child = (child - 1) / 2;
+               }
+               results[child] = result;
+          } else {
+               results[0] = result;
+               ifindex_heap_sift_down(results, size);
+          }
+
+          if (size == k) {
+               threshold = results[0].value;
+               while (essential < n && bounds[essential] <= threshold)
+                    essential++;
+          }
+     }
+
+     // sorts the heap by decreasing score
+     uint remaining = size;
+     while (remaining > 1) {
+          Score worst = results[0];
+          results[0] = results[--remaining];
+          ifindex_heap_sift_down(results, remaining);
+          results[remaining] = worst;
+     }
+
+     free(terms);
+     free(lists);
+     free(ids);
+     free(factors);
+     free(bounds);
+     free(positions);
+
+     return size;
+}
+
+/**
+ * @brief Answers a batch of queries in parallel. Each thread reuses its
+ *        own accumulator, and queries are handed out dynamically from the
+ *        most to the least expensive (by the size of their posting lists),
+ *        so a few heavy queries do not delay the end of the batch.
+ *
+ * @param ifindex Inverted file index
+ * @param queries Query lists
+ * @param min_hits Minimum number of hits of each query or NULL for none
+ * @param cache Cache of results of the inverted file or NULL
+ * @param results Preallocated database with at least as many lists as
+ *        queries, where the result of each query is stored
+ */
+void ifindex_query_batch(ListDB *ifindex, ListDB *queries, uint *min_hits, IFCache *cache,
+                         ListDB *results)
+{
+     int i;
+     uint j;
+     if (results->size < queries->size) {
+          fprintf(stderr,"Error: There are %u result lists for %u queries\n",
+                  results->size, queries->size);
+          exit(EXIT_FAILURE);
+     }
+
+     // orders queries by their cost
+     Score *order = (Score *) malloc(queries->size * sizeof(Score));
+     uint dim = ifindex->dim;
+     for (i = 0; i < queries->size; i++) {
+          order[i].index = i;
+          order[i].value = 0.0;
+          for (j = 0; j < queries->lists[i].size; j++) {
+               List *posting = &ifindex->lists[queries->lists[i].data[j].item];
+               order[i].value += posting->size;
+               if (posting->size > 0 && posting->data[posting->size - 1].item >= dim)
+                    dim = posting->data[posting->size - 1].item + 1;
+          }
+     }
+     qsort(order, queries->size, sizeof(Score), ifindex_score_compare);
+
+#pragma omp parallel
+     {
+          IFAccumulator acc = ifindex_accumulator_create(dim);
+#pragma omp for schedule(dynamic)
+          for (i = queries->size - 1; i >= 0; i--) {
+               uint q = order[i].index;
+               results->lists[q] = ifindex_query_cached(ifindex, &queries->lists[q],
+                                                        min_hits != NULL ? min_hits[q] : 0,
+                                                        cache, &acc);
+          }
+          ifindex_accumulator_destroy(&acc);
+     }
+     free(order);
+}
+
+/**
+ * @brief Makes multiple queries to a database
+ *
+ * @param ifindex Inverted file index
+ * @param queries Query lists
+ *
+ * @return Query results
+ */
+ListDB ifindex_query_multi(ListDB *ifindex, ListDB *queries)
+{
+     ListDB query_results = listdb_create(queries->size, ifindex->dim);
+     ifindex_query_batch(ifindex, queries, NULL, NULL, &query_results);
+     return query_results;
+}
+
+/**
+ * @brief Makes a query to a compressed inverted file index. Posting
+ *        lists are decoded and merged, so its cost depends on the
+ *        retrieved postings and not on the number of documents.
+ *
+ * @param ifindex Compressed inverted file index
+ * @param query Query list
+ *
+ * @return Query result
+ */
+List ifindex_query_compressed(CListDB *ifindex, List *query)
+{
+     uint i;
+     List *decoded = (List *) malloc(query->size * sizeof(List));
+     List **postings = (List **) malloc(query->size * sizeof(List *));
+     for (i = 0; i < query->size; i++) { //retrieves each list in inverted
+          decoded[i] = clist_decode(&ifindex->lists[query->data[i].item]);
+          postings[i] = &decoded[i];
+     }
+     List query_result = list_merge_multi(postings, query->size);
+
+     for (i = 0; i < query->size; i++)
+          list_destroy(&decoded[i]);
+     free(decoded);
+     free(postings);
+
+     return query_result;
+}
+
+/**
+ * @brief Makes a query to a compressed inverted file index keeping only
+ *        the documents with a minimum number of hits (see
+ *        ifindex_query_threshold). Posting lists are decoded on the fly
+ *        while their hits are added up in the accumulator.
+ *
+ * @param ifindex Compressed inverted file index
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param acc Accumulator with at least ifindex->dim documents
+ *
+ * @return Retrieved documents sorted by item, with their hits as frequency
+ */
+List ifindex_query_compressed_threshold(CListDB *ifindex, List *query, uint min_hits,
+                                        IFAccumulator *acc)
+{
+     uint i;
+     Item *item;
+     CListIter iter;
+     for (i = 0; i < query->size; i++) { //retrieves each list in inverted
+          clist_iter_init(&iter, &ifindex->lists[query->data[i].item]);
+          while ((item = clist_iter_next(&iter)) != NULL) {
+               if (item->freq == 0) // never retrieves a document
+                    continue;
+               if (acc->counts[item->item] == 0)
+                    acc->touched[acc->size++] = item->item;
+               acc->counts[item->item] += item->freq;
+          }
+     }
+
+     return ifindex_accumulator_collect(acc, min_hits);
+}
+
+/**
+ * @brief Makes a query to an inverted file index whose rows are roaring
+ *        bitmaps keeping only the documents with a minimum number of
+ *        hits. The hits of a document are the number of query items it
+ *        contains. Rows are added up in a single pass, which also
+ *        collects the touched documents.
+ *
+ * @param ifindex Inverted file index of roaring bitmaps
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param acc Accumulator with at least ifindex->dim documents
+ *
+ * @return Retrieved documents sorted by item, with their hits as frequency
+ */
+List ifindex_query_roaring_threshold(RoaringDB *ifindex, List *query, uint min_hits,
+                                     IFAccumulator *acc)
+{
+     uint i;
+     for (i = 0; i < query->size; i++) //retrieves each list in inverted
+          roaring_accumulate(&ifindex->bitmaps[query->data[i].item], acc->counts,
+                             acc->touched, &acc->size);
+
+     return ifindex_accumulator_collect(acc, min_hits);
+}
+
+/**
+ * Accumulator of ifindex_query_roaring, kept by each thread between
+ * queries and grown to the largest index it was used with
+ */
+static __thread IFAccumulator ifindex_roaring_acc;
+
+/**
+ * @brief Makes a query to an inverted file index whose rows are roaring
+ *        bitmaps. The frequency of each retrieved document is the
+ *        number of query items it contains. Hits are added up in an
+ *        accumulator of the calling thread that is reused by its next
+ *        queries (see ifindex_query_roaring_threshold).
+ *
+ * @param ifindex Inverted file index of roaring bitmaps
+ * @param query Query list
+ *
+ * @return Query result sorted by item
+ */
+List ifindex_query_roaring(RoaringDB *ifindex, List *query)
+{
+     IFAccumulator *acc = &ifindex_roaring_acc;
+     if (acc->dim < ifindex->dim) {
+          ifindex_accumulator_destroy(acc);
+          *acc = ifindex_accumulator_create(ifindex->dim);
+     }
+
+     return ifindex_query_roaring_threshold(ifindex, query, 1, acc);
+}
+
+/**
+ * @brief Discards all lists that are less frequent than a given frequency
+ *
+ * @param query_results Lists
+ * @param min_freq Minimum frequency
+ */
+void ifindex_discard_less_frequent(ListDB *query_results, uint min_freq)
+{
+     uint i;
+     for (i = 0; i < query_results->size; i++)
+          list_delete_less_frequent(&query_results->lists[i], min_freq);
+}
+
+/**
+ * @brief Discards all lists that are more frequent than a given frequency
+ *
+ * @param query_results Lists
+ * @param max_freq Maximum frequency
+ */
+void ifindex_discard_more_frequent(ListDB *query_results, uint max_freq)
+{
+     uint i;
+     for (i = 0; i < query_results->size; i++)
+          list_delete_more_frequent(&query_results->lists[i], max_freq);
+}
+
+/**
+ * @brief Ranks query results based on document hits
+ *
+ * @param query_results Database of lists with query results
+ */
+void ifindex_rank_more_frequent(ListDB *query_results)
+{
+     listdb_apply_to_all(query_results, list_sort_by_frequency_back);
+}
+     
+/**
+ * @brief Splits a batch of documents into consecutive parts with about
+ *        the same number of postings, one for each thread. Fewer parts
+ *        are used when the term counters of the parts would take more
+ *        space than the postings themselves.
+ *
+ * @param docs Batch of documents
+ * @param dim Number of terms
+ * @param bounds First document of each part and end of the last part
+ *
+ * @return Number of parts
+ */
+static uint ifindex_partition(ListDB *docs, uint dim, uint **bounds)
+{
+     uint i, p, parts = 1;
+     ullong postings = 0;
+     for (i = 0; i < docs->size; i++)
+          postings += docs->lists[i].size;
+
+#ifdef _OPENMP
+     parts = omp_get_max_threads();
+#endif
+     if ((ullong) parts * dim > postings)
+          parts = dim > 0 ? postings / dim : 1;
+     if (parts > docs->size)
+          parts = docs->size;
+     if (parts == 0)
+          parts = 1;
+
+     *bounds = (uint *) malloc((parts + 1) * sizeof(uint));
+     (*bounds)[0] = 0;
+     ullong seen = 0;
+     for (i = 0, p = 1; i < docs->size && p < parts; i++) {
+          seen += docs->lists[i].size;
+          while (p < parts && seen * parts >= postings * p)
+               (*bounds)[p++] = i + 1;
+     }
+     while (p <= parts)
+          (*bounds)[p++] = docs->size;
+
+     return parts;
+}
+
+/**
+ * @brief Counts the postings of each term in each part of a batch of
+ *        documents. Parts are counted in parallel.
+ *
+ * @param docs Batch of documents
+ * @param dim Number of terms
+ * @param parts Number of parts
+ * @param bounds First document of each part and end of the last part
+ *
+ * @return Counters of the terms of each part (parts x dim)
+ */
+static uint *ifindex_count_postings(ListDB *docs, uint dim, uint parts, uint *bounds)
+{
+     int p;
+     uint *counts = (uint *) calloc((size_t) parts * dim, sizeof(uint));
+#pragma omp parallel for schedule(static, 1)
+     for (p = 0; p < parts; p++) {
+          uint i, j;
+          uint *count = counts + (size_t) p * dim;
+          for (i = bounds[p]; i < bounds[p + 1]; i++)
+               for (j = 0; j < docs->lists[i].size; j++)
+                    count[docs->lists[i].data[j].item]++;
+     }
+
+     return counts;
+}
+
+/**
+ * @brief Writes the postings of a batch of documents into posting lists
+ *        that already have their final size. Each part is scattered by a
+ *        thread into its own slice of every list, so postings stay in
+ *        increasing document order.
+ *
+ * @param docs Batch of documents
+ * @param first Id of the first document of the batch
+ * @param ifindex Inverted file index with lists of their final size
+ * @param parts Number of parts
+ * @param bounds First document of each part and end of the last part
+ * @param counts Counters of the terms of each part (overwritten)
+ * @param next Position of the next posting of each term (updated)
+ */
+static void ifindex_scatter_postings(ListDB *docs, uint first, ListDB *ifindex, uint parts,
+                                     uint *bounds, uint *counts, uint *next)
+{
+     int t, p;
+     uint dim = ifindex->size;
+
+     // turns the counters into the position of each part in each list
+#pragma omp parallel for schedule(static)
+     for (t = 0; t < dim; t++) {
+          uint k;
+          for (k = 0; k < parts; k++) {
+               uint count = counts[(size_t) k * dim + t];
+               counts[(size_t) k * dim + t] = next[t];
+               next[t] += count;
+          }
+     }
+
+#pragma omp parallel for schedule(static, 1)
+     for (p = 0; p < parts; p++) {
+          uint i, j;
+          uint *position = counts + (size_t) p * dim;
+          for (i = bounds[p]; i < bounds[p + 1]; i++) {
+               for (j = 0; j < docs->lists[i].size; j++) {
+                    uint tid = docs->lists[i].data[j].item;
+                    Item item = {first + i, docs->lists[i].data[j].freq};
+                    ifindex->lists[tid].data[position[tid]++] = item;
+               }
+          }
+     }
+}
+
+/**
+ * @brief Makes inverted file from a given corpus. Document frequencies
+ *        are counted first so posting lists are allocated with their
+ *        final sizes, and then filled in parallel.
+ *
+ * @param corpus Corpus
+ * @param arena Whether posting lists are slices of a single arena
+ *
+ * @return Inverted file index
+ */
+static ListDB ifindex_make_postings(ListDB *corpus, int arena)
+{
+     int t;
+     uint *bounds;
+     uint parts = ifindex_partition(corpus, corpus->dim, &bounds);
+     uint *counts = ifindex_count_postings(corpus, corpus->dim, parts, bounds);
+
+     // counts the documents of each term to allocate the lists
+     uint *df = (uint *) calloc(corpus->dim, sizeof(uint));
+#pragma omp parallel for schedule(static)
+     for (t = 0; t < corpus->dim; t++) {
+          uint k;
+          for (k = 0; k < parts; k++)
+               df[t] += counts[(size_t) k * corpus->dim + t];
+     }
+     ListDB ifindex = arena ? listdb_create_arena(corpus->dim, corpus->size, df)
+                            : listdb_create_sized(corpus->dim, corpus->size, df);
+
+     // reads corpus and fills the inverted file
+     memset(df, 0, corpus->dim * sizeof(uint));
+     ifindex_scatter_postings(corpus, 0, &ifindex, parts, bounds, counts, df);
+     free(counts);
+     free(bounds);
+     free(df);
+
+     return ifindex;
+}
+
+/**
+ * @brief Makes inverted file from a given corpus (see
+ *        ifindex_make_postings). Posting lists own their documents, so
+ *        they can be pruned or resized.
+ *
+ * @param corpus Corpus
+ *
+ * @return Inverted file index
+ */
+ListDB ifindex_make_from_corpus(ListDB *corpus)
+{
+     return ifindex_make_postings(corpus, 0);
+}
+
+/**
+ * @brief Makes inverted file from a given corpus into a single arena
+ *        (see ifindex_make_postings), which is faster to build and
+ *        destroy. Posting lists must not be reallocated or freed, so it is
+ *        meant for indexes that are only queried or saved.
+ *
+ * @param corpus Corpus
+ *
+ * @return Inverted file index
+ */
+ListDB ifindex_make_from_corpus_arena(ListDB *corpus)
+{
+     return ifindex_make_postings(corpus, 1);
+}
+
+/**
+ * @brief Adds the postings of each term of a batch of documents to
+ *        the document frequencies.
+ *
+ * @param batch Batch of documents
+ * @param df Document frequency of each term (updated)
+ */
+static void ifindex_count_batch(ListDB *batch, uint *df)
+{
+     int t;
+     uint *bounds;
+     uint parts = ifindex_partition(batch, batch->dim, &bounds);
+     uint *counts = ifindex_count_postings(batch, batch->dim, parts, bounds);
+#pragma omp parallel for schedule(static)
+     for (t = 0; t < batch->dim; t++) {
+          uint k;
+          for (k = 0; k < parts; k++)
+               df[t] += counts[(size_t) k * batch->dim + t];
+     }
+     free(counts);
+     free(bounds);
+}
+
+/**
+ * @brief Writes the postings of a batch of documents into an inverted
+ *        file whose lists already have their final size.
+ *
+ * @param batch Batch of documents
+ * @param first Id of the first document of the batch
+ * @param ifindex Inverted file index
+ * @param next Position of the next posting of each term (updated)
+ */
+static void ifindex_fill_batch(ListDB *batch, uint first, ListDB *ifindex, uint *next)
+{
+     uint *bounds;
+     uint parts = ifindex_partition(batch, ifindex->size, &bounds);
+     uint *counts = ifindex_count_postings(batch, ifindex->size, parts, bounds);
+     ifindex_scatter_postings(batch, first, ifindex, parts, bounds, counts, next);
+     free(counts);
+     free(bounds);
+}
+
+/**
+ * @brief Creates an inverted file from a corpus that is read in batches,
+ *        so the corpus is never loaded as a whole. A first pass counts
+ *        the document frequency of each term and a second pass fills
+ *        the posting lists. The second pass is skipped when
+ *        the whole corpus fits in a single batch.
+ *
+ * @param reader Reader of the corpus
+ *
+ * @return Inverted file
+ */
+ListDB ifindex_make_from_reader(ListDBReader *reader)
+{
+     uint capacity = 0, size = 0, batches = 0;
+     uint *df = NULL;
+
+     ListDB batch, first;
+     listdb_init(&batch);
+     listdb_init(&first);
+     listdb_reader_rewind(reader);
+     while (listdb_reader_next_batch(reader, &batch) > 0) {
+          if (batch.dim > capacity) { // new terms
+               uint newcapacity = 2 * capacity > batch.dim ? 2 * capacity : batch.dim;
+               df = realloc(df, newcapacity * sizeof(uint));
+               memset(df + capacity, 0, (newcapacity - capacity) * sizeof(uint));
+               capacity = newcapacity;
+          }
+          if (batch.dim > size)
+               size = batch.dim;
+          ifindex_count_batch(&batch, df);
+
+          if (batches++ == 0) { // keeps the first batch in case it is the only one
+               first = batch;
+               listdb_init(&batch);
+          }
+     }
+     uint number_of_documents = reader->position;
+
+     ListDB ifindex = listdb_create_sized(size, number_of_documents, df);
+     if (size > 0)
+          memset(df, 0, size * sizeof(uint));
+     if (batches == 1) {
+          ifindex_fill_batch(&first, 0, &ifindex, df);
+     } else if (batches > 1) {
+          listdb_reader_rewind(reader);
+          while (listdb_reader_next_batch(reader, &batch) > 0)
+               ifindex_fill_batch(&batch, reader->batch_start, &ifindex, df);
+     }
+     listdb_destroy(&first);
+     listdb_destroy(&batch);
+     free(df);
+
+     return ifindex;
+}
+
+/**
+ * @brief Merges the inverted file indexes of consecutive shards of a
+ *        corpus. Document ids of each shard are shifted by its offset, so
+ *        merged posting lists are the concatenation of the shard lists.
+ *
+ * @param ifindexes Inverted file indexes of the shards
+ * @param number_of_shards Number of shards
+ * @param offsets Id of the first document of each shard (non-decreasing)
+ *
+ * @return Inverted file index of the whole corpus
+ */
+ListDB ifindex_merge(ListDB *ifindexes, uint number_of_shards, uint *offsets)
+{
+     uint i, t;
+     uint size = 0, dim = 0;
+     for (i = 0; i < number_of_shards; i++) {
+          if (offsets[i] < dim) {
+               fprintf(stderr,"Error: Shard %u overlaps with the previous shard\n", i);
+               exit(EXIT_FAILURE);
+          }
+          dim = offsets[i] + ifindexes[i].dim;
+          if (size < ifindexes[i].size)
+               size = ifindexes[i].size;
+     }
+
+     uint *sizes = (uint *) calloc(size, sizeof(uint));
+     for (i = 0; i < number_of_shards; i++)
+          for (t = 0; t < ifindexes[i].size; t++)
+               sizes[t] += ifindexes[i].lists[t].size;
+     ListDB ifindex = listdb_create_sized(size, dim, sizes);
+     free(sizes);
+
+#pragma omp parallel for schedule(dynamic)
+     for (t = 0; t < size; t++) {
+          Item *next = ifindex.lists[t].data;
+          uint k, j;
+          for (k = 0; k < number_of_shards; k++) {
+               if (t >= ifindexes[k].size)
+                    continue;
+               List *list = &ifindexes[k].lists[t];
+               for (j = 0; j < list->size; j++, next++) {
+                    next->item = list->data[j].item + offsets[k];
+                    next->freq = list->data[j].freq;
+               }
+          }
+     }
+
+     return ifindex;
+}
+
+/**
+ * @brief Makes the inverted file index of a sharded corpus. As in
+ *        ifindex_make_from_reader, a first pass over the shards counts
+ *        the document frequency of each term and a second pass fills the
+ *        posting lists. Shards are loaded one at a time (each one in
+ *        parallel) and the last one is kept between the passes.
+ *
+ * @param manifest Manifest with the shards of the corpus
+ *
+ * @return Inverted file index
+ */
+ListDB ifindex_make_from_manifest(ListDBManifest *manifest)
+{
+     uint i, size = 0, dim = 0;
+     uint *df = NULL;
+
+     ListDB shard;
+     listdb_init(&shard);
+     for (i = 0; i < manifest->size; i++) {
+          if (manifest->offsets[i] < dim) {
+               fprintf(stderr,"Error: Shard %s overlaps with the previous shard\n",
+                       manifest->paths[i]);
+               exit(EXIT_FAILURE);
+          }
+          listdb_destroy(&shard);
+          shard = listdb_load_arena(manifest->paths[i]);
+          if (shard.dim > size) { // new terms
+               df = realloc(df, shard.dim * sizeof(uint));
+               memset(df + size, 0, (shard.dim - size) * sizeof(uint));
+               size = shard.dim;
+          }
+          if (shard.size > 0)
+               ifindex_count_batch(&shard, df);
+          dim = manifest->offsets[i] + shard.size;
+     }
+
+     ListDB ifindex = listdb_create_sized(size, dim, df);
+     if (size > 0)
+          memset(df, 0, size * sizeof(uint));
+     for (i = 0; i < manifest->size; i++) {
+          if (i + 1 < manifest->size) {
+               ListDB corpus = listdb_load_arena(manifest->paths[i]);
+               if (corpus.size > 0)
+                    ifindex_fill_batch(&corpus, manifest->offsets[i], &ifindex, df);
+               listdb_destroy(&corpus);
+          } else if (shard.size > 0) {
+               ifindex_fill_batch(&shard, manifest->offsets[i], &ifindex, df);
+          }
+     }
+     listdb_destroy(&shard);
+     free(df);
+
+     return ifindex;
+}
+
+/**
+ * @brief Adds new documents to an inverted file index. The index of the
+ *        new documents is built in parallel and merged after the existing
+ *        lists, so the corpus is not read again. Document frequencies are
+ *        the sizes of the lists and stay consistent for ifindex_weight.
+ *
+ * @param ifindex Inverted file index (replaced by the updated index)
+ * @param new_docs New documents
+ * @param doc_offset Id of the first new document (not smaller than the
+ *        number of documents of the index)
+ */
+void ifindex_append(ListDB *ifindex, ListDB *new_docs, uint doc_offset)
+{
+     if (doc_offset < ifindex->dim) {
+          fprintf(stderr,"Error: New documents start at %u but the inverted file "
+                  "has %u documents\n", doc_offset, ifindex->dim);
+          exit(EXIT_FAILURE);
+     }
+
+     ListDB ifindexes[2];
+     uint offsets[2] = {0, doc_offset};
+     ifindexes[0] = *ifindex;
+     ifindexes[1] = ifindex_make_from_corpus_arena(new_docs); // only read by the merge
+
+     ListDB merged = ifindex_merge(ifindexes, 2, offsets);
+     listdb_destroy(&ifindexes[1]);
+     listdb_destroy(ifindex);
+     *ifindex = merged;
+}
+
+/**
+ * @brief Saves an inverted file as a binary list database followed by
+ *        the largest frequency of each list and skip entries every
+ *        IFINDEX_SKIP_BLOCK postings, so long lists can be searched
+ *        without being scanned once the file is mapped. The file is read
+ *        as any binary list database.
+ *
+ * @param filename File where the inverted file will be saved
+ * @param ifindex Inverted file index with lists sorted by document id
+ */
+void ifindex_save(char *filename, ListDB *ifindex)
+{
+     uint i, j;
+     listdb_save_binary(filename, ifindex);
+
+     IFSkipHeader header;
+     memset(&header, 0, sizeof(IFSkipHeader));
+     memcpy(header.magic, IFINDEX_SKIP_MAGIC, sizeof(header.magic));
+     header.block_size = IFINDEX_SKIP_BLOCK;
+
+     uint *maxfreq = (uint *) calloc(ifindex->size + 1, sizeof(uint)); // padded to 8 bytes
+     ifindex_max_frequencies(ifindex, maxfreq);
+     ullong *starts = (ullong *) malloc((ifindex->size + 1) * sizeof(ullong));
+     starts[0] = 0;
+     for (i = 0; i < ifindex->size; i++) {
+          uint blocks = 0;
+          if (ifindex->lists[i].size > IFINDEX_SKIP_BLOCK)
+               blocks = (ifindex->lists[i].size + IFINDEX_SKIP_BLOCK - 1) / IFINDEX_SKIP_BLOCK;
+          starts[i + 1] = starts[i] + blocks;
+     }
+     header.number_of_skips = starts[ifindex->size];
+
+     IFSkip *skips = (IFSkip *) malloc((header.number_of_skips + 1) * sizeof(IFSkip));
+     for (i = 0; i < ifindex->size; i++) {
+          List *list = &ifindex->lists[i];
+          for (j = 0; j < starts[i + 1] - starts[i]; j++) {
+               uint position = j * IFINDEX_SKIP_BLOCK;
+               uint last = position + IFINDEX_SKIP_BLOCK < list->size ?
+                    position + IFINDEX_SKIP_BLOCK - 1 : list->size - 1;
+               skips[starts[i] + j].last = list->data[last].item;
+               skips[starts[i] + j].position = position;
+          }
+     }
+
+     FILE *file;
+     if (!(file = fopen(filename, "r+b"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     uint flags = LISTDB_FREQ | LISTDB_TRAILER;
+     uint padded = (ifindex->size + 1) / 2 * 2;
+     int failed = fseek(file, offsetof(ListDBHeader, flags), SEEK_SET) != 0 ||
+          fwrite(&flags, sizeof(uint), 1, file) != 1 ||
+          fseek(file, 0, SEEK_END) != 0 ||
+          fwrite(&header, sizeof(IFSkipHeader), 1, file) != 1 ||
+          fwrite(maxfreq, sizeof(uint), padded, file) != padded ||
+          fwrite(starts, sizeof(ullong), ifindex->size + 1, file) != ifindex->size + 1 ||
+          fwrite(skips, sizeof(IFSkip), header.number_of_skips, file) != header.number_of_skips;
+     free(maxfreq);
+     free(starts);
+     free(skips);
+
+     if (failed) {
+          fprintf(stderr,"Error: Could not write file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     if (fclose(file)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Finds the skip pointers of an inverted file saved by
+ *        ifindex_save and mapped in memory. They are only used while the
+ *        lists are still the ones in the mapping.
+ *
+ * @param skips Skip pointers and list metadata
  * @param ifindex Inverted file index
- * @param query Query list
  *
- * @return Query result
+ * @return 1 if the inverted file has skip pointers, 0 otherwise
  */
-List ifindex_query(ListDB *ifindex, List *query)
+int ifindex_skips_open(IFSkips *skips, ListDB *ifindex)
 {
-     List query_result;	
-     list_init(&query_result);
+     memset(skips, 0, sizeof(IFSkips));
+     if (ifindex->storage != LISTDB_MAPPED || ifindex->mapping == NULL || ifindex->detached)
+          return 0;
 
-     uint i;
-     for (i = 0; i < query->size; i++) //retrieves each list in inverted
-          list_append(&query_result, &ifindex->lists[query->data[i].item]);
-     list_sort_by_item(&query_result);
-     list_unique(&query_result);
+     ListDBHeader *header = (ListDBHeader *) ifindex->mapping;
+     if (!(header->flags & LISTDB_TRAILER) || !(header->flags & LISTDB_FREQ) ||
+         header->size != ifindex->size)
+          return 0;
 
-     return query_result;
+     char *end = (char *) ifindex->mapping + ifindex->mapping_size;
+     ullong *offsets = (ullong *) (header + 1);
+     IFSkipHeader *trailer = (IFSkipHeader *) ((Item *) (offsets + header->size + 1) +
+                                               header->number_of_items);
+     if ((char *) (trailer + 1) > end ||
+         memcmp(trailer->magic, IFINDEX_SKIP_MAGIC, sizeof(trailer->magic)) != 0)
+          return 0;
+
+     uint padded = (header->size + 1) / 2 * 2;
+     uint *maxfreq = (uint *) (trailer + 1);
+     ullong *starts = (ullong *) (maxfreq + padded);
+     IFSkip *entries = (IFSkip *) (starts + header->size + 1);
+     if ((char *) (entries + trailer->number_of_skips) != end ||
+         starts[header->size] != trailer->number_of_skips || trailer->block_size == 0) {
+          fprintf(stderr,"Error: Skip pointers of the inverted file are corrupted\n");
+          exit(EXIT_FAILURE);
+     }
+
+     skips->block_size = trailer->block_size;
+     skips->maxfreq = maxfreq;
+     skips->starts = starts;
+     skips->skips = entries;
+
+     return 1;
 }
 
 /**
- * @brief Makes multiple queries to a database
+ * @brief Finds the first posting of a list with a document id that is
+ *        not smaller than a given one. Skip entries are used to jump to
+ *        the block of the posting, which is then binary searched; lists
+ *        without skip entries are searched by galloping.
  *
  * @param ifindex Inverted file index
- * @param queries Query lists
+ * @param skips Skip pointers of the inverted file or NULL
+ * @param term Term of the posting list
+ * @param position Position to start from
+ * @param doc Document id
  *
- * @return Query results
+ * @return Position of the posting or the size of the list if there is none
  */
-ListDB ifindex_query_multi(ListDB *ifindex, ListDB *queries)
+uint ifindex_skip_seek(ListDB *ifindex, IFSkips *skips, uint term, uint position, uint doc)
 {
-     uint i;
-     ListDB query_results = listdb_create(queries->size, ifindex->dim);
-     for (i = 0; i < queries->size; i++) //retrieves each list in inverted
-          query_results.lists[i] = ifindex_query(ifindex, &queries->lists[i]);
-     return query_results;
+     List *list = &ifindex->lists[term];
+     if (skips == NULL || skips->skips == NULL || skips->starts[term] == skips->starts[term + 1])
+          return ifindex_seek(list, position, doc);
+     if (position >= list->size || list->data[position].item >= doc)
+          return position;
+
+     // first block whose last document is not smaller than doc
+     IFSkip *block = skips->skips + skips->starts[term] + position / skips->block_size;
+     IFSkip *last = skips->skips + skips->starts[term + 1];
+     IFSkip *end = last;
+     while (block < end) {
+          IFSkip *middle = block + (end - block) / 2;
+          if (middle->last < doc)
+               block = middle + 1;
+          else
+               end = middle;
+     }
+     if (block == last)
+          return list->size;
+
+     uint low = position > block->position ? position : block->position;
+     uint high = block + 1 < last ? (block + 1)->position : list->size;
+     while (low < high) {
+          uint middle = low + (high - low) / 2;
+          if (list->data[middle].item < doc)
+               low = middle + 1;
+          else
+               high = middle;
+     }
+
+     return low;
 }
 
 /**
- * @brief Discards all lists that are less frequent than a given frequency
+ * @brief Counts the documents of a sorted list that are in a posting
+ *        list. Long posting lists with skip pointers are searched for
+ *        each document instead of being merged with the list.
  *
- * @param query_results Lists
- * @param min_freq Minimum frequency
+ * @param ifindex Inverted file index
+ * @param skips Skip pointers of the inverted file or NULL
+ * @param term Term of the posting list
+ * @param docs Documents sorted by id
+ *
+ * @return Number of documents in the posting list
  */
-void ifindex_discard_less_frequent(ListDB *query_results, uint min_freq)
+uint ifindex_intersection_size(ListDB *ifindex, IFSkips *skips, uint term, List *docs)
+{
+     List *list = &ifindex->lists[term];
+     if (skips == NULL || skips->skips == NULL || skips->starts[term] == skips->starts[term + 1] ||
+         list->size < docs->size * IFINDEX_SKIP_FACTOR)
+          return list_intersection_size(list, docs);
+
+     uint i, position = 0, size = 0;
+     for (i = 0; i < docs->size && position < list->size; i++) {
+          position = ifindex_skip_seek(ifindex, skips, term, position, docs->data[i].item);
+          if (position < list->size && list->data[position].item == docs->data[i].item) {
+               size++;
+               position++;
+          }
+     }
+
+     return size;
+}
+
+/**
+ * @brief Sets the vocabulary size and the number of documents of
+ *        partitions whose lists have been built or loaded, finds the skip
+ *        pointers of mapped partitions and computes the largest frequency
+ *        of each list of the other ones.
+ *
+ * @param partitions Partitions of an inverted file
+ */
+static void ifindex_partitions_prepare(IFPartitions *partitions)
+{
+     uint p;
+     partitions->vocsize = 0;
+     partitions->dim = 0;
+     partitions->skips = (IFSkips *) malloc(partitions->size * sizeof(IFSkips));
+     partitions->maxfreq = (uint **) calloc(partitions->size, sizeof(uint *));
+     for (p = 0; p < partitions->size; p++) {
+          ListDB *part = &partitions->parts[p];
+          if (partitions->offsets[p] < partitions->dim) {
+               fprintf(stderr,"Error: Partition %u overlaps with the previous partition\n", p);
+               exit(EXIT_FAILURE);
+          }
+          partitions->dim = partitions->offsets[p] + part->dim;
+          if (partitions->vocsize < part->size)
+               partitions->vocsize = part->size;
+          if (!ifindex_skips_open(&partitions->skips[p], part)) {
+               partitions->maxfreq[p] = (uint *) malloc(part->size * sizeof(uint));
+               ifindex_max_frequencies(part, partitions->maxfreq[p]);
+          }
+     }
+}
+
+/**
+ * @brief Splits a corpus into partitions of consecutive documents with
+ *        about the same number of postings and makes the inverted file
+ *        of each one.
+ *
+ * @param corpus Corpus
+ * @param number_of_partitions Number of partitions
+ *
+ * @return Partitions of the inverted file
+ */
+IFPartitions ifindex_partitions_make(ListDB *corpus, uint number_of_partitions)
+{
+     uint i, p;
+     if (number_of_partitions == 0) {
+          fprintf(stderr,"Error: The number of partitions must be positive\n");
+          exit(EXIT_FAILURE);
+     }
+
+     ullong total = 0, postings = 0;
+     for (i = 0; i < corpus->size; i++)
+          total += corpus->lists[i].size;
+
+     IFPartitions partitions;
+     partitions.size = number_of_partitions;
+     partitions.parts = (ListDB *) malloc(number_of_partitions * sizeof(ListDB));
+     partitions.offsets = (uint *) malloc(number_of_partitions * sizeof(uint));
+     uint first = 0;
+     for (p = 0; p < number_of_partitions; p++) {
+          // documents up to the (p + 1)-th share of the postings
+          uint last = first;
+          ullong target = total * (p + 1) / number_of_partitions;
+          while (last < corpus->size && (p + 1 == number_of_partitions || postings < target))
+               postings += corpus->lists[last++].size;
+
+          ListDB docs;
+          listdb_init(&docs);
+          docs.size = last - first;
+          docs.dim = corpus->dim;
+          docs.lists = corpus->lists + first;
+          partitions.parts[p] = ifindex_make_from_corpus(&docs);
+          partitions.offsets[p] = first;
+          first = last;
+     }
+     ifindex_partitions_prepare(&partitions);
+
+     return partitions;
+}
+
+/**
+ * @brief Makes the inverted file of each shard of a corpus as a
+ *        partition. Shards are loaded and indexed one at a time (each
+ *        one in parallel), so only one shard is in memory at once.
+ *
+ * @param manifest Manifest with the shards of the corpus
+ *
+ * @return Partitions of the inverted file
+ */
+IFPartitions ifindex_partitions_from_manifest(ListDBManifest *manifest)
 {
      uint i;
-     for (i = 0; i < query_results->size; i++)
-          list_delete_less_frequent(&query_results->lists[i], min_freq);
+     IFPartitions partitions;
+     partitions.size = manifest->size;
+     partitions.parts = (ListDB *) malloc(manifest->size * sizeof(ListDB));
+     partitions.offsets = (uint *) malloc(manifest->size * sizeof(uint));
+     memcpy(partitions.offsets, manifest->offsets, manifest->size * sizeof(uint));
+     for (i = 0; i < manifest->size; i++) {
+          ListDB corpus = listdb_load_arena(manifest->paths[i]);
+          partitions.parts[i] = ifindex_make_from_corpus(&corpus);
+          listdb_destroy(&corpus);
+     }
+     ifindex_partitions_prepare(&partitions);
+
+     return partitions;
 }
 
 /**
- * @brief Discards all lists that are more frequent than a given frequency
+ * @brief Loads a partition of an inverted file. Binary partitions are
+ *        mapped (see listdb_open_mmap) so their skip pointers are used.
  *
- * @param query_results Lists
- * @param max_freq Maximum frequency
+ * @param filename Text or binary list database or compressed container
+ *
+ * @return Partition
  */
-void ifindex_discard_more_frequent(ListDB *query_results, uint max_freq)
+static ListDB ifindex_partition_load(char *filename)
+{
+     if (clistdb_is_container(filename))
+          return clistdb_load(filename);
+     if (listdb_is_binary(filename))
+          return listdb_open_mmap(filename);
+
+     return listdb_load_from_file(filename);
+}
+
+/**
+ * @brief Loads the partitions of an inverted file listed in a manifest
+ *        (each one a text or binary list database or a compressed list
+ *        container). Any other file is loaded as a single partition.
+ *
+ * @param filename Manifest or inverted file
+ *
+ * @return Partitions of the inverted file
+ */
+IFPartitions ifindex_partitions_load(char *filename)
+{
+     uint p;
+     IFPartitions partitions;
+     if (listdb_is_manifest(filename)) {
+          ListDBManifest manifest = listdb_manifest_load(filename);
+          partitions.size = manifest.size;
+          partitions.parts = (ListDB *) malloc(manifest.size * sizeof(ListDB));
+          partitions.offsets = (uint *) malloc(manifest.size * sizeof(uint));
+          for (p = 0; p < manifest.size; p++) {
+               partitions.parts[p] = ifindex_partition_load(manifest.paths[p]);
+               partitions.offsets[p] = manifest.offsets[p];
+          }
+          listdb_manifest_destroy(&manifest);
+     } else {
+          partitions.size = 1;
+          partitions.parts = (ListDB *) malloc(sizeof(ListDB));
+          partitions.offsets = (uint *) calloc(1, sizeof(uint));
+          partitions.parts[0] = ifindex_partition_load(filename);
+     }
+     ifindex_partitions_prepare(&partitions);
+
+     return partitions;
+}
+
+/**
+ * @brief Saves each partition of an inverted file next to a manifest
+ *        that lists them with their offsets. Partition i is saved in the
+ *        file named as the manifest followed by ".i".
+ *
+ * @param filename Manifest file
+ * @param partitions Partitions of the inverted file
+ * @param binary 1 to save the partitions with ifindex_save, 0 as text
+ */
+void ifindex_partitions_save(char *filename, IFPartitions *partitions, uint binary)
+{
+     uint p;
+     FILE *file;
+     if (!(file = fopen(filename, "w"))) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // partitions are listed relative to the directory of the manifest
+     char *name = strrchr(filename, '/');
+     name = name != NULL ? name + 1 : filename;
+     char *path = (char *) malloc(strlen(filename) + 12);
+     fprintf(file, "%s\n", LISTDB_MANIFEST_MAGIC);
+     for (p = 0; p < partitions->size; p++) {
+          sprintf(path, "%s.%u", filename, p);
+          if (binary)
+               ifindex_save(path, &partitions->parts[p]);
+          else
+               listdb_save_to_file(path, &partitions->parts[p]);
+          fprintf(file, "%s.%u %u\n", name, p, partitions->offsets[p]);
+     }
+     free(path);
+
+     if (fclose(file)) {
+          fprintf(stderr,"Error: Could not write file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Destroys the partitions of an inverted file
+ *
+ * @param partitions Partitions of the inverted file
+ */
+void ifindex_partitions_destroy(IFPartitions *partitions)
+{
+     uint p;
+     for (p = 0; p < partitions->size; p++) {
+          listdb_destroy(&partitions->parts[p]);
+          free(partitions->maxfreq[p]);
+     }
+     free(partitions->parts);
+     free(partitions->offsets);
+     free(partitions->skips);
+     free(partitions->maxfreq);
+     partitions->size = 0;
+     partitions->parts = NULL;
+     partitions->offsets = NULL;
+     partitions->skips = NULL;
+     partitions->maxfreq = NULL;
+}
+
+/**
+ * @brief Gets the items of a query that have a list in a partition
+ *
+ * @param part Partition of an inverted file
+ * @param query Query
+ * @param clipped List where the items are copied if some are missing
+ *
+ * @return The query if all its items have a list, clipped otherwise
+ */
+static List *ifindex_partition_terms(ListDB *part, List *query, List *clipped)
 {
      uint i;
-     for (i = 0; i < query_results->size; i++)
-          list_delete_more_frequent(&query_results->lists[i], max_freq);
+     for (i = 0; i < query->size && query->data[i].item < part->size; i++);
+     if (i == query->size)
+          return query;
+
+     clipped->size = 0;
+     for (i = 0; i < query->size; i++)
+          if (query->data[i].item < part->size)
+               list_push(clipped, query->data[i]);
+
+     return clipped;
 }
 
 /**
- * @brief Ranks query results based on document hits
+ * @brief Answers a batch of queries on the partitions of an inverted
+ *        file. Each (query, partition) pair is a task for the threads,
+ *        whose accumulators are as large as the largest partition, and
+ *        the results of the partitions are concatenated with global ids.
  *
- * @param query_results Database of lists with query results
+ * @param partitions Partitions of the inverted file
+ * @param queries Queries
+ * @param min_hits Minimum number of hits of each query or NULL
+ * @param results Result lists, one per query (overwritten)
  */
-void ifindex_rank_more_frequent(ListDB *query_results)
+void ifindex_partitions_query_batch(IFPartitions *partitions, ListDB *queries, uint *min_hits,
+                                    ListDB *results)
 {
-     listdb_apply_to_all(query_results, list_sort_by_frequency_back);
+     long t;
+     uint p, number_of_parts = partitions->size;
+     if (results->size < queries->size) {
+          fprintf(stderr,"Error: There are %u result lists for %u queries\n",
+                  results->size, queries->size);
+          exit(EXIT_FAILURE);
+     }
+
+     uint dim = 0;
+     for (p = 0; p < number_of_parts; p++)
+          if (dim < partitions->parts[p].dim)
+               dim = partitions->parts[p].dim;
+
+     List *partial = (List *) malloc((size_t) queries->size * number_of_parts * sizeof(List));
+#pragma omp parallel
+     {
+          IFAccumulator acc = ifindex_accumulator_create(dim);
+          List clipped;
+          list_init(&clipped);
+#pragma omp for schedule(dynamic)
+          for (t = 0; t < (long) queries->size * number_of_parts; t++) {
+               uint q = t / number_of_parts;
+               ListDB *part = &partitions->parts[t % number_of_parts];
+               List *terms = ifindex_partition_terms(part, &queries->lists[q], &clipped);
+               partial[t] = ifindex_query_threshold(part, terms, min_hits != NULL ? min_hits[q] : 0,
+                                                    &acc);
+          }
+          list_destroy(&clipped);
+          ifindex_accumulator_destroy(&acc);
+     }
+
+     // concatenates the results of the partitions, which are ordered by document
+#pragma omp parallel for schedule(dynamic)
+     for (t = 0; t < queries->size; t++) {
+          List *first = partial + t * number_of_parts;
+          if (number_of_parts == 1) {
+               results->lists[t] = *first;
+               continue;
+          }
+
+          uint i, j, size = 0;
+          for (i = 0; i < number_of_parts; i++)
+               size += first[i].size;
+          List result;
+          list_init(&result);
+          if (size > 0)
+               result.data = (Item *) malloc(size * sizeof(Item));
+          for (i = 0; i < number_of_parts; i++) {
+               for (j = 0; j < first[i].size; j++) {
+                    result.data[result.size].item = first[i].data[j].item + partitions->offsets[i];
+                    result.data[result.size].freq = first[i].data[j].freq;
+                    result.size++;
+               }
+               list_destroy(&first[i]);
+          }
+          results->lists[t] = result;
+     }
+     free(partial);
 }
-     
+
 /**
- * @brief Makes inverted file from a given corpus
+ * @brief Queries the partitions of an inverted file (see ifindex_query).
+ *        Partitions are queried one after the other and their results
+ *        are appended with global ids.
  *
- * @param corpus Corpus
+ * @param partitions Partitions of the inverted file
+ * @param query Query list
  *
- * @return Inverted file index
+ * @return List of documents with global ids and their hits
  */
-ListDB ifindex_make_from_corpus(ListDB *corpus)
+List ifindex_partitions_query(IFPartitions *partitions, List *query)
 {
-     uint i, j;
-     uint tid;
-	
-     // reads corpus and creates inverted file
-     ListDB ifindex = listdb_create(corpus->dim, corpus->size);
-     for (i = 0; i < corpus->size; i++) {
-          for (j = 0; j < corpus->lists[i].size; j++) {
-               tid = corpus->lists[i].data[j].item;
-               Item item = {i, corpus->lists[i].data[j].freq};
-               list_push(&ifindex.lists[tid], item);
+     uint p, j;
+     List result, clipped;
+     list_init(&result);
+     list_init(&clipped);
+     for (p = 0; p < partitions->size; p++) {
+          ListDB *part = &partitions->parts[p];
+          List partial = ifindex_query(part, ifindex_partition_terms(part, query, &clipped));
+          if (partial.size == 0)
+               continue;
+
+          result.data = realloc(result.data, (result.size + partial.size) * sizeof(Item));
+          for (j = 0; j < partial.size; j++) {
+               result.data[result.size].item = partial.data[j].item + partitions->offsets[p];
+               result.data[result.size].freq = partial.data[j].freq;
+               result.size++;
           }
+          list_destroy(&partial);
      }
+     list_destroy(&clipped);
 
-     return ifindex;
+     return result;
+}
+
+/**
+ * @brief Compares results by decreasing score and then by increasing
+ *        document id
+ *
+ * @param a First result
+ * @param b Second result
+ *
+ * @return Negative if the first result is better, positive if it is
+ *         worse and 0 if both are equal
+ */
+static int ifindex_result_compare(const void *a, const void *b)
+{
+     return ifindex_worse((Score *) a, (Score *) b) - ifindex_worse((Score *) b, (Score *) a);
+}
+
+/**
+ * @brief Retrieves the k documents with the largest scores for a query
+ *        (see ifindex_query_topk) from the partitions of an inverted file.
+ *        The partitions are queried in parallel and their top k documents
+ *        are merged.
+ *
+ * @param partitions Partitions of the inverted file
+ * @param query Query list
+ * @param weights Weight of each item or NULL for weights equal to 1
+ * @param k Number of documents to retrieve
+ * @param results Retrieved documents (at least k) with global ids
+ *
+ * @return Number of retrieved documents (at most k)
+ */
+uint ifindex_partitions_query_topk(IFPartitions *partitions, List *query, double *weights, uint k,
+                                   Score *results)
+{
+     int p;
+     uint number_of_parts = partitions->size;
+     if (k == 0 || number_of_parts == 0)
+          return 0;
+
+     Score *candidates = (Score *) malloc((size_t) number_of_parts * k * sizeof(Score));
+     uint *sizes = (uint *) malloc(number_of_parts * sizeof(uint));
+#pragma omp parallel for schedule(dynamic) if (number_of_parts > 1)
+     for (p = 0; p < number_of_parts; p++) {
+          uint i;
+          List clipped;
+          list_init(&clipped);
+          ListDB *part = &partitions->parts[p];
+          Score *top = candidates + (size_t) p * k;
+          sizes[p] = ifindex_query_topk(part, ifindex_partition_terms(part, query, &clipped),
+                                        weights, partitions->maxfreq[p], k, top);
+          for (i = 0; i < sizes[p]; i++)
+               top[i].index += partitions->offsets[p];
+          list_destroy(&clipped);
+     }
+
+     uint size = 0;
+     for (p = 0; p < number_of_parts; p++) {
+          memmove(candidates + size, candidates + (size_t) p * k, sizes[p] * sizeof(Score));
+          size += sizes[p];
+     }
+     qsort(candidates, size, sizeof(Score), ifindex_result_compare);
+     if (size > k)
+          size = k;
+     memcpy(results, candidates, size * sizeof(Score));
+     free(candidates);
+     free(sizes);
+
+     return size;
+}
+
+/**
+ * @brief Splits a list of documents sorted by global id into lists of
+ *        each partition of an inverted file with local ids
+ *
+ * @param partitions Partitions of the inverted file
+ * @param docs Documents sorted by global id
+ * @param local One list per partition (overwritten)
+ */
+void ifindex_partitions_split(IFPartitions *partitions, List *docs, List *local)
+{
+     uint p, i = 0;
+     for (p = 0; p < partitions->size; p++) {
+          uint offset = partitions->offsets[p];
+          uint end = offset + partitions->parts[p].dim;
+          while (i < docs->size && docs->data[i].item < offset)
+               i++;
+          uint first = i;
+          while (i < docs->size && docs->data[i].item < end)
+               i++;
+
+          list_init(&local[p]);
+          if (i > first)
+               local[p].data = (Item *) malloc((i - first) * sizeof(Item));
+          for (; first < i; first++) {
+               local[p].data[local[p].size].item = docs->data[first].item - offset;
+               local[p].data[local[p].size].freq = docs->data[first].freq;
+               local[p].size++;
+          }
+     }
+}
+
+/**
+ * @brief Counts the documents of each partition that are in the posting
+ *        list of a term (see ifindex_intersection_size)
+ *
+ * @param partitions Partitions of the inverted file
+ * @param term Term of the posting lists
+ * @param local Documents of each partition (see ifindex_partitions_split)
+ *
+ * @return Number of documents in the posting lists
+ */
+uint ifindex_partitions_intersection_size(IFPartitions *partitions, uint term, List *local)
+{
+     uint p, size = 0;
+     for (p = 0; p < partitions->size; p++)
+          if (term < partitions->parts[p].size && local[p].size > 0)
+               size += ifindex_intersection_size(&partitions->parts[p], &partitions->skips[p],
+                                                 term, &local[p]);
+
+     return size;
+}
+
+/**
+ * @brief Converts a weight to the integer frequency of a posting, which
+ *        is never 0.
+ *
+ * @param weight Weight of the posting
+ *
+ * @return Integer weight
+ */
+static uint ifindex_intweight(double weight)
+{
+     uint freq = weights_intweight(weight);
+
+     return freq != 0 ? freq : 1;
 }
 
 /**
- * @brief Computes weights of an inverted file structure
+ * @brief Weights the postings of an inverted file given the size and
+ *        number of terms of each document. Weights that only depend on
+ *        the term (or on small term frequencies) are computed once and
+ *        copied to the postings, and the terms are weighted in parallel.
+ *        Postings of a mapped inverted file are first copied out of the
+ *        read-only mapping (see listdb_unmap).
  *
  * @param ifindex Inverted file index
- * @param corpus Corpus
+ * @param docsizes Size of each document or NULL if wg does not read it
+ * @param docterms Number of terms of each document or NULL
+ * @param number_of_docs Number of documents of the corpus
  * @param wg Function to compute weight
  */
-void ifindex_weight(ListDB *ifindex, ListDB *corpus, double (*wg)(uint,uint,uint,uint,uint,uint))
+static void ifindex_weight_postings(ListDB *ifindex, uint *docsizes, uint *docterms,
+                                    uint number_of_docs,
+                                    double (*wg)(uint,uint,uint,uint,uint,uint))
 {
-     uint i, j;
+     uint i;
+     uint depends = weights_dependencies(wg);
+     listdb_unmap(ifindex);
 
-     // Computes size of documents
-     uint *docsizes = (uint *) calloc(corpus->size, sizeof(uint));
-     for (i = 0; i < corpus->size; i++)
-          for (j = 0; j < corpus->lists[i].size; j++) 
-               docsizes[i] += corpus->lists[i].data[j].freq;
+     // weights of small term frequencies when they are the only argument
+     uint *tfweights = NULL;
+     if (depends == WEIGHTS_DEPENDS_TF) {
+          tfweights = (uint *) malloc(WEIGHTS_TF_TABLE * sizeof(uint));
+          for (i = 0; i < WEIGHTS_TF_TABLE; i++)
+               tfweights[i] = ifindex_intweight(wg(i, 0, 0, 0, number_of_docs, ifindex->size));
+     }
 
      // performs term weighting
+#pragma omp parallel for schedule(dynamic, 64)
      for (i = 0; i < ifindex->size; i++) {
-          for (j = 0; j < ifindex->lists[i].size; j++) {
-               double wval = wg(ifindex->lists[i].data[j].freq, ifindex->lists[i].size,
-                                docsizes[ifindex->lists[i].data[j].item],
-                                corpus->lists[ifindex->lists[i].data[j].item].size,
-                                corpus->size, ifindex->size);
-               ifindex->lists[i].data[j].freq = weights_intweight(wval);
-               if (ifindex->lists[i].data[j].freq == 0)
-                    ifindex->lists[i].data[j].freq = 1;
+          uint j, df = ifindex->lists[i].size;
+          Item *postings = ifindex->lists[i].data;
+          if (!(depends & (WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC))) {
+               uint weight = ifindex_intweight(wg(0, df, 0, 0, number_of_docs, ifindex->size));
+               for (j = 0; j < df; j++)
+                    postings[j].freq = weight;
+          } else if (tfweights != NULL) {
+               for (j = 0; j < df; j++)
+                    postings[j].freq = postings[j].freq < WEIGHTS_TF_TABLE ?
+                         tfweights[postings[j].freq] :
+                         ifindex_intweight(wg(postings[j].freq, df, 0, 0, number_of_docs,
+                                              ifindex->size));
+          } else {
+               for (j = 0; j < df; j++) {
+                    uint doc = postings[j].item;
+                    postings[j].freq = ifindex_intweight(wg(postings[j].freq, df,
+                                                            docsizes != NULL ? docsizes[doc] : 0,
+                                                            docterms != NULL ? docterms[doc] : 0,
+                                                            number_of_docs, ifindex->size));
+               }
+          }
+     }
+
+     free(tfweights);
+}
+
+/**
+ * @brief Computes weights of an inverted file structure. Document sizes
+ *        are computed once (only if the weighting scheme reads them).
+ *
+ * @param ifindex Inverted file index
+ * @param corpus Corpus
+ * @param wg Function to compute weight
+ */
+void ifindex_weight(ListDB *ifindex, ListDB *corpus, double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i;
+
+     // Computes size of documents
+     uint *docsizes = NULL, *docterms = NULL;
+     if (weights_dependencies(wg) & WEIGHTS_DEPENDS_DOC) {
+          docsizes = (uint *) calloc(corpus->size, sizeof(uint));
+          docterms = (uint *) malloc(corpus->size * sizeof(uint));
+#pragma omp parallel for schedule(static)
+          for (i = 0; i < corpus->size; i++) {
+               uint j;
+               for (j = 0; j < corpus->lists[i].size; j++) 
+                    docsizes[i] += corpus->lists[i].data[j].freq;
+               docterms[i] = corpus->lists[i].size;
           }
      }
+
+     ifindex_weight_postings(ifindex, docsizes, docterms, corpus->size, wg);
+     free(docterms);
+     free(docsizes);
+}
+
+/**
+ * @brief Computes weights of an inverted file structure with the
+ *        document sizes stored in the statistics of its corpus (see
+ *        weights_stats_save), so the corpus is not read
+ *
+ * @param ifindex Inverted file index
+ * @param stats Mapped statistics of the corpus
+ * @param wg Function to compute weight
+ */
+void ifindex_weight_stats(ListDB *ifindex, StatsFile *stats,
+                          double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     if (stats->header->number_of_docs < ifindex->dim) {
+          fprintf(stderr,"Error: Statistics have %llu documents but the inverted file has %u\n",
+                  stats->header->number_of_docs, ifindex->dim);
+          exit(EXIT_FAILURE);
+     }
+
+     ifindex_weight_postings(ifindex, stats->doclens, stats->docterms,
+                             stats->header->number_of_docs, wg);
 }
@@ -22,6 +22,11 @@
 #include <string.h>
 #include <inttypes.h>
 #include <float.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "listdb.h"
 
 /**
@@ -34,6 +39,11 @@ void listdb_init(ListDB *listdb)
      listdb->size = 0;
      listdb->dim = 0;
      listdb->lists = NULL;
+     listdb->mapping = NULL;
+     listdb->mapping_size = 0;
+     listdb->storage = LISTDB_HEAP;
+     listdb->detached = 0;
+     listdb->access = NULL;
 }
 
 /**
@@ -49,6 +59,71 @@ ListDB listdb_create(uint size, uint dim)
      listdb.size = size;
      listdb.dim = dim;
      listdb.lists = (List *) calloc(size, sizeof(List));
+     listdb.mapping = NULL;
+     listdb.mapping_size = 0;
+     listdb.storage = LISTDB_HEAP;
+     listdb.detached = 0;
+     listdb.access = NULL;
+
+     return listdb;
+}
+
+/**
+ * @brief Creates a list database whose lists are slices of a single
+ *        buffer, so the database is built with two allocations and
+ *        destroyed in constant time. Items are left uninitialized.
+ *
+ * @param size Size of the database to create
+ * @param dim Dimensionality of the database
+ * @param sizes Size of each list
+ *
+ * @return Created database
+ */
+ListDB listdb_create_arena(uint size, uint dim, uint *sizes)
+{
+     ListDB listdb = listdb_create(size, dim);
+
+     uint i;
+     size_t number_of_items = 0;
+     for (i = 0; i < size; i++)
+          number_of_items += sizes[i];
+     if (number_of_items == 0)
+          return listdb;
+
+     Item *arena = (Item *) malloc(number_of_items * sizeof(Item));
+     Item *next = arena;
+     for (i = 0; i < size; i++) {
+          listdb.lists[i].size = sizes[i];
+          listdb.lists[i].data = sizes[i] > 0 ? next : NULL; // empty lists own nothing
+          next += sizes[i];
+     }
+     listdb.mapping = arena;
+     listdb.mapping_size = number_of_items * sizeof(Item);
+     listdb.storage = LISTDB_ARENA;
+
+     return listdb;
+}
+
+/**
+ * @brief Creates a list database whose lists have the given sizes and
+ *        own their items, so they can be resized and freed one by one.
+ *        Items are left uninitialized.
+ *
+ * @param size Size of the database to create
+ * @param dim Dimensionality of the database
+ * @param sizes Size of each list
+ *
+ * @return Created database
+ */
+ListDB listdb_create_sized(uint size, uint dim, uint *sizes)
+{
+     ListDB listdb = listdb_create(size, dim);
+
+     uint i;
+     for (i = 0; i < size; i++) {
+          listdb.lists[i].size = sizes[i];
+          listdb.lists[i].data = sizes[i] > 0 ? (Item *) malloc(sizes[i] * sizeof(Item)) : NULL;
+     }
 
      return listdb;
 }
@@ -82,6 +157,9 @@ ListDB listdb_random(uint dbsize, uint max_size, uint max_item)
 void listdb_clear(ListDB *listdb)
 {     
      free(listdb->lists);
+     if (listdb->access != NULL)
+          free(listdb->access->touched);
+     free(listdb->access);
      listdb_init(listdb);
 }
 
@@ -94,13 +172,81 @@ void listdb_destroy(ListDB *listdb)
 {     
      int i;
 
-     for (i = 0; i < listdb->size; i++)
-          list_destroy(&listdb->lists[i]);
+     if (listdb->mapping != NULL) { // lists are views of the storage
+          if (listdb->detached)
+               for (i = 0; i < listdb->size; i++)
+                    listdb_destroy_list(listdb, i);
+
+          if (listdb->storage == LISTDB_ARENA)
+               free(listdb->mapping);
+          else
+               munmap(listdb->mapping, listdb->mapping_size);
+     } else {
+          for (i = 0; i < listdb->size; i++)
+               list_destroy(&listdb->lists[i]);
+     }
 
      free(listdb->lists);
+     if (listdb->access != NULL)
+          free(listdb->access->touched);
+     free(listdb->access);
      listdb_init(listdb);
 }
 
+/**
+ * @brief Checks if the items of a list are stored in the mapping or arena
+ *        of a database
+ *
+ * @param listdb List database
+ * @param list List
+ *
+ * @return 1 if the list is a view of the storage, 0 if it owns its items
+ */
+static int listdb_in_storage(ListDB *listdb, List *list)
+{
+     char *data = (char *) list->data;
+     char *begin = (char *) listdb->mapping;
+
+     return begin != NULL && data >= begin && data < begin + listdb->mapping_size;
+}
+
+/**
+ * @brief Copies a list out of the mapping or arena of a database so it
+ *        can be resized or destroyed with the list functions. Lists that
+ *        already own their items are left untouched. Different lists can
+ *        be detached by several threads at once.
+ *
+ * @param listdb List database
+ * @param position Position of the list
+ */
+void listdb_detach_list(ListDB *listdb, uint position)
+{
+     List *list = &listdb->lists[position];
+     if (!listdb_in_storage(listdb, list))
+          return;
+
+     Item *data = (Item *) malloc(list->size * sizeof(Item));
+     memcpy(data, list->data, list->size * sizeof(Item));
+     list->data = data;
+#pragma omp atomic write
+     listdb->detached = 1;
+}
+
+/**
+ * @brief Destroys a list of a database. Items are only freed if the list
+ *        owns them.
+ *
+ * @param listdb List database
+ * @param position Position of the list
+ */
+void listdb_destroy_list(ListDB *listdb, uint position)
+{
+     if (listdb_in_storage(listdb, &listdb->lists[position]))
+          list_init(&listdb->lists[position]);
+     else
+          list_destroy(&listdb->lists[position]);
+}
+
 /**
  * @brief Prints a database of lists
  *
@@ -245,6 +391,10 @@ void listdb_swap_by_score(ListDB *listdb, Score *scores)
      uint i;
      for (i = 0; i < listdb->size; i++) 
           newlistdb.lists[i] = listdb->lists[scores[i].index];
+     newlistdb.mapping = listdb->mapping;
+     newlistdb.mapping_size = listdb->mapping_size;
+     newlistdb.storage = listdb->storage;
+     newlistdb.detached = listdb->detached;
      
      listdb_clear(listdb);
      *listdb = newlistdb;
@@ -338,6 +488,8 @@ void listdb_push(ListDB *listdb, List *list)
      listdb->lists = realloc(listdb->lists, newsize * sizeof(List));
      listdb->lists[listdb->size] = *list;
      listdb->size = newsize;
+     if (listdb->mapping != NULL)
+          listdb->detached = 1;
 }
 
 /**
@@ -348,7 +500,7 @@ void listdb_push(ListDB *listdb, List *list)
 void listdb_pop(ListDB *listdb)
 {
      listdb->size--;
-     list_destroy(&listdb->lists[listdb->size]);
+     listdb_destroy_list(listdb, listdb->size);
      listdb->lists = realloc(listdb->lists, listdb->size * sizeof(List));
 }
 
@@ -360,7 +512,9 @@ void listdb_pop(ListDB *listdb)
  */
 void listdb_pop_multi(ListDB *listdb, uint number)
 {
-     listdb_apply_to_range(listdb, list_destroy, listdb->size - number - 1, listdb->size - 1);
+     uint i;
+     for (i = listdb->size - number; i < listdb->size; i++)
+          listdb_destroy_list(listdb, i);
      listdb->size -= number;
      listdb->lists = realloc(listdb->lists, listdb->size * sizeof(List));
 }
@@ -373,7 +527,9 @@ void listdb_pop_multi(ListDB *listdb, uint number)
  */
 void listdb_pop_until(ListDB *listdb, uint last)
 {
-     listdb_apply_to_range(listdb, list_destroy, last, listdb->size - 1);
+     uint i;
+     for (i = last; i < listdb->size; i++)
+          listdb_destroy_list(listdb, i);
      listdb->size = last;
      listdb->lists = realloc(listdb->lists, listdb->size * sizeof(List));
 }
@@ -386,7 +542,7 @@ void listdb_pop_until(ListDB *listdb, uint last)
  */
 void listdb_delete_position(ListDB *listdb, uint position)
 {
-     list_destroy(&listdb->lists[position]);
+     listdb_destroy_list(listdb, position);
      uint newsize = listdb->size - 1;
      List *tmplists = (List *) malloc(newsize * sizeof(List));
      memcpy(tmplists, listdb->lists, position * sizeof(List));
@@ -406,7 +562,9 @@ void listdb_delete_position(ListDB *listdb, uint position)
  */
 void listdb_delete_range(ListDB *listdb, uint low, uint high)
 {    
-     listdb_apply_to_range(listdb, list_destroy, low, high);
+     uint i;
+     for (i = low; i <= high; i++)
+          listdb_destroy_list(listdb, i);
      uint range = high - low + 1;
      uint newsize = listdb->size - range;
      List *tmplists = (List *) malloc(newsize * sizeof(List));
@@ -436,7 +594,7 @@ void listdb_delete_smallest(ListDB *listdb, uint min_size)
      if (pos < listdb->size) {
           uint i;
           for (i = pos; i < listdb->size; i++)
-               list_destroy(&listdb->lists[i]);
+               listdb_destroy_list(listdb, i);
 
           listdb_pop_until(listdb, pos);
      }
@@ -460,7 +618,7 @@ void listdb_delete_largest(ListDB *listdb, uint max_size)
      if (pos < listdb->size) {
           uint i;
           for (i = pos; i < listdb->size; i++)
-               list_destroy(&listdb->lists[i]);
+               listdb_destroy_list(listdb, i);
 
           listdb_pop_until(listdb, pos);
      }
@@ -487,6 +645,8 @@ void listdb_insert(ListDB *listdb, List *new_list, uint position)
      free(listdb->lists);
      listdb->lists = tmplists;
      listdb->size = newsize;
+     if (listdb->mapping != NULL)
+          listdb->detached = 1;
 }
 
 /**
@@ -502,6 +662,33 @@ void listdb_append(ListDB *listdb1, ListDB *listdb2)
      listdb1->lists = realloc(listdb1->lists, newsize * sizeof(List));
      memcpy(listdb1->lists + listdb1->size, listdb2->lists, listdb2->size * sizeof(List));
      listdb1->size = newsize;
+     if (listdb1->mapping != NULL)
+          listdb1->detached = 1;
+}
+
+/**
+ * @brief Checks in a single pass which candidate lists of a database have
+ *        a similarity to a query list greater than a threshold. Candidates
+ *        that cannot reach the threshold because of their size are
+ *        discarded without intersecting them and each intersection stops
+ *        as soon as its outcome is known.
+ *
+ * @param listdb Database of lists
+ * @param query Query list (sorted by item)
+ * @param candidates IDs of the candidate lists in the database
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ * @param thres Similarity threshold
+ * @param passed Bitmap of (candidates->size + 63) / 64 words where bit i
+ *               is set if the i-th candidate passes the threshold
+ */
+void listdb_similarity_batch(ListDB *listdb, List *query, List *candidates, int measure,
+                             double thres, ullong *passed)
+{
+     uint i;
+     memset(passed, 0, ((candidates->size + 63) / 64) * sizeof(ullong));
+     for (i = 0; i < candidates->size; i++)
+          if (list_similarity_above(query, &listdb->lists[candidates->data[i].item], measure, thres))
+               passed[i / 64] |= 1ULL << (i % 64);
 }
 
 /**
@@ -513,6 +700,7 @@ void listdb_append(ListDB *listdb1, ListDB *listdb2)
  */
 void listdb_append_lists_delete(ListDB *listdb, uint position1, uint position2)
 {
+     listdb_detach_list(listdb, position1);
      list_append(&listdb->lists[position1], &listdb->lists[position2]);
      listdb_delete_position(listdb, position2);
 }
@@ -526,8 +714,9 @@ void listdb_append_lists_delete(ListDB *listdb, uint position1, uint position2)
  */
 void listdb_append_lists_destroy(ListDB *listdb, uint position1, uint position2)
 {
+     listdb_detach_list(listdb, position1);
      list_append(&listdb->lists[position1], &listdb->lists[position2]);
-     list_destroy(&listdb->lists[position2]);
+     listdb_destroy_list(listdb, position2);
 }
 
 /**
@@ -539,6 +728,7 @@ void listdb_append_lists_destroy(ListDB *listdb, uint position1, uint position2)
  */
 void listdb_add_lists_delete(ListDB *listdb, uint position1, uint position2)
 {
+     listdb_detach_list(listdb, position1);
      list_add(&listdb->lists[position1], &listdb->lists[position2]);
      listdb_delete_position(listdb, position2);
 }
@@ -552,8 +742,266 @@ void listdb_add_lists_delete(ListDB *listdb, uint position1, uint position2)
  */
 void listdb_add_lists_destroy(ListDB *listdb, uint position1, uint position2)
 {
+     listdb_detach_list(listdb, position1);
      list_add(&listdb->lists[position1], &listdb->lists[position2]);
-     list_destroy(&listdb->lists[position2]);
+     listdb_destroy_list(listdb, position2);
+}
+
+/**
+ * @brief Builds a list database from the arrays of a Compressed Sparse
+ *        Row (CSR) matrix. Rows are copied in parallel.
+ *
+ * @param size Number of rows
+ * @param dim Number of columns
+ * @param indptr Offsets of the first entry of each row (size + 1)
+ * @param indices Column of each entry
+ * @param data Frequency of each entry or NULL for frequencies equal to 1
+ *
+ * @return List database
+ */
+ListDB listdb_from_csr(uint size, uint dim, ullong *indptr, uint *indices, uint *data)
+{
+     int i;
+     uint *sizes = (uint *) malloc(size * sizeof(uint));
+     for (i = 0; i < size; i++) {
+          if (indptr[i + 1] < indptr[i] || indptr[i + 1] - indptr[i] > UINT_MAX) {
+               fprintf(stderr,"Error: Row pointers of the CSR matrix are not valid\n");
+               exit(EXIT_FAILURE);
+          }
+          sizes[i] = indptr[i + 1] - indptr[i];
+     }
+     ListDB listdb = listdb_create_sized(size, dim, sizes);
+     free(sizes);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+     for (i = 0; i < size; i++) {
+          uint j;
+          for (j = 0; j < listdb.lists[i].size; j++) {
+               listdb.lists[i].data[j].item = indices[indptr[i] + j];
+               listdb.lists[i].data[j].freq = data != NULL ? data[indptr[i] + j] : 1;
+          }
+     }
+
+     return listdb;
+}
+
+/**
+ * @brief Computes the row pointers of the CSR matrix of a list database
+ *
+ * @param listdb List database
+ * @param indptr Offsets of the first item of each list (size + 1)
+ */
+void listdb_csr_indptr(ListDB *listdb, ullong *indptr)
+{
+     uint i;
+     indptr[0] = 0;
+     for (i = 0; i < listdb->size; i++)
+          indptr[i + 1] = indptr[i] + listdb->lists[i].size;
+}
+
+/**
+ * @brief Checks if the lists of a database are stored back to back, as
+ *        in an arena or a mapping where no list was detached, so their
+ *        items can be used as the entries of a CSR matrix without copying.
+ *
+ * @param listdb List database
+ *
+ * @return First item of the database or NULL if the lists are not
+ *         stored back to back or the database is empty
+ */
+Item *listdb_contiguous_items(ListDB *listdb)
+{
+     uint i;
+     Item *first = NULL, *next = NULL;
+     for (i = 0; i < listdb->size; i++) {
+          if (listdb->lists[i].size == 0)
+               continue;
+          if (first == NULL)
+               first = next = listdb->lists[i].data;
+          else if (listdb->lists[i].data != next)
+               return NULL;
+          next += listdb->lists[i].size;
+     }
+
+     return first;
+}
+
+/**
+ * @brief Copies the items of a list database to the column and data
+ *        arrays of a CSR matrix
+ *
+ * @param listdb List database
+ * @param indices Column of each entry
+ * @param data Frequency of each entry
+ */
+void listdb_to_csr(ListDB *listdb, uint *indices, uint *data)
+{
+     int i;
+     ullong *indptr = (ullong *) malloc((listdb->size + 1) * sizeof(ullong));
+     listdb_csr_indptr(listdb, indptr);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+     for (i = 0; i < listdb->size; i++) {
+          uint j;
+          for (j = 0; j < listdb->lists[i].size; j++) {
+               indices[indptr[i] + j] = listdb->lists[i].data[j].item;
+               data[indptr[i] + j] = listdb->lists[i].data[j].freq;
+          }
+     }
+     free(indptr);
+}
+
+/**
+ * @brief Copies the frequencies of a list database to a dense row-major
+ *        matrix of size x dim that is already set to zero
+ *
+ * @param listdb List database
+ * @param array Dense matrix
+ */
+void listdb_to_dense(ListDB *listdb, double *array)
+{
+     int i;
+     for (i = 0; i < listdb->size; i++) {
+          uint j;
+          for (j = 0; j < listdb->lists[i].size; j++) {
+               if (listdb->lists[i].data[j].item >= listdb->dim) {
+                    fprintf(stderr,"Error: Item %u is out of the dimensionality %u\n",
+                            listdb->lists[i].data[j].item, listdb->dim);
+                    exit(EXIT_FAILURE);
+               }
+          }
+     }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+     for (i = 0; i < listdb->size; i++) {
+          uint j;
+          double *row = array + (size_t) i * listdb->dim;
+          for (j = 0; j < listdb->lists[i].size; j++)
+               row[listdb->lists[i].data[j].item] = listdb->lists[i].data[j].freq;
+     }
+}
+
+/**
+ * @brief Parses an unsigned integer skipping leading blanks
+ *
+ * @param p Current position in the text
+ * @param end End of the text
+ * @param value Parsed value
+ *
+ * @return Position after the integer or NULL if there is no integer
+ */
+static char *listdb_parse_uint(char *p, char *end, uint *value)
+{
+     while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+          p++;
+
+     if (p == end || *p < '0' || *p > '9')
+          return NULL;
+
+     uint number = 0;
+     while (p < end && *p >= '0' && *p <= '9')
+          number = number * 10 + (*p++ - '0');
+     *value = number;
+
+     return p;
+}
+
+/**
+ * @brief Parses a line of text
+ *        Format: 
+ *             size item_1:freq_1 item_2:freq_2 ... item_size:freq_size
+ *
+ * @param p Start of the line
+ * @param eol End of the line
+ * @param list Parsed list
+ * @param dim Largest item value plus one, updated with the parsed items
+ * @param buffer List where the items are appended (list->data is then
+ *               set to NULL), or NULL to allocate the items of the list
+ * @param capacity Number of items allocated in the buffer
+ *
+ * @return 1 if a list was parsed, 0 if the line is blank and -1 if it
+ *         is malformed
+ */
+static int listdb_parse_line(char *p, char *eol, List *list, uint *dim,
+                             List *buffer, uint *capacity)
+{
+     char *q = listdb_parse_uint(p, eol, &list->size);
+     if (q == NULL) // blank line
+          return 0;
+
+     Item *data;
+     if (buffer != NULL) {
+          if (buffer->size + list->size > *capacity) {
+               while (buffer->size + list->size > *capacity)
+                    *capacity = *capacity ? 2 * *capacity : 65536;
+               buffer->data = realloc(buffer->data, *capacity * sizeof(Item));
+          }
+          data = buffer->data + buffer->size;
+     } else {
+          data = (Item *) malloc(list->size * sizeof(Item));
+     }
+
+     uint j;
+     for (j = 0; j < list->size; j++) {
+          q = listdb_parse_uint(q, eol, &data[j].item);
+          if (q != NULL && q != eol)
+               q = listdb_parse_uint(q + 1, eol, &data[j].freq); // skips separator
+          else
+               q = NULL;
+          if (q == NULL) {
+               if (buffer == NULL)
+                    free(data);
+               return -1;
+          }
+          if (*dim < data[j].item + 1)
+               *dim = data[j].item + 1;
+     }
+
+     if (buffer != NULL) {
+          buffer->size += list->size;
+          list->data = NULL;
+     } else {
+          list->data = data;
+     }
+
+     return 1;
+}
+
+/**
+ * @brief Parses the lines of a chunk of text
+ *
+ * @param begin Start of the chunk (start of a line)
+ * @param end End of the chunk (after a newline or end of the file)
+ * @param chunk Database where the sizes of the parsed lists are stored
+ * @param items List where the items of all the lists are appended
+ *
+ * @return 1 if the chunk was parsed, 0 if a line is malformed
+ */
+static int listdb_parse_chunk(char *begin, char *end, ListDB *chunk, List *items)
+{
+     uint capacity = 0, item_capacity = 0;
+     char *p = begin;
+
+     while (p < end) {
+          char *eol = memchr(p, '\n', end - p);
+          if (eol == NULL)
+               eol = end;
+
+          List list;
+          int parsed = listdb_parse_line(p, eol, &list, &chunk->dim, items, &item_capacity);
+          if (parsed < 0)
+               return 0;
+          if (parsed > 0) {
+               if (chunk->size == capacity) {
+                    capacity = capacity ? 2 * capacity : 1024;
+                    chunk->lists = realloc(chunk->lists, capacity * sizeof(List));
+               }
+               chunk->lists[chunk->size++] = list;
+          }
+          p = eol + 1;
+     }
+
+     return 1;
 }
 
 /**
@@ -561,77 +1009,356 @@ void listdb_add_lists_destroy(ListDB *listdb, uint position1, uint position2)
  *        Format: 
  *             size item_1:freq_1 item_2:freq_2 ... item_size:freq_size
  *                        ...
+ *        The file is mapped in memory and split at line boundaries into
+ *        chunks that are parsed in parallel.
  *
  * @param filename File containing the inverted file index of lists
+ * @param arena Whether the items of all the lists are stored in a single
+ *              arena (see listdb_create_arena) instead of one heap
+ *              allocation per list
  *
  * @return List database
  */
-ListDB listdb_load_from_file(char *filename)
+static ListDB listdb_load_text(char *filename, int arena)
 {
-     FILE *file;
-     if (!(file = fopen(filename,"r"))) {
+     int fd;
+     if ((fd = open(filename, O_RDONLY)) == -1) {
           fprintf(stderr,"Error: Could not open file %s\n", filename);
           exit(EXIT_FAILURE);
      }
 
-     // checking the number of lists in the file
-     size_t len = 0;
-     ssize_t read;
-     char *line = NULL;
+     struct stat st;
+     if (fstat(fd, &st) == -1) {
+          fprintf(stderr,"Error: Could not read file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
      ListDB listdb;
-     listdb.size = 0;
-     while ((read = getline(&line, &len, file)) != -1) {
-          if ('\n' != line[0])
-               listdb.size++;
+     listdb_init(&listdb);
+     size_t length = st.st_size;
+     if (length == 0) {
+          close(fd);
+          return listdb;
      }
-     rewind(file);
 
-     // reading lists
-     listdb.dim = 0;
-     listdb.lists = (List *) malloc(listdb.size * sizeof(List));
+     char *text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (text == MAP_FAILED) {
+          fprintf(stderr,"Error: Could not map file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     madvise(text, length, MADV_SEQUENTIAL);
 
-     uint i, j;
-     for (i = 0; i < listdb.size; i ++) {
-          fscanf(file,"%u", &listdb.lists[i].size);
-          listdb.lists[i].data = (Item *) malloc(listdb.lists[i].size * sizeof(Item));
-          for (j = 0; j < listdb.lists[i].size; j++) {
-               char sep;
-               fscanf(file,"%u%c%u", &listdb.lists[i].data[j].item, &sep, &listdb.lists[i].data[j].freq);
-               if (listdb.dim < listdb.lists[i].data[j].item + 1)
-                    listdb.dim = listdb.lists[i].data[j].item + 1;
+     // splits the text in chunks that end at a newline
+     uint number_of_chunks = (length + LISTDB_CHUNK_SIZE - 1) / LISTDB_CHUNK_SIZE;
+     char **bounds = (char **) malloc((number_of_chunks + 1) * sizeof(char *));
+     uint i;
+     bounds[0] = text;
+     for (i = 1; i < number_of_chunks; i++) {
+          char *p = text + (size_t) i * LISTDB_CHUNK_SIZE;
+          if (p < bounds[i - 1])
+               p = bounds[i - 1];
+          char *eol = memchr(p, '\n', text + length - p);
+          bounds[i] = eol != NULL ? eol + 1 : text + length;
+     }
+     bounds[number_of_chunks] = text + length;
+
+     ListDB *chunks = (ListDB *) malloc(number_of_chunks * sizeof(ListDB));
+     List *items = (List *) malloc(number_of_chunks * sizeof(List));
+     int *parsed = (int *) malloc(number_of_chunks * sizeof(int));
+#pragma omp parallel for schedule(dynamic)
+     for (i = 0; i < number_of_chunks; i++) {
+          listdb_init(&chunks[i]);
+          list_init(&items[i]);
+          parsed[i] = listdb_parse_chunk(bounds[i], bounds[i + 1], &chunks[i],
+                                         arena ? &items[i] : NULL);
+     }
+
+     // stitches the chunks in order
+     size_t *offsets = (size_t *) malloc((number_of_chunks + 1) * sizeof(size_t));
+     offsets[0] = 0;
+     for (i = 0; i < number_of_chunks; i++) {
+          if (!parsed[i]) {
+               fprintf(stderr,"Error: Malformed list in file %s\n", filename);
+               exit(EXIT_FAILURE);
           }
+          listdb.size += chunks[i].size;
+          if (listdb.dim < chunks[i].dim)
+               listdb.dim = chunks[i].dim;
+          offsets[i + 1] = offsets[i] + items[i].size;
      }
-     
-     if (fclose(file)) {
-          fprintf(stderr,"Error: Could not close file %s\n", filename);
-          exit(EXIT_FAILURE);
+
+     Item *data = NULL;
+     if (offsets[number_of_chunks] > 0) {
+          data = (Item *) malloc(offsets[number_of_chunks] * sizeof(Item));
+          listdb.mapping = data;
+          listdb.mapping_size = offsets[number_of_chunks] * sizeof(Item);
+          listdb.storage = LISTDB_ARENA;
+     }
+
+#pragma omp parallel for schedule(dynamic)
+     for (i = 0; i < number_of_chunks; i++) {
+          if (items[i].size > 0) // chunks of blank lines or empty lists have no items
+               memcpy(data + offsets[i], items[i].data, items[i].size * sizeof(Item));
+          list_destroy(&items[i]);
+     }
+
+     listdb.lists = (List *) malloc(listdb.size * sizeof(List));
+     List *next = listdb.lists;
+     for (i = 0; i < number_of_chunks; i++) {
+          uint j;
+          for (j = 0; j < chunks[i].size; j++, next++) {
+               if (!arena) { // lists already own their items
+                    *next = chunks[i].lists[j];
+                    continue;
+               }
+               next->size = chunks[i].lists[j].size;
+               next->data = next->size > 0 ? data : NULL; // empty lists own nothing
+               data += next->size;
+          }
+          free(chunks[i].lists);
      }
+
+     free(chunks);
+     free(items);
+     free(offsets);
+     free(parsed);
+     free(bounds);
+     munmap(text, length);
      
      return listdb;
 }
 
+/**
+ * @brief Loads a list database from a text file (see listdb_load_text).
+ *        Each list owns its items, so the database can be modified with
+ *        the list and database functions.
+ *
+ * @param filename File containing the inverted file index of lists
+ *
+ * @return List database
+ */
+ListDB listdb_load_from_file(char *filename)
+{
+     return listdb_load_text(filename, 0);
+}
+
+/**
+ * @brief Loads a list database from a text file into a single arena (see
+ *        listdb_create_arena), which is faster to load and destroy. Lists
+ *        are slices of the arena, so they must not be reallocated or
+ *        freed (see listdb_detach_list).
+ *
+ * @param filename File containing the inverted file index of lists
+ *
+ * @return List database
+ */
+ListDB listdb_load_from_file_arena(char *filename)
+{
+     return listdb_load_text(filename, 1);
+}
+
+/**
+ * @brief Writes a whole buffer into a file descriptor.
+ *
+ * @param fd File descriptor
+ * @param buffer Buffer to write
+ * @param length Number of bytes to write
+ * @param filename Name of the file (used in error messages)
+ */
+void listdb_write_buffer(int fd, char *buffer, size_t length, char *filename)
+{
+     while (length > 0) {
+          ssize_t written = write(fd, buffer, length);
+          if (written < 0) {
+               fprintf(stderr,"Error: Could not write to file %s\n", filename);
+               exit(EXIT_FAILURE);
+          }
+          buffer += written;
+          length -= written;
+     }
+}
+
+/**
+ * @brief Formats an unsigned integer in decimal.
+ *
+ * @param p Position where the digits are written
+ * @param value Integer to format
+ *
+ * @return Position after the last digit
+ */
+static char *listdb_format_uint(char *p, uint value)
+{
+     char digits[10];
+     uint n = 0;
+     do {
+          digits[n++] = '0' + value % 10;
+          value /= 10;
+     } while (value > 0);
+     
+     while (n > 0)
+          *p++ = digits[--n];
+
+     return p;
+}
+
+/**
+ * @brief Upper bound of the number of bytes used by a list in text format.
+ *
+ * @param list List
+ *
+ * @return Number of bytes
+ */
+static size_t listdb_text_bound(List *list)
+{
+     return 11 + (size_t) list->size * 22;
+}
+
+/**
+ * @brief Formats a range of lists in text format.
+ *
+ * @param listdb List database
+ * @param first First list of the range
+ * @param last List after the last one of the range
+ * @param buffer Buffer large enough to hold the text of the range
+ *
+ * @return Number of bytes written in the buffer
+ */
+static size_t listdb_format_chunk(ListDB *listdb, uint first, uint last, char *buffer)
+{
+     char *p = buffer;
+     uint i, j;
+     for (i = first; i < last; i++) {
+          p = listdb_format_uint(p, listdb->lists[i].size);
+          for (j = 0; j < listdb->lists[i].size; j++) {
+               *p++ = ' ';
+               p = listdb_format_uint(p, listdb->lists[i].data[j].item);
+               *p++ = ':';
+               p = listdb_format_uint(p, listdb->lists[i].data[j].freq);
+          }
+          *p++ = '\n';
+     }
+
+     return p - buffer;
+}
+
 /**
  * @brief Saves a list database in a file.
  *        Format: 
  *             size item_1:freq_1 item_2:freq_2 ... item_size:freq_size
+ *        Ranges of lists are formatted in parallel into large buffers
+ *        that are written in order.
  *
  * @param filename File where the inverted file index will be saved
  * @param listdb List database to save
  */
 void listdb_save_to_file(char *filename, ListDB *listdb)
+{
+     int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if (fd == -1) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // splits the lists in chunks whose text fits in about LISTDB_CHUNK_SIZE bytes
+     uint number_of_chunks = 0, capacity = 0;
+     uint *bounds = NULL;
+     size_t *chunk_sizes = NULL;
+     size_t bound = 0;
+     uint i;
+     for (i = 0; i <= listdb->size; i++) {
+          if (i == 0 || i == listdb->size || bound >= LISTDB_CHUNK_SIZE) {
+               if (number_of_chunks + 1 >= capacity) {
+                    capacity = capacity ? 2 * capacity : 64;
+                    bounds = (uint *) realloc(bounds, capacity * sizeof(uint));
+                    chunk_sizes = (size_t *) realloc(chunk_sizes, capacity * sizeof(size_t));
+               }
+               if (i > 0)
+                    chunk_sizes[number_of_chunks++] = bound;
+               bounds[number_of_chunks] = i;
+               bound = 0;
+          }
+          if (i < listdb->size)
+               bound += listdb_text_bound(&listdb->lists[i]);
+     }
+
+     // formats groups of chunks in parallel and writes them in order
+     char **buffers = (char **) malloc(LISTDB_WRITE_GROUP * sizeof(char *));
+     size_t *lengths = (size_t *) malloc(LISTDB_WRITE_GROUP * sizeof(size_t));
+     uint first;
+     for (first = 0; first < number_of_chunks; first += LISTDB_WRITE_GROUP) {
+          uint group = number_of_chunks - first;
+          if (group > LISTDB_WRITE_GROUP)
+               group = LISTDB_WRITE_GROUP;
+
+#pragma omp parallel for schedule(dynamic)
+          for (i = 0; i < group; i++) {
+               buffers[i] = (char *) malloc(chunk_sizes[first + i]);
+               lengths[i] = listdb_format_chunk(listdb,
+                                                bounds[first + i],
+                                                bounds[first + i + 1],
+                                                buffers[i]);
+          }
+
+          for (i = 0; i < group; i++) {
+               listdb_write_buffer(fd, buffers[i], lengths[i], filename);
+               free(buffers[i]);
+          }
+     }
+
+     free(buffers);
+     free(lengths);
+     free(bounds);
+     free(chunk_sizes);
+     if (close(fd)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Saves a list database in a binary file that can be mapped in
+ *        memory. The file has a header, the offsets of the lists and
+ *        the items of all the lists stored contiguously.
+ *
+ * @param filename File where the database will be saved
+ * @param listdb List database to save
+ */
+void listdb_save_binary(char *filename, ListDB *listdb)
 {
      FILE *file;     
-     if (!(file = fopen(filename,"w"))) {
+     if (!(file = fopen(filename,"wb"))) {
           fprintf(stderr,"Error: Could not create file %s\n", filename);
           exit(EXIT_FAILURE);
      }
 
-     uint i, j;
-     for (i = 0; i < listdb->size; i++) {
-          fprintf(file,"%u", listdb->lists[i].size);
-          for (j = 0; j < listdb->lists[i].size; j++)
-               fprintf(file," %u:%u", listdb->lists[i].data[j].item, listdb->lists[i].data[j].freq);
-          fprintf(file,"\n");
+     uint i;
+     ListDBHeader header;
+     memset(&header, 0, sizeof(ListDBHeader));
+     memcpy(header.magic, LISTDB_MAGIC, sizeof(header.magic));
+     header.version = LISTDB_VERSION;
+     header.flags = LISTDB_FREQ;
+     header.size = listdb->size;
+     header.dim = listdb->dim;
+     for (i = 0; i < listdb->size; i++)
+          header.number_of_items += listdb->lists[i].size;
+
+     ullong *offsets = (ullong *) malloc((listdb->size + 1) * sizeof(ullong));
+     offsets[0] = 0;
+     for (i = 0; i < listdb->size; i++)
+          offsets[i + 1] = offsets[i] + listdb->lists[i].size;
+
+     int failed = fwrite(&header, sizeof(ListDBHeader), 1, file) != 1 ||
+          fwrite(offsets, sizeof(ullong), listdb->size + 1, file) != listdb->size + 1;
+     for (i = 0; !failed && i < listdb->size; i++)
+          if (listdb->lists[i].size > 0) // empty lists may have no data
+               failed = fwrite(listdb->lists[i].data, sizeof(Item), listdb->lists[i].size,
+                               file) != listdb->lists[i].size;
+     free(offsets);
+
+     if (failed) {
+          fprintf(stderr,"Error: Could not write file %s\n", filename);
+          exit(EXIT_FAILURE);
      }
 
      if (fclose(file)) {
@@ -639,3 +1366,840 @@ void listdb_save_to_file(char *filename, ListDB *listdb)
           exit(EXIT_FAILURE);
      }
 }
+
+/**
+ * @brief Maps a binary list database in memory and checks its header
+ *        and offsets.
+ *
+ * @param filename Binary file containing the list database
+ * @param length Size of the mapping
+ *
+ * @return Header at the start of the mapping
+ */
+static ListDBHeader *listdb_map_binary(char *filename, size_t *length)
+{
+     int fd;
+     if ((fd = open(filename, O_RDONLY)) == -1) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     struct stat st;
+     if (fstat(fd, &st) == -1 || st.st_size < sizeof(ListDBHeader)) {
+          fprintf(stderr,"Error: %s is not a binary list database\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     *length = st.st_size;
+     void *mapping = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (mapping == MAP_FAILED) {
+          fprintf(stderr,"Error: Could not map file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // checking header
+     ListDBHeader *header = (ListDBHeader *) mapping;
+     if (memcmp(header->magic, LISTDB_MAGIC, sizeof(header->magic)) != 0) {
+          fprintf(stderr,"Error: %s is not a binary list database\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     if (header->version != LISTDB_VERSION) {
+          fprintf(stderr,"Error: Unsupported version %u of binary list database %s\n",
+                  header->version, filename);
+          exit(EXIT_FAILURE);
+     }
+
+     size_t record_size = (header->flags & LISTDB_FREQ) ? sizeof(Item) : sizeof(uint);
+     ullong *offsets = (ullong *) (header + 1);
+     char *items = (char *) (offsets + header->size + 1);
+     size_t end = (items - (char *) mapping) + header->number_of_items * record_size;
+     if ((header->flags & LISTDB_TRAILER ? *length < end : *length != end) ||
+         offsets[header->size] != header->number_of_items) {
+          fprintf(stderr,"Error: Binary list database %s is truncated or corrupted\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     ullong i;
+     for (i = 0; i < header->size; i++) {
+          if (offsets[i] > offsets[i + 1]) {
+               fprintf(stderr,"Error: Binary list database %s is corrupted\n", filename);
+               exit(EXIT_FAILURE);
+          }
+     }
+
+     return header;
+}
+
+/**
+ * @brief Copies a list of a mapped binary list database. Lists stored
+ *        without frequencies get frequencies equal to 1.
+ *
+ * @param header Header at the start of the mapping
+ * @param position Position of the list in the database
+ *
+ * @return Copy of the list
+ */
+static List listdb_copy_binary_list(ListDBHeader *header, uint position)
+{
+     ullong *offsets = (ullong *) (header + 1);
+     char *items = (char *) (offsets + header->size + 1);
+     List list = list_create(offsets[position + 1] - offsets[position]);
+
+     if (header->flags & LISTDB_FREQ) {
+          memcpy(list.data, (Item *) items + offsets[position], list.size * sizeof(Item));
+     } else {
+          uint j;
+          uint *ids = (uint *) items + offsets[position];
+          for (j = 0; j < list.size; j++) {
+               list.data[j].item = ids[j];
+               list.data[j].freq = 1;
+          }
+     }
+
+     return list;
+}
+
+/**
+ * @brief Maps a binary list database in memory. Lists with frequencies
+ *        are read-only views of the mapping, so nothing is parsed or
+ *        copied and the items of a list are only paged in when it is
+ *        first read (see listdb_advise). Lists stored without
+ *        frequencies are expanded with frequencies equal to 1.
+ *
+ * @param filename Binary file containing the list database
+ * @param arena Whether expanded lists are slices of a single arena
+ *
+ * @return List database
+ */
+static ListDB listdb_map_lists(char *filename, int arena)
+{
+     size_t length;
+     ListDBHeader *header = listdb_map_binary(filename, &length);
+     ullong *offsets = (ullong *) (header + 1);
+     Item *items = (Item *) (offsets + header->size + 1);
+
+     ListDB listdb;
+     listdb_init(&listdb);
+     listdb.size = header->size;
+     listdb.dim = header->dim;
+     listdb.lists = (List *) malloc(listdb.size * sizeof(List));
+
+     uint i;
+     if (header->flags & LISTDB_FREQ) { // zero-copy views
+          for (i = 0; i < listdb.size; i++) {
+               listdb.lists[i].size = offsets[i + 1] - offsets[i];
+               listdb.lists[i].data = listdb.lists[i].size > 0 ? items + offsets[i] : NULL;
+          }
+          listdb.mapping = header;
+          listdb.mapping_size = length;
+          listdb.storage = LISTDB_MAPPED;
+     } else {
+          uint *sizes = (uint *) malloc(listdb.size * sizeof(uint));
+          for (i = 0; i < listdb.size; i++)
+               sizes[i] = offsets[i + 1] - offsets[i];
+          free(listdb.lists);
+          listdb = arena ? listdb_create_arena(header->size, header->dim, sizes)
+                         : listdb_create_sized(header->size, header->dim, sizes);
+          free(sizes);
+
+          uint j;
+          uint *ids = (uint *) items;
+          for (i = 0; i < listdb.size; i++) {
+               for (j = 0; j < listdb.lists[i].size; j++) {
+                    listdb.lists[i].data[j].item = ids[offsets[i] + j];
+                    listdb.lists[i].data[j].freq = 1;
+               }
+          }
+          munmap(header, length);
+     }
+
+     return listdb;
+}
+
+/**
+ * @brief Maps a binary list database in memory (see listdb_map_lists)
+ *
+ * @param filename Binary file containing the list database
+ *
+ * @return List database
+ */
+ListDB listdb_open_mmap(char *filename)
+{
+     return listdb_map_lists(filename, 0);
+}
+
+/**
+ * @brief Copies the lists of a mapped database out of the mapping and
+ *        releases it. Lists that were already detached are kept. Other
+ *        databases are left untouched.
+ *
+ * @param listdb List database
+ * @param arena Whether the copies are slices of a single arena
+ */
+static void listdb_copy_mapping(ListDB *listdb, int arena)
+{
+     if (listdb->storage != LISTDB_MAPPED || listdb->mapping == NULL)
+          return;
+
+     int i;
+     uint *sizes = (uint *) malloc(listdb->size * sizeof(uint));
+     for (i = 0; i < listdb->size; i++)
+          sizes[i] = listdb_in_storage(listdb, &listdb->lists[i]) ? listdb->lists[i].size : 0;
+     ListDB copy = arena ? listdb_create_arena(listdb->size, listdb->dim, sizes)
+                         : listdb_create_sized(listdb->size, listdb->dim, sizes);
+     free(sizes);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+     for (i = 0; i < listdb->size; i++) {
+          List *list = &listdb->lists[i];
+          if (listdb_in_storage(listdb, list))
+               memcpy(copy.lists[i].data, list->data, list->size * sizeof(Item));
+          else
+               copy.lists[i] = *list;
+     }
+     if (arena)
+          copy.detached = listdb->detached;
+
+     munmap(listdb->mapping, listdb->mapping_size);
+     listdb->mapping = NULL;
+     listdb_clear(listdb);
+     *listdb = copy;
+}
+
+/**
+ * @brief Copies the lists of a mapped database into lists that own their
+ *        items, so they can be written in place or resized, and releases
+ *        the mapping (see listdb_copy_mapping).
+ *
+ * @param listdb List database
+ */
+void listdb_unmap(ListDB *listdb)
+{
+     listdb_copy_mapping(listdb, 0);
+}
+
+/**
+ * @brief Tells the kernel how the lists of a mapped database are going
+ *        to be read, so it reads ahead for sequential passes and only
+ *        faults in the touched pages for random accesses. It has no
+ *        effect on databases that are not mapped.
+ *
+ * @param listdb List database
+ * @param pattern LISTDB_ACCESS_NORMAL, LISTDB_ACCESS_SEQUENTIAL or
+ *        LISTDB_ACCESS_RANDOM
+ */
+void listdb_advise(ListDB *listdb, int pattern)
+{
+     if (listdb->storage != LISTDB_MAPPED || listdb->mapping == NULL)
+          return;
+
+     int advice = MADV_NORMAL;
+     if (pattern == LISTDB_ACCESS_SEQUENTIAL)
+          advice = MADV_SEQUENTIAL;
+     else if (pattern == LISTDB_ACCESS_RANDOM)
+          advice = MADV_RANDOM;
+     madvise(listdb->mapping, listdb->mapping_size, advice);
+}
+
+/**
+ * @brief Starts counting the lists, bytes and pages read from a
+ *        database. Counters are reset if they already exist.
+ *
+ * @param listdb List database
+ */
+void listdb_track_access(ListDB *listdb)
+{
+     if (listdb->access == NULL) {
+          listdb->access = (ListDBAccess *) calloc(1, sizeof(ListDBAccess));
+          listdb->access->page_size = sysconf(_SC_PAGESIZE);
+          if (listdb->mapping != NULL) {
+               size_t pages = (listdb->mapping_size + listdb->access->page_size - 1) /
+                    listdb->access->page_size;
+               listdb->access->touched = (uchar *) calloc((pages + 7) / 8, sizeof(uchar));
+          }
+     } else {
+          size_t pages = (listdb->mapping_size + listdb->access->page_size - 1) /
+               listdb->access->page_size;
+          listdb->access->lists = 0;
+          listdb->access->bytes = 0;
+          listdb->access->pages = 0;
+          if (listdb->access->touched != NULL)
+               memset(listdb->access->touched, 0, (pages + 7) / 8);
+     }
+}
+
+/**
+ * @brief Counts a read of a list. The pages of the storage spanned by
+ *        the list are counted the first time they are read. It can be
+ *        called from several threads at once.
+ *
+ * @param listdb List database with access counters
+ * @param position Position of the list that is read
+ */
+void listdb_record_access(ListDB *listdb, uint position)
+{
+     ListDBAccess *access = listdb->access;
+     List *list = &listdb->lists[position];
+     ullong bytes = (ullong) list->size * sizeof(Item);
+
+#pragma omp atomic
+     access->lists++;
+#pragma omp atomic
+     access->bytes += bytes;
+
+     if (access->touched == NULL || list->size == 0 || !listdb_in_storage(listdb, list))
+          return;
+
+     size_t offset = (char *) list->data - (char *) listdb->mapping;
+     size_t page = offset / access->page_size;
+     size_t last = (offset + bytes - 1) / access->page_size;
+     ullong pages = 0;
+     for (; page <= last; page++) {
+          uchar bit = 1 << (page % 8);
+          if (!(__sync_fetch_and_or(&access->touched[page / 8], bit) & bit))
+               pages++;
+     }
+     if (pages > 0) {
+#pragma omp atomic
+          access->pages += pages;
+     }
+}
+
+/**
+ * @brief Checks if a file contains a binary list database
+ *
+ * @param filename File to check
+ *
+ * @return 1 if the file starts with the magic string of the binary
+ *         format, 0 otherwise
+ */
+int listdb_is_binary(char *filename)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"rb"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     char magic[8];
+     int binary = fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic) &&
+          memcmp(magic, LISTDB_MAGIC, sizeof(magic)) == 0;
+     fclose(file);
+
+     return binary;
+}
+
+/**
+ * @brief Checks if a file is a manifest of shards
+ *
+ * @param filename File to check
+ *
+ * @return 1 if the file starts with the manifest magic line, 0 otherwise
+ */
+int listdb_is_manifest(char *filename)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"rb"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     char magic[sizeof(LISTDB_MANIFEST_MAGIC) - 1];
+     int manifest = fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic) &&
+          memcmp(magic, LISTDB_MANIFEST_MAGIC, sizeof(magic)) == 0;
+     fclose(file);
+
+     return manifest;
+}
+
+/**
+ * @brief Loads a manifest of shards
+ *        Format: 
+ *             #smh-manifest
+ *             path_1 offset_1
+ *                  ...
+ *        where offset is the id of the first list of the shard. Relative
+ *        paths are taken from the directory of the manifest, lines
+ *        starting with # are comments and offsets must not decrease.
+ *
+ * @param filename File containing the manifest
+ *
+ * @return Manifest
+ */
+ListDBManifest listdb_manifest_load(char *filename)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"r"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     ListDBManifest manifest = {0, NULL, NULL};
+     char *directory_end = strrchr(filename, '/');
+     size_t directory_length = directory_end != NULL ? directory_end - filename + 1 : 0;
+
+     char *line = NULL;
+     size_t line_size = 0;
+     ssize_t read;
+     uint capacity = 0;
+     while ((read = getline(&line, &line_size, file)) != -1) {
+          while (read > 0 && (line[read - 1] == '\n' || line[read - 1] == '\r' ||
+                              line[read - 1] == ' ' || line[read - 1] == '\t'))
+               line[--read] = '\0';
+          if (read == 0 || line[0] == '#')
+               continue;
+
+          // the offset is the last field, so paths may contain blanks
+          char *separator = strrchr(line, ' ');
+          char *tab = strrchr(line, '\t');
+          if (separator == NULL || (tab != NULL && tab > separator))
+               separator = tab;
+          uint offset;
+          if (separator == NULL || separator == line ||
+              listdb_parse_uint(separator + 1, line + read, &offset) != line + read) {
+               fprintf(stderr,"Error: Malformed shard in manifest %s\n", filename);
+               exit(EXIT_FAILURE);
+          }
+          while (separator > line && (separator[-1] == ' ' || separator[-1] == '\t'))
+               separator--;
+          *separator = '\0';
+
+          if (manifest.size > 0 && offset < manifest.offsets[manifest.size - 1]) {
+               fprintf(stderr,"Error: Decreasing shard offsets in manifest %s\n", filename);
+               exit(EXIT_FAILURE);
+          }
+
+          if (manifest.size == capacity) {
+               capacity = capacity ? 2 * capacity : 64;
+               manifest.paths = (char **) realloc(manifest.paths, capacity * sizeof(char *));
+               manifest.offsets = (uint *) realloc(manifest.offsets, capacity * sizeof(uint));
+          }
+          size_t prefix = line[0] == '/' ? 0 : directory_length;
+          char *path = (char *) malloc(prefix + strlen(line) + 1);
+          memcpy(path, filename, prefix);
+          strcpy(path + prefix, line);
+          manifest.paths[manifest.size] = path;
+          manifest.offsets[manifest.size] = offset;
+          manifest.size++;
+     }
+
+     free(line);
+     fclose(file);
+
+     return manifest;
+}
+
+/**
+ * @brief Destroys a manifest of shards
+ *
+ * @param manifest Manifest to be destroyed
+ */
+void listdb_manifest_destroy(ListDBManifest *manifest)
+{
+     uint i;
+     for (i = 0; i < manifest->size; i++)
+          free(manifest->paths[i]);
+     free(manifest->paths);
+     free(manifest->offsets);
+     manifest->size = 0;
+     manifest->paths = NULL;
+     manifest->offsets = NULL;
+}
+
+/**
+ * @brief Loads the shards of a manifest into a single list database.
+ *        Shards are loaded one at a time, so only one shard is in memory
+ *        next to the database: their lists are either moved to the
+ *        database or their items are appended to an arena. Ids not
+ *        covered by any shard are empty lists.
+ *
+ * @param manifest Manifest of shards
+ * @param in_arena Whether the lists are slices of a single arena
+ *
+ * @return List database
+ */
+static ListDB listdb_load_shards(ListDBManifest *manifest, int in_arena)
+{
+     uint i, j, size = 0, dim = 0;
+     size_t number_of_items = 0;
+     List *lists = NULL;
+     Item *arena = NULL;
+     size_t *starts = NULL; // lists are located by position until the arena stops growing
+     uint *sizes = NULL;
+     for (i = 0; i < manifest->size; i++) {
+          uint first = manifest->offsets[i];
+          if (first < size) {
+               fprintf(stderr,"Error: Shard %s overlaps with the previous shard\n",
+                       manifest->paths[i]);
+               exit(EXIT_FAILURE);
+          }
+
+          ListDB shard = in_arena ? listdb_load_arena(manifest->paths[i]) // only copied
+                                  : listdb_load(manifest->paths[i]);
+          if (!in_arena) { // moves the lists, which own their items
+               lists = realloc(lists, (first + shard.size) * sizeof(List));
+               if (first > size) // ids between shards
+                    memset(lists + size, 0, (first - size) * sizeof(List));
+               if (shard.size > 0)
+                    memcpy(lists + first, shard.lists, shard.size * sizeof(List));
+               size = first + shard.size;
+               if (dim < shard.dim)
+                    dim = shard.dim;
+               listdb_clear(&shard);
+               continue;
+          }
+
+          size_t shard_items = 0;
+          for (j = 0; j < shard.size; j++)
+               shard_items += shard.lists[j].size;
+          if (shard_items > 0)
+               arena = realloc(arena, (number_of_items + shard_items) * sizeof(Item));
+
+          starts = realloc(starts, (first + shard.size) * sizeof(size_t));
+          sizes = realloc(sizes, (first + shard.size) * sizeof(uint));
+          for (j = size; j < first; j++) { // ids between shards
+               starts[j] = number_of_items;
+               sizes[j] = 0;
+          }
+          for (j = 0; j < shard.size; j++) {
+               starts[first + j] = number_of_items;
+               sizes[first + j] = shard.lists[j].size;
+               if (shard.lists[j].size > 0)
+                    memcpy(arena + number_of_items, shard.lists[j].data,
+                           shard.lists[j].size * sizeof(Item));
+               number_of_items += shard.lists[j].size;
+          }
+          size = first + shard.size;
+          if (dim < shard.dim)
+               dim = shard.dim;
+          listdb_destroy(&shard);
+     }
+
+     ListDB listdb;
+     listdb_init(&listdb);
+     listdb.size = size;
+     listdb.dim = dim;
+     if (!in_arena) {
+          listdb.lists = lists;
+          return listdb;
+     }
+
+     listdb.lists = (List *) malloc(size * sizeof(List));
+     for (i = 0; i < size; i++) {
+          listdb.lists[i].size = sizes[i];
+          listdb.lists[i].data = sizes[i] > 0 ? arena + starts[i] : NULL;
+     }
+     if (arena != NULL) {
+          listdb.mapping = arena;
+          listdb.mapping_size = number_of_items * sizeof(Item);
+          listdb.storage = LISTDB_ARENA;
+     }
+     free(starts);
+     free(sizes);
+
+     return listdb;
+}
+
+/**
+ * @brief Loads the shards of a manifest into a single list database
+ *        whose lists own their items (see listdb_load_shards)
+ *
+ * @param manifest Manifest of shards
+ *
+ * @return List database
+ */
+ListDB listdb_load_manifest(ListDBManifest *manifest)
+{
+     return listdb_load_shards(manifest, 0);
+}
+
+/**
+ * @brief Loads a list database from a text or binary file, or from
+ *        the shards of a manifest. Binary files are mapped and copied
+ *        out of the mapping (see listdb_copy_mapping).
+ *
+ * @param filename File containing the list database
+ * @param arena Whether the lists are slices of a single arena
+ *
+ * @return List database
+ */
+static ListDB listdb_load_storage(char *filename, int arena)
+{
+     if (listdb_is_manifest(filename)) {
+          ListDBManifest manifest = listdb_manifest_load(filename);
+          ListDB listdb = listdb_load_shards(&manifest, arena);
+          listdb_manifest_destroy(&manifest);
+          return listdb;
+     }
+
+     if (listdb_is_binary(filename)) {
+          ListDB listdb = listdb_map_lists(filename, arena);
+          listdb_copy_mapping(&listdb, arena);
+          return listdb;
+     }
+
+     return listdb_load_text(filename, arena);
+}
+
+/**
+ * @brief Loads a list database from a text or binary file, or from
+ *        the shards of a manifest (see listdb_load_storage). Each list
+ *        owns its items, so the database can be modified with the list
+ *        and database functions. listdb_open_mmap gives read-only views
+ *        of a binary file instead.
+ *
+ * @param filename File containing the list database
+ *
+ * @return List database
+ */
+ListDB listdb_load(char *filename)
+{
+     return listdb_load_storage(filename, 0);
+}
+
+/**
+ * @brief Loads a list database into a single arena (see
+ *        listdb_load_storage), which is faster to load and destroy.
+ *        Lists are slices of the arena, so they must not be reallocated
+ *        or freed (see listdb_detach_list).
+ *
+ * @param filename File containing the list database
+ *
+ * @return List database
+ */
+ListDB listdb_load_arena(char *filename)
+{
+     return listdb_load_storage(filename, 1);
+}
+
+/**
+ * @brief Opens a file of a reader (the database or one of its shards)
+ *
+ * @param reader Reader
+ * @param filename File containing the list database
+ */
+static void listdb_reader_open_source(ListDBReader *reader, char *filename)
+{
+     reader->source = filename;
+     reader->source_position = 0;
+     if (listdb_is_binary(filename)) {
+          reader->header = listdb_map_binary(filename, &reader->mapping_size);
+          madvise(reader->header, reader->mapping_size, MADV_SEQUENTIAL);
+     } else if (!(reader->file = fopen(filename,"r"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Closes the file of a reader
+ *
+ * @param reader Reader
+ */
+static void listdb_reader_close_source(ListDBReader *reader)
+{
+     if (reader->file != NULL)
+          fclose(reader->file);
+     if (reader->header != NULL)
+          munmap(reader->header, reader->mapping_size);
+     reader->file = NULL;
+     reader->header = NULL;
+     reader->mapping_size = 0;
+}
+
+/**
+ * @brief Reads the next list of the file of a reader
+ *
+ * @param reader Reader
+ * @param list Read list
+ * @param dim Largest item value plus one, updated with the read items
+ *
+ * @return 1 if a list was read, 0 at the end of the file
+ */
+static int listdb_reader_next_list(ListDBReader *reader, List *list, uint *dim)
+{
+     if (reader->header != NULL) {
+          if (reader->source_position == reader->header->size)
+               return 0;
+          *list = listdb_copy_binary_list(reader->header, reader->source_position);
+          uint j;
+          for (j = 0; j < list->size; j++)
+               if (*dim < list->data[j].item + 1)
+                    *dim = list->data[j].item + 1;
+     } else {
+          int parsed;
+          do {
+               ssize_t read = getline(&reader->line, &reader->line_size, reader->file);
+               if (read == -1)
+                    return 0;
+               parsed = listdb_parse_line(reader->line, reader->line + read, list, dim,
+                                          NULL, NULL);
+               if (parsed < 0) {
+                    fprintf(stderr,"Error: Malformed list in file %s\n", reader->source);
+                    exit(EXIT_FAILURE);
+               }
+          } while (parsed == 0);
+     }
+     reader->source_position++;
+
+     return 1;
+}
+
+/**
+ * @brief Opens a text or binary list database, or a manifest of shards,
+ *        for reading it in batches. Shards are read one at a time.
+ *
+ * @param reader Reader
+ * @param filename File containing the list database or the manifest
+ * @param max_items Maximum number of items in a batch (a batch always
+ *                  holds at least one list)
+ */
+void listdb_reader_open(ListDBReader *reader, char *filename, uint max_items)
+{
+     reader->filename = filename;
+     reader->max_items = max_items;
+     reader->position = 0;
+     reader->batch_start = 0;
+     reader->size = 0;
+     reader->dim = 0;
+     reader->number_of_items = 0;
+     reader->item_position = 0;
+     reader->counted = 0;
+     reader->file = NULL;
+     reader->line = NULL;
+     reader->line_size = 0;
+     reader->header = NULL;
+     reader->mapping_size = 0;
+     reader->source = NULL;
+     reader->source_position = 0;
+     reader->manifest = (ListDBManifest) {0, NULL, NULL};
+     reader->shard = 0;
+
+     if (listdb_is_manifest(filename)) {
+          reader->manifest = listdb_manifest_load(filename);
+          if (reader->manifest.size > 0)
+               listdb_reader_open_source(reader, reader->manifest.paths[0]);
+     } else {
+          listdb_reader_open_source(reader, filename);
+          if (reader->header != NULL) {
+               reader->size = reader->header->size;
+               reader->dim = reader->header->dim;
+               reader->number_of_items = reader->header->number_of_items;
+               reader->counted = 1;
+          }
+     }
+}
+
+/**
+ * @brief Reads the next batch of lists. Previous content of the batch
+ *        is destroyed.
+ *
+ * @param reader Reader
+ * @param batch Batch where the lists are stored (initialized with
+ *              listdb_init before the first call)
+ *
+ * @return Number of lists in the batch (0 at the end of the database)
+ */
+uint listdb_reader_next_batch(ListDBReader *reader, ListDB *batch)
+{
+     listdb_destroy(batch);
+     reader->batch_start = reader->position;
+
+     ListDBManifest *manifest = &reader->manifest;
+     uint capacity = 0;
+     ullong items = 0;
+     while (items < reader->max_items || batch->size == 0) {
+          List list;
+          if (manifest->size > 0 && reader->position < manifest->offsets[reader->shard]) {
+               list_init(&list); // ids between shards
+          } else if (!listdb_reader_next_list(reader, &list, &batch->dim)) {
+               if (reader->shard + 1 >= manifest->size)
+                    break;
+
+               // moves to the next shard
+               if (reader->position > manifest->offsets[reader->shard + 1]) {
+                    fprintf(stderr,"Error: Shard %s overlaps with the next shard\n",
+                            reader->source);
+                    exit(EXIT_FAILURE);
+               }
+               listdb_reader_close_source(reader);
+               reader->shard++;
+               listdb_reader_open_source(reader, manifest->paths[reader->shard]);
+               continue;
+          }
+
+          if (batch->size == capacity) {
+               capacity = capacity ? 2 * capacity : 1024;
+               batch->lists = realloc(batch->lists, capacity * sizeof(List));
+          }
+          batch->lists[batch->size++] = list;
+          items += list.size;
+          reader->position++;
+     }
+     reader->item_position += items;
+
+     if (!reader->counted) {
+          if (reader->dim < batch->dim)
+               reader->dim = batch->dim;
+          if (batch->size == 0) { // a whole pass has been done
+               reader->size = reader->position;
+               reader->number_of_items = reader->item_position;
+               reader->counted = 1;
+          }
+     }
+
+     return batch->size;
+}
+
+/**
+ * @brief Moves a reader back to the first list
+ *
+ * @param reader Reader
+ */
+void listdb_reader_rewind(ListDBReader *reader)
+{
+     if (reader->manifest.size > 0 && reader->shard > 0) {
+          listdb_reader_close_source(reader);
+          reader->shard = 0;
+          listdb_reader_open_source(reader, reader->manifest.paths[0]);
+     } else if (reader->file != NULL) {
+          rewind(reader->file);
+     }
+     reader->source_position = 0;
+     reader->position = 0;
+     reader->item_position = 0;
+     reader->batch_start = 0;
+}
+
+/**
+ * @brief Makes sure the number of lists and the dimensionality of the
+ *        database are known, reading the whole database if necessary,
+ *        and moves the reader back to the first list.
+ *
+ * @param reader Reader
+ */
+void listdb_reader_count(ListDBReader *reader)
+{
+     if (!reader->counted) {
+          ListDB batch;
+          listdb_init(&batch);
+          listdb_reader_rewind(reader);
+          while (listdb_reader_next_batch(reader, &batch) > 0);
+          listdb_destroy(&batch);
+     }
+     listdb_reader_rewind(reader);
+}
+
+/**
+ * @brief Closes a reader
+ *
+ * @param reader Reader
+ */
+void listdb_reader_close(ListDBReader *reader)
+{
+     listdb_reader_close_source(reader);
+     listdb_manifest_destroy(&reader->manifest);
+     free(reader->line);
+     reader->line = NULL;
+}
@@ -25,27 +25,368 @@
 #include "mhlink.h"
 
 /**
- * @brief Converts clusters (lists of ids) to lists of items.
+ * @brief Converts clusters (lists of ids) to lists of items. The items
+ *        of the members of a cluster are merged and the frequency of an
+ *        item is the sum of its frequencies in the members.
  *
- * @param listdb Database of lists
+ * @param db Clustered database
  * @param cluster Clusters given as lists of list ids
- * @param model Converted clusters (lists of items)
+ *
+ * @return Converted clusters (lists of items)
  */
-ListDB mhlink_make_model(ListDB *listdb, ListDB *clusters)
+ListDB mhlink_make_model_db(MHLinkDB *db, ListDB *clusters)
 {
-     ListDB models = listdb_create(clusters->size, listdb->dim);
+     ListDB models = listdb_create(clusters->size, db->dim);
      uint i, j;
      for (i = 0; i < clusters->size; i++){
-          for (j = 0; j < clusters->lists[i].size; j++)
-               list_append(&models.lists[i], &listdb->lists[clusters->lists[i].data[j].item]);
-          list_sort_by_item(&models.lists[i]);
-          list_unique(&models.lists[i]);
+          List **members = (List **) malloc(clusters->lists[i].size * sizeof(List *));
+          List *buffers = (List *) malloc(clusters->lists[i].size * sizeof(List));
+          for (j = 0; j < clusters->lists[i].size; j++) {
+               list_init(&buffers[j]);
+               members[j] = db->member(db, clusters->lists[i].data[j].item, &buffers[j]);
+          }
+          models.lists[i] = list_merge_multi(members, clusters->lists[i].size);
           list_sort_by_frequency_back(&models.lists[i]);
+          for (j = 0; j < clusters->lists[i].size; j++)
+               list_destroy(&buffers[j]);
+          free(buffers);
+          free(members);
      }
 
      return models;
 }
 
+/**
+ * @brief Gets a list of a database of lists
+ *
+ * @param db Database of lists
+ * @param id ID of the list
+ * @param buffer Unused
+ *
+ * @return List
+ */
+static List *mhlink_member_lists(MHLinkDB *db, uint id, List *buffer)
+{
+     return &((ListDB *) db->db)->lists[id];
+}
+
+/**
+ * @brief Hashes a database of lists
+ *
+ * @param db Database of lists
+ * @param hash_table Hash table
+ * @param indices Bucket of each list
+ */
+static void mhlink_store_lists(MHLinkDB *db, HashTable *hash_table, uint *indices)
+{
+     mh_store_listdb((ListDB *) db->db, hash_table, indices);
+}
+
+/**
+ * @brief Links a list with the similar lists of its bucket
+ *
+ * @param db Database of lists
+ * @param clusters Generated clusters
+ * @param listid ID of the list
+ * @param items IDs of the lists in the same bucket
+ * @param checked Keeps track of the already checked lists
+ * @param clus_table Keeps track of the cluster to which each list is
+ *                   assigned
+ */
+static void mhlink_neighbors_lists(MHLinkDB *db, ListDB *clusters, uint listid, List *items,
+                                   uint *checked, uint *clus_table)
+{
+     mhlink_add_neighbors((ListDB *) db->db, clusters, listid, items, checked, clus_table,
+                          db->sim.lists, db->thres);
+}
+
+/**
+ * @brief Describes a database of lists for clustering
+ *
+ * @param listdb Database of lists
+ * @param sim Similarity function for adding list to a cluster
+ * @param thres Threshold for adding list to a cluster
+ *
+ * @return Clustered database
+ */
+static MHLinkDB mhlink_db_lists(ListDB *listdb, double (*sim)(List *, List *), double thres)
+{
+     MHLinkDB db;
+     db.db = listdb;
+     db.size = listdb->size;
+     db.dim = listdb->dim;
+     db.name = "lists";
+     db.thres = thres;
+     db.sim.lists = sim;
+     db.store = mhlink_store_lists;
+     db.neighbors = mhlink_neighbors_lists;
+     db.member = mhlink_member_lists;
+
+     return db;
+}
+
+/**
+ * @brief Converts clusters (lists of ids) to lists of items.
+ *
+ * @param listdb Database of lists
+ * @param cluster Clusters given as lists of list ids
+ * @param model Converted clusters (lists of items)
+ */
+ListDB mhlink_make_model(ListDB *listdb, ListDB *clusters)
+{
+     MHLinkDB db = mhlink_db_lists(listdb, NULL, 0);
+
+     return mhlink_make_model_db(&db, clusters);
+}
+
+/**
+ * @brief Adds a neighbor list to the cluster of a given list, merging
+ *        both clusters if the neighbor already belongs to another one.
+ *
+ * @param clusters Generated clusters
+ * @param listid ID of the list
+ * @param neighbor ID of the neighbor list
+ * @param checked Keeps track of the already checked lists
+ * @param clus_table Keeps track of the cluster to which each list is
+ *                   assigned
+ */
+static void mhlink_link(ListDB *clusters, uint listid, uint neighbor, uint *checked,
+                        uint *clus_table)
+{
+     if (checked[neighbor] == 0) { // list doesn't belong to a cluster
+          // Add item to cluster
+          Item new_item = {neighbor, 1};
+          list_push(&clusters->lists[clus_table[listid]], new_item);
+
+          // mark list as checked
+          checked[neighbor] = 1;
+
+          // assigning current id to new item
+          clus_table[neighbor] = clus_table[listid];
+     } else if (clus_table[neighbor] != clus_table[listid]) { // otherwise
+          // get min and max between cluster ids
+          uint max_clusid = max(clus_table[neighbor], clus_table[listid]);
+          uint min_clusid = min(clus_table[neighbor], clus_table[listid]);
+
+          // Merge clusters
+          list_append(&clusters->lists[min_clusid], &clusters->lists[max_clusid]);
+
+          // reassigning ids to cluster with largest id
+          uint j;
+          for (j = 0; j < clusters->lists[max_clusid].size; j++)
+               clus_table[clusters->lists[max_clusid].data[j].item] = min_clusid;
+
+          // Destroy cluster with largest id
+          list_destroy(&clusters->lists[max_clusid]);                         
+     }
+}
+
+/**
+ * @brief Decodes a list of a database of compressed lists
+ *
+ * @param db Database of compressed lists
+ * @param id ID of the list
+ * @param buffer List where the items are decoded
+ *
+ * @return Decoded list
+ */
+static List *mhlink_member_compressed(MHLinkDB *db, uint id, List *buffer)
+{
+     clist_decode_into(&((CListDB *) db->db)->lists[id], buffer);
+
+     return buffer;
+}
+
+/**
+ * @brief Hashes a database of compressed lists
+ *
+ * @param db Database of compressed lists
+ * @param hash_table Hash table
+ * @param indices Bucket of each list
+ */
+static void mhlink_store_compressed(MHLinkDB *db, HashTable *hash_table, uint *indices)
+{
+     mh_store_clistdb((CListDB *) db->db, hash_table, indices);
+}
+
+/**
+ * @brief Links a compressed list with the similar lists of its bucket
+ *
+ * @param db Database of compressed lists
+ * @param clusters Generated clusters
+ * @param listid ID of the list
+ * @param items IDs of the lists in the same bucket
+ * @param checked Keeps track of the already checked lists
+ * @param clus_table Keeps track of the cluster to which each list is
+ *                   assigned
+ */
+static void mhlink_neighbors_compressed(MHLinkDB *db, ListDB *clusters, uint listid, List *items,
+                                        uint *checked, uint *clus_table)
+{
+     mhlink_add_neighbors_compressed((CListDB *) db->db, clusters, listid, items, checked,
+                                     clus_table, db->sim.clists, db->thres);
+}
+
+/**
+ * @brief Describes a database of compressed lists for clustering
+ *
+ * @param listdb Database of compressed lists
+ * @param sim Similarity function between compressed lists
+ * @param thres Threshold for adding list to a cluster
+ *
+ * @return Clustered database
+ */
+static MHLinkDB mhlink_db_compressed(CListDB *listdb, double (*sim)(CList *, CList *),
+                                     double thres)
+{
+     MHLinkDB db;
+     db.db = listdb;
+     db.size = listdb->size;
+     db.dim = listdb->dim;
+     db.name = "lists";
+     db.thres = thres;
+     db.sim.clists = sim;
+     db.store = mhlink_store_compressed;
+     db.neighbors = mhlink_neighbors_compressed;
+     db.member = mhlink_member_compressed;
+
+     return db;
+}
+
+/**
+ * @brief Converts clusters (lists of ids) of compressed lists to lists of items.
+ *
+ * @param listdb Database of compressed lists
+ * @param cluster Clusters given as lists of list ids
+ *
+ * @return Converted clusters (lists of items)
+ */
+ListDB mhlink_make_model_compressed(CListDB *listdb, ListDB *clusters)
+{
+     MHLinkDB db = mhlink_db_compressed(listdb, NULL, 0);
+
+     return mhlink_make_model_db(&db, clusters);
+}
+
+/**
+ * @brief Converts a set of a database of sets to a list whose items have
+ *        frequency 1
+ *
+ * @param db Database of sets
+ * @param id ID of the set
+ * @param buffer List where the items are stored
+ *
+ * @return List of the items of the set
+ */
+static List *mhlink_member_sets(MHLinkDB *db, uint id, List *buffer)
+{
+     uint i;
+     Set *set = &((SetDB *) db->db)->sets[id];
+     if (buffer->size != set->size)
+          buffer->data = realloc(buffer->data, set->size * sizeof(Item));
+     buffer->size = set->size;
+     for (i = 0; i < set->size; i++) {
+          buffer->data[i].item = set->data[i];
+          buffer->data[i].freq = 1;
+     }
+
+     return buffer;
+}
+
+/**
+ * @brief Hashes a database of sets
+ *
+ * @param db Database of sets
+ * @param hash_table Hash table
+ * @param indices Bucket of each set
+ */
+static void mhlink_store_sets(MHLinkDB *db, HashTable *hash_table, uint *indices)
+{
+     mh_store_setdb((SetDB *) db->db, hash_table, indices);
+}
+
+/**
+ * @brief Links a set with the similar sets of its bucket
+ *
+ * @param db Database of sets
+ * @param clusters Generated clusters
+ * @param setid ID of the set
+ * @param items IDs of the sets in the same bucket
+ * @param checked Keeps track of the already checked sets
+ * @param clus_table Keeps track of the cluster to which each set is
+ *                   assigned
+ */
+static void mhlink_neighbors_sets(MHLinkDB *db, ListDB *clusters, uint setid, List *items,
+                                  uint *checked, uint *clus_table)
+{
+     mhlink_add_neighbors_sets((SetDB *) db->db, clusters, setid, items, checked, clus_table,
+                               db->sim.sets, db->thres);
+}
+
+/**
+ * @brief Describes a database of sets for clustering
+ *
+ * @param setdb Database of sets
+ * @param sim Similarity function between sets
+ * @param thres Threshold for adding a set to a cluster
+ *
+ * @return Clustered database
+ */
+static MHLinkDB mhlink_db_sets(SetDB *setdb, double (*sim)(Set *, Set *), double thres)
+{
+     MHLinkDB db;
+     db.db = setdb;
+     db.size = setdb->size;
+     db.dim = setdb->dim;
+     db.name = "sets";
+     db.thres = thres;
+     db.sim.sets = sim;
+     db.store = mhlink_store_sets;
+     db.neighbors = mhlink_neighbors_sets;
+     db.member = mhlink_member_sets;
+
+     return db;
+}
+
+/**
+ * @brief Converts clusters (lists of ids) of sets to lists of items.
+ *        The frequency of an item is the number of sets of the cluster
+ *        that contain it.
+ *
+ * @param setdb Database of sets
+ * @param cluster Clusters given as lists of set ids
+ *
+ * @return Converted clusters (lists of items)
+ */
+ListDB mhlink_make_model_sets(SetDB *setdb, ListDB *clusters)
+{
+     MHLinkDB db = mhlink_db_sets(setdb, NULL, 0);
+
+     return mhlink_make_model_db(&db, clusters);
+}
+
+/**
+ * @brief Links a list with the lists of its bucket that passed a batch
+ *        similarity test.
+ *
+ * @param clusters Generated clusters
+ * @param listid ID of the list
+ * @param items IDs of the lists in the same bucket
+ * @param passed Bit of each list of the bucket set if it passed the test
+ * @param checked Keeps track of the already checked lists
+ * @param clus_table Keeps track of the cluster to which each list is
+ *                   assigned
+ */
+static void mhlink_link_passed(ListDB *clusters, uint listid, List *items, ullong *passed,
+                               uint *checked, uint *clus_table)
+{
+     uint i;
+     for (i = 0; i < items->size; i++) {
+          if (items->data[i].item != listid && (passed[i / 64] >> (i % 64)) & 1ULL)
+               mhlink_link(clusters, listid, items->data[i].item, checked, clus_table);
+     }
+}
+
 /**
  * @brief Checks a hash bucket for similar lists to be merged in a
  *        cluster.
@@ -62,75 +403,131 @@ ListDB mhlink_make_model(ListDB *listdb, ListDB *clusters)
  */
 void mhlink_add_neighbors(ListDB *listdb, ListDB *clusters, uint listid, List *items, uint *checked,
                           uint *clus_table, double (*sim)(List *, List *), double thres)
+{
+     uint i;
+     int measure;
+     if (sim == list_overlap) {
+          measure = LIST_OVERLAP;
+     } else if (sim == list_jaccard) {
+          measure = LIST_JACCARD;
+     } else { // no bounds are known for other similarities
+          for (i = 0; i < items->size; i++) {
+               if (items->data[i].item != listid) {
+                    // add neighbor item if similarity is greater than a threshold
+                    if (sim(&listdb->lists[listid], &listdb->lists[items->data[i].item]) > thres)
+                         mhlink_link(clusters, listid, items->data[i].item, checked, clus_table);
+               }
+          }
+          return;
+     }
+
+     // compares the list against the whole bucket at once
+     ullong *passed = (ullong *) malloc(((items->size + 63) / 64) * sizeof(ullong));
+     listdb_similarity_batch(listdb, &listdb->lists[listid], items, measure, thres, passed);
+     mhlink_link_passed(clusters, listid, items, passed, checked, clus_table);
+     free(passed);
+}
+
+/**
+ * @brief Checks a hash bucket for similar compressed lists to be merged
+ *        in a cluster.
+ *
+ * @param listdb Database of compressed lists
+ * @param clusters Generated clusters
+ * @param Listid ID of the list to be added
+ * @param items IDs of the lists in the same bucket
+ * @param checked Keeps track of the already checked lists
+ * @param clus_table Keeps track of the cluster to which each list is
+ *                   assigned
+ * @param sim Similarity function between compressed lists
+ * @param thres Threshold to merge clusters
+ */
+void mhlink_add_neighbors_compressed(CListDB *listdb, ListDB *clusters, uint listid, List *items,
+                                     uint *checked, uint *clus_table,
+                                     double (*sim)(CList *, CList *), double thres)
 {
      uint i;
      for (i = 0; i < items->size; i++) {
           if (items->data[i].item != listid) {
                // add neighbor item if similarity is greater than a threshold
-               if (sim(&listdb->lists[listid], &listdb->lists[items->data[i].item]) > thres) {
-                    if (checked[items->data[i].item] == 0) { // list doesn't belong to a cluster
-                         // Add item to cluster
-                         Item new_item = {items->data[i].item, 1};
-                         list_push(&clusters->lists[clus_table[listid]], new_item);
-
-                         // mark list as checked
-                         checked[items->data[i].item] = 1;
-
-                         // assigning current id to new item
-                         clus_table[items->data[i].item] = clus_table[listid];
-                    } else if (clus_table[items->data[i].item] != clus_table[listid]) { // otherwise
-                         // get min and max between cluster ids
-                         uint max_clusid = max(clus_table[items->data[i].item], clus_table[listid]);
-                         uint min_clusid = min(clus_table[items->data[i].item], clus_table[listid]);
-
-                         // Merge clusters
-                         list_append(&clusters->lists[min_clusid], &clusters->lists[max_clusid]);
-
-                         // reassigning ids to cluster with largest id
-                         uint j;
-                         for (j = 0; j < clusters->lists[max_clusid].size; j++)
-                              clus_table[clusters->lists[max_clusid].data[j].item] = min_clusid;
-
-                         // Destroy cluster with largest id
-                         list_destroy(&clusters->lists[max_clusid]);                         
-                    }
+               if (sim(&listdb->lists[listid], &listdb->lists[items->data[i].item]) > thres)
+                    mhlink_link(clusters, listid, items->data[i].item, checked, clus_table);
+          }
+     }
+}
+
+/**
+ * @brief Checks a hash bucket for similar sets to be merged in a cluster.
+ *
+ * @param setdb Database of sets
+ * @param clusters Generated clusters
+ * @param setid ID of the set
+ * @param items IDs of the sets in the same bucket
+ * @param checked Keeps track of the already checked sets
+ * @param clus_table Keeps track of the cluster to which each set is
+ *                   assigned
+ * @param sim Similarity function between sets
+ * @param thres Threshold to merge clusters
+ */
+void mhlink_add_neighbors_sets(SetDB *setdb, ListDB *clusters, uint setid, List *items,
+                               uint *checked, uint *clus_table, double (*sim)(Set *, Set *),
+                               double thres)
+{
+     uint i;
+     int measure;
+     if (sim == set_overlap) {
+          measure = LIST_OVERLAP;
+     } else if (sim == set_jaccard) {
+          measure = LIST_JACCARD;
+     } else { // no bounds are known for other similarities
+          for (i = 0; i < items->size; i++) {
+               if (items->data[i].item != setid) {
+                    if (sim(&setdb->sets[setid], &setdb->sets[items->data[i].item]) > thres)
+                         mhlink_link(clusters, setid, items->data[i].item, checked, clus_table);
                }
           }
+          return;
      }
+
+     ullong *passed = (ullong *) malloc(((items->size + 63) / 64) * sizeof(ullong));
+     setdb_similarity_batch(setdb, &setdb->sets[setid], items, measure, thres, passed);
+     mhlink_link_passed(clusters, setid, items, passed, checked, clus_table);
+     free(passed);
 }
 
 /**
- * @brief Single-link clustering based on Min-Hashing without weighting.
+ * @brief Single-link clustering of any kind of database based on
+ *        Min-Hashing without weighting.
  *
- * @param listdb Database of lists to be hashed
- * @param table_size Number of buckets in the hash table
+ * @param db Database to be hashed
  * @param tuple_size Number of MinHash values per tuple
- * @param sim Similarity function for adding list to a cluster
- * @param thres Threshold for adding list to a cluster
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param min_cluster_size Minimum size of a cluster
  *
  * @return Clusters of IDs
  */
-ListDB mhlink_cluster(ListDB *listdb, uint tuple_size, uint number_of_tuples, uint table_size,
-                      double (*sim)(List *, List *), double thres, uint min_cluster_size)
+ListDB mhlink_cluster_db(MHLinkDB *db, uint tuple_size, uint number_of_tuples, uint table_size,
+                         uint min_cluster_size)
 {
      uint i, j;
-     uint *checked = (uint *) calloc(listdb->size, sizeof(uint));
-     uint *clus_table = (uint *) malloc(listdb->size * sizeof(uint));
-     uint *indices = (uint *) malloc(listdb->size * sizeof(uint));
-     HashTable hash_table = mh_create(table_size, tuple_size, listdb->dim);
+     uint *checked = (uint *) calloc(db->size, sizeof(uint));
+     uint *clus_table = (uint *) malloc(db->size * sizeof(uint));
+     uint *indices = (uint *) malloc(db->size * sizeof(uint));
+     HashTable hash_table = mh_create(table_size, tuple_size, db->dim);
      ListDB clusters;
      listdb_init(&clusters);
 
      for (i = 0; i < number_of_tuples; i++){// computes each hash table
-          printf("\rClustering table %u/%u: %u random permutations for %u lists",
-                 i + 1, number_of_tuples, tuple_size, listdb->size);
+          printf("\rClustering table %u/%u: %u random permutations for %u %s",
+                 i + 1, number_of_tuples, tuple_size, db->size, db->name);
           fflush(stdout);
 
           // stores lists in the hash table
-          mh_generate_permutations(listdb->dim, tuple_size, hash_table.permutations);
-          mh_store_listdb(listdb, &hash_table, indices);
+          mh_generate_permutations(db->dim, tuple_size, hash_table.permutations);
+          db->store(db, &hash_table, indices);
           
-          for (j = 0; j < listdb->size; j++){
+          for (j = 0; j < db->size; j++){
                if (checked[j] == 0){// list hasn't been checked
                     // a new cluster is formed
                     List new_cluster;
@@ -146,8 +543,8 @@ ListDB mhlink_cluster(ListDB *listdb, uint tuple_size, uint number_of_tuples, ui
                }
 
                // assign items in the same bucket to the same cluster
-               mhlink_add_neighbors(listdb, &clusters, j, &hash_table.buckets[indices[j]].items,
-                                    checked, clus_table, sim, thres);
+               db->neighbors(db, &clusters, j, &hash_table.buckets[indices[j]].items,
+                             checked, clus_table);
 
                // Freeing up bucket
                list_destroy(&hash_table.buckets[indices[j]].items);
@@ -162,12 +559,31 @@ ListDB mhlink_cluster(ListDB *listdb, uint tuple_size, uint number_of_tuples, ui
      free(clus_table);
 
      listdb_delete_smallest(&clusters, min_cluster_size);
-     ListDB models = mhlink_make_model(listdb, &clusters);
+     ListDB models = mhlink_make_model_db(db, &clusters);
      listdb_destroy(&clusters);
      
      return models;
 }
 
+/**
+ * @brief Single-link clustering based on Min-Hashing without weighting.
+ *
+ * @param listdb Database of lists to be hashed
+ * @param table_size Number of buckets in the hash table
+ * @param tuple_size Number of MinHash values per tuple
+ * @param sim Similarity function for adding list to a cluster
+ * @param thres Threshold for adding list to a cluster
+ *
+ * @return Clusters of IDs
+ */
+ListDB mhlink_cluster(ListDB *listdb, uint tuple_size, uint number_of_tuples, uint table_size,
+                      double (*sim)(List *, List *), double thres, uint min_cluster_size)
+{
+     MHLinkDB db = mhlink_db_lists(listdb, sim, thres);
+
+     return mhlink_cluster_db(&db, tuple_size, number_of_tuples, table_size, min_cluster_size);
+}
+
 /**
  * @brief Single-link clustering based on Min-Hashing with weighting.
  *
@@ -238,3 +654,50 @@ ListDB mhlink_cluster_weighted(ListDB *listdb, uint tuple_size, uint number_of_t
      
      return models;
 }
+
+/**
+ * @brief Single-link clustering of compressed lists based on Min-Hashing
+ *        without weighting. Lists are decoded on the fly for hashing and
+ *        compared in compressed form.
+ *
+ * @param listdb Database of compressed lists to be hashed
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param sim Similarity function for adding list to a cluster
+ * @param thres Threshold for adding list to a cluster
+ * @param min_cluster_size Minimum size of a cluster
+ *
+ * @return Clusters of IDs
+ */
+ListDB mhlink_cluster_compressed(CListDB *listdb, uint tuple_size, uint number_of_tuples,
+                                 uint table_size, double (*sim)(CList *, CList *), double thres,
+                                 uint min_cluster_size)
+{
+     MHLinkDB db = mhlink_db_compressed(listdb, sim, thres);
+
+     return mhlink_cluster_db(&db, tuple_size, number_of_tuples, table_size, min_cluster_size);
+}
+
+/**
+ * @brief Single-link clustering of sets based on Min-Hashing without
+ *        weighting.
+ *
+ * @param setdb Database of sets to be hashed
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param sim Similarity function for adding a set to a cluster
+ * @param thres Threshold for adding a set to a cluster
+ * @param min_cluster_size Minimum size of a cluster
+ *
+ * @return Clusters of IDs
+ */
+ListDB mhlink_cluster_sets(SetDB *setdb, uint tuple_size, uint number_of_tuples,
+                           uint table_size, double (*sim)(Set *, Set *), double thres,
+                           uint min_cluster_size)
+{
+     MHLinkDB db = mhlink_db_sets(setdb, sim, thres);
+
+     return mhlink_cluster_db(&db, tuple_size, number_of_tuples, table_size, min_cluster_size);
+}
@@ -307,20 +307,69 @@ void mh_univhash(List *list, HashTable *hash_table, uint *hash_value, uint *inde
 }
 
 /**
- * @brief Computes 2nd-level hash value of lists using open 
- *        adressing collision resolution and linear probing.
- * @todo Add other probing strategies.
+ * @brief Computes the MinHash value of a set. Only the ids are read, so
+ *        half the memory of a list is scanned.
+ * 
+ * @param set Set to be hashed
+ * @param permutations Random permutations
+ */
+ullong mh_compute_minhash_set(Set *set, RandomValue *permutations)
+{
+     uint i;
+
+     ullong min_int = permutations[set->data[0]].random_int;
+     double min_double = permutations[set->data[0]].random_double;
+     for (i = 1; i < set->size; i++) {
+          double current_value = permutations[set->data[i]].random_double;
+          if (min_double > current_value) {
+               min_int = permutations[set->data[i]].random_int;
+               min_double = current_value;
+          }
+     }
+     
+     return min_int;
+}
+
+/**
+ * @brief Universal hashing for getting a hash table index from the
+ *        minhash tuple of a set
  *
- * @param list List to be hashed
+ * @param set Set to be hashed
  * @param hash_table Hash table structure
+ * @param hash_value Hash value
+ * @param index Table index
+ */
+void mh_univhash_set(Set *set, HashTable *hash_table, uint *hash_value, uint *index)
+{
+     uint i;
+     ullong minhash;
+     __uint128_t temp_index = 0;
+     __uint128_t temp_hv = 0;
+
+     for (i = 0; i < hash_table->tuple_size; i++){
+          minhash = mh_compute_minhash_set(set, &hash_table->permutations[i * hash_table->dim]);
+          temp_index += ((ullong) hash_table->a[i]) * minhash;
+          temp_hv += ((ullong) hash_table->b[i]) * minhash; 
+     }
+
+     *hash_value = (temp_hv % LARGEST_PRIME64);   
+     *index = (temp_index % LARGEST_PRIME64) % hash_table->table_size;
+}
+
+/**
+ * @brief Finds the bucket of a given hash value using open adressing
+ *        collision resolution and linear probing.
+ *
+ * @param hash_table Hash table structure
+ * @param hash_value 2nd-level hash value
+ * @param index Initial index of the hash table
  *
  * @return - index of the hash table
- */ 
-uint mh_get_index(List *list, HashTable *hash_table)
+ */
+static uint mh_probe(HashTable *hash_table, uint hash_value, uint index)
 {
-     uint checked_buckets, index, hash_value;
-     
-     mh_univhash(list, hash_table, &hash_value, &index);
+     uint checked_buckets;
+
      if (hash_table->buckets[index].items.size != 0){ // examine buckets (open adressing)
           if (hash_table->buckets[index].hash_value != hash_value){
                checked_buckets = 1;
@@ -348,6 +397,43 @@ uint mh_get_index(List *list, HashTable *hash_table)
      return index;
 }
 
+/**
+ * @brief Computes 2nd-level hash value of lists using open 
+ *        adressing collision resolution and linear probing.
+ * @todo Add other probing strategies.
+ *
+ * @param list List to be hashed
+ * @param hash_table Hash table structure
+ *
+ * @return - index of the hash table
+ */ 
+uint mh_get_index(List *list, HashTable *hash_table)
+{
+     uint index, hash_value;
+     
+     mh_univhash(list, hash_table, &hash_value, &index);
+
+     return mh_probe(hash_table, hash_value, index);
+}
+
+/**
+ * @brief Computes 2nd-level hash value of sets using open 
+ *        adressing collision resolution and linear probing.
+ *
+ * @param set Set to be hashed
+ * @param hash_table Hash table structure
+ *
+ * @return - index of the hash table
+ */ 
+uint mh_get_index_set(Set *set, HashTable *hash_table)
+{
+     uint index, hash_value;
+     
+     mh_univhash_set(set, hash_table, &hash_value, &index);
+
+     return mh_probe(hash_table, hash_value, index);
+}
+
 /**
  * @brief Stores lists in the hash table.
  *
@@ -361,7 +447,35 @@ uint mh_store_list(List *list, uint id, HashTable *hash_table)
    
      // get index of the hash table
      index = mh_get_index(list, hash_table);
+     mh_store_id(index, id, hash_table);
+
+     return index;
+}
+
+/**
+ * @brief Stores a set in the hash table.
+ *
+ * @param set Set to be hashed
+ * @param id ID of the set
+ * @param hash_table Hash table
+ */ 
+uint mh_store_set(Set *set, uint id, HashTable *hash_table)
+{
+     uint index = mh_get_index_set(set, hash_table);
+     mh_store_id(index, id, hash_table);
+
+     return index;
+}
 
+/**
+ * @brief Stores the ID of a list in a given bucket of the hash table.
+ *
+ * @param index Index of the bucket
+ * @param id ID of the list
+ * @param hash_table Hash table
+ */ 
+void mh_store_id(uint index, uint id, HashTable *hash_table)
+{
      if (hash_table->buckets[index].items.size == 0){ // mark used bucket
           Item new_used_bucket = {index, 1};
           list_push(&hash_table->used_buckets, new_used_bucket);
@@ -370,8 +484,6 @@ uint mh_store_list(List *list, uint id, HashTable *hash_table)
      // store list id in the hash table
      Item new_item = {id, 1};
      list_push(&hash_table->buckets[index].items, new_item);
-
-     return index;
 }
 
 /**
@@ -391,6 +503,70 @@ void mh_store_listdb(ListDB *listdb, HashTable *hash_table, uint *indices)
                indices[i] = mh_store_list(&listdb->lists[i], i, hash_table);
 }
 
+/**
+ * @brief Stores sets in the hash table.
+ *
+ * @param setdb Database of sets to be hashed
+ * @param hash_table Hash table
+ * @param indices Indices of the used buckets
+ */ 
+void mh_store_setdb(SetDB *setdb, HashTable *hash_table, uint *indices)
+{
+     uint i;   
+         
+     for (i = 0; i < setdb->size; i++)
+          if (setdb->sets[i].size > 0)
+               indices[i] = mh_store_set(&setdb->sets[i], i, hash_table);
+}
+
+/**
+ * @brief Stores the lists of a database that is read in batches in the
+ *        hash table.
+ *
+ * @param reader Reader of the database of lists to be hashed
+ * @param hash_table Hash table
+ * @param indices Indices of the used buckets
+ */ 
+void mh_store_reader(ListDBReader *reader, HashTable *hash_table, uint *indices)
+{
+     uint i;
+     ListDB batch;
+     listdb_init(&batch);
+
+     listdb_reader_rewind(reader);
+     while (listdb_reader_next_batch(reader, &batch) > 0) {
+          for (i = 0; i < batch.size; i++)
+               if (batch.lists[i].size > 0)
+                    indices[reader->batch_start + i] = mh_store_list(&batch.lists[i],
+                                                                     reader->batch_start + i,
+                                                                     hash_table);
+     }
+     listdb_destroy(&batch);
+}
+
+/**
+ * @brief Stores compressed lists in the hash table. Each list is decoded
+ *        on the fly into a buffer that is reused for all the lists.
+ *
+ * @param listdb Database of compressed lists to be hashed
+ * @param hash_table Hash table
+ * @param indices Indices of the used buckets
+ */ 
+void mh_store_clistdb(CListDB *listdb, HashTable *hash_table, uint *indices)
+{
+     uint i;
+     List buffer;
+
+     list_init(&buffer);
+     for (i = 0; i < listdb->size; i++) {
+          if (listdb->lists[i].size > 0) {
+               clist_decode_into(&listdb->lists[i], &buffer);
+               indices[i] = mh_store_list(&buffer, i, hash_table);
+          }
+     }
+     list_destroy(&buffer);
+}
+
 /**
  * @brief Computes the cumulative maximum frequencies of a database of lists
  *
@@ -452,6 +628,35 @@ ListDB mh_expand_listdb(ListDB *listdb, uint *maxfreq)
      return expldb;
 }
 
+/**
+ * @brief Generates a database of sets from a database of lists with
+ *        frequencies greater than 1. Each occurrence of an item becomes
+ *        a different item of the set.
+ *
+ * @param listdb Database of lists with frequencies greater than 1
+ * @param maxfreq Array with the cumulative maximum frequencies
+ *                to generate an expanded set of items
+ *
+ * @return Expanded database of sets
+ */ 
+SetDB mh_expand_setdb(ListDB *listdb, uint *maxfreq)
+{
+     uint i, j, k;
+     SetDB expsdb = setdb_create(listdb->size, maxfreq[listdb->dim - 1] - 1);
+
+     for (i = 0; i < listdb->size; i++) {
+          for (j = 0; j < listdb->lists[i].size; j++) {
+               uint first = 0;
+               if (listdb->lists[i].data[j].item != 0)
+                    first = maxfreq[listdb->lists[i].data[j].item - 1];
+               for (k = 0; k < listdb->lists[i].data[j].freq; k++)
+                    set_push(&expsdb.sets[i], first + k);
+          }
+     }
+     
+     return expsdb;
+}
+
 /**
  * @brief Expands an array of weights based on an expanded set of items
  *
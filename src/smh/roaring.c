@@ -0,0 +1,832 @@
+/**
+ * @file roaring.c
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Operations on roaring bitmaps. Ids are split in chunks of 64K
+ *        values and each chunk is stored in an array, bitmap or run
+ *        container, whichever takes less memory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "roaring.h"
+
+/**
+ * @brief Counts the number of runs of consecutive values in a sorted array
+ *
+ * @param values Sorted values
+ * @param number Number of values
+ *
+ * @return Number of runs
+ */
+static uint roaring_count_runs(ushort *values, uint number)
+{
+     uint i;
+     uint runs = number > 0 ? 1 : 0;
+
+     for (i = 1; i < number; i++)
+          if (values[i] != values[i - 1] + 1)
+               runs++;
+
+     return runs;
+}
+
+/**
+ * @brief Makes a container from sorted low 16-bit values choosing the
+ *        representation that takes less memory
+ *
+ * @param container Container to be made
+ * @param key High 16 bits of the values
+ * @param values Sorted low 16-bit values
+ * @param number Number of values
+ */
+static void roaring_container_from_values(RoaringContainer *container, ushort key,
+                                          ushort *values, uint number)
+{
+     uint i;
+     uint runs = roaring_count_runs(values, number);
+
+     container->key = key;
+     container->cardinality = number;
+     if (4 * runs < 2 * number && 4 * runs < ROARING_BITMAP_WORDS * sizeof(ullong)) {
+          ushort *pairs = (ushort *) malloc(2 * runs * sizeof(ushort));
+          uint r = 0;
+          pairs[0] = values[0];
+          pairs[1] = 0;
+          for (i = 1; i < number; i++) {
+               if (values[i] == values[i - 1] + 1) {
+                    pairs[2 * r + 1]++;
+               } else {
+                    r++;
+                    pairs[2 * r] = values[i];
+                    pairs[2 * r + 1] = 0;
+               }
+          }
+          container->type = ROARING_RUN;
+          container->size = runs;
+          container->data = pairs;
+     } else if (number <= ROARING_ARRAY_MAX) {
+          container->type = ROARING_ARRAY;
+          container->size = number;
+          container->data = malloc(number * sizeof(ushort));
+          memcpy(container->data, values, number * sizeof(ushort));
+     } else {
+          ullong *words = (ullong *) calloc(ROARING_BITMAP_WORDS, sizeof(ullong));
+          for (i = 0; i < number; i++)
+               words[values[i] >> 6] |= 1ULL << (values[i] & 63);
+          container->type = ROARING_BITMAP;
+          container->size = ROARING_BITMAP_WORDS;
+          container->data = words;
+     }
+}
+
+/**
+ * @brief Makes a container from a bitmap choosing the representation
+ *        that takes less memory
+ *
+ * @param container Container to be made
+ * @param key High 16 bits of the values
+ * @param words Bitmap words
+ */
+static void roaring_container_from_words(RoaringContainer *container, ushort key, ullong *words)
+{
+     uint i;
+     uint cardinality = 0, runs = 0;
+     ullong carry = 0;
+
+     for (i = 0; i < ROARING_BITMAP_WORDS; i++) {
+          cardinality += __builtin_popcountll(words[i]);
+          runs += __builtin_popcountll(words[i] & ~((words[i] << 1) | carry));
+          carry = words[i] >> 63;
+     }
+
+     container->key = key;
+     container->cardinality = cardinality;
+     if (cardinality <= ROARING_ARRAY_MAX || 4 * runs < ROARING_BITMAP_WORDS * sizeof(ullong)) {
+          // extracts the values and lets the array/run heuristic decide
+          ushort *values = (ushort *) malloc(cardinality * sizeof(ushort));
+          uint number = 0;
+          for (i = 0; i < ROARING_BITMAP_WORDS; i++) {
+               ullong w = words[i];
+               while (w) {
+                    values[number++] = (ushort) ((i << 6) + __builtin_ctzll(w));
+                    w &= w - 1;
+               }
+          }
+          roaring_container_from_values(container, key, values, number);
+          free(values);
+     } else {
+          container->type = ROARING_BITMAP;
+          container->size = ROARING_BITMAP_WORDS;
+          container->data = malloc(ROARING_BITMAP_WORDS * sizeof(ullong));
+          memcpy(container->data, words, ROARING_BITMAP_WORDS * sizeof(ullong));
+     }
+}
+
+/**
+ * @brief Sets the bits of a container in a bitmap
+ *
+ * @param container Container
+ * @param words Bitmap words (cleared by this function)
+ */
+static void roaring_container_to_words(RoaringContainer *container, ullong *words)
+{
+     uint i, v;
+
+     if (container->type == ROARING_BITMAP) {
+          memcpy(words, container->data, ROARING_BITMAP_WORDS * sizeof(ullong));
+          return;
+     }
+
+     memset(words, 0, ROARING_BITMAP_WORDS * sizeof(ullong));
+     ushort *data = (ushort *) container->data;
+     if (container->type == ROARING_ARRAY) {
+          for (i = 0; i < container->size; i++)
+               words[data[i] >> 6] |= 1ULL << (data[i] & 63);
+     } else {
+          for (i = 0; i < container->size; i++)
+               for (v = data[2 * i]; v <= (uint) data[2 * i] + data[2 * i + 1]; v++)
+                    words[v >> 6] |= 1ULL << (v & 63);
+     }
+}
+
+/**
+ * @brief Gets the ids stored in a container
+ *
+ * @param container Container
+ * @param ids Buffer where the ids are stored
+ *
+ * @return Number of ids
+ */
+static uint roaring_container_values(RoaringContainer *container, uint *ids)
+{
+     uint i, v;
+     uint number = 0;
+     uint high = (uint) container->key << 16;
+
+     if (container->type == ROARING_ARRAY) {
+          ushort *data = (ushort *) container->data;
+          for (i = 0; i < container->size; i++)
+               ids[number++] = high | data[i];
+     } else if (container->type == ROARING_RUN) {
+          ushort *data = (ushort *) container->data;
+          for (i = 0; i < container->size; i++)
+               for (v = data[2 * i]; v <= (uint) data[2 * i] + data[2 * i + 1]; v++)
+                    ids[number++] = high | v;
+     } else {
+          ullong *words = (ullong *) container->data;
+          for (i = 0; i < ROARING_BITMAP_WORDS; i++) {
+               ullong w = words[i];
+               while (w) {
+                    ids[number++] = high | ((i << 6) + __builtin_ctzll(w));
+                    w &= w - 1;
+               }
+          }
+     }
+
+     return number;
+}
+
+/**
+ * @brief Checks if a container has a given low 16-bit value
+ *
+ * @param container Container
+ * @param value Low 16-bit value
+ *
+ * @return 1 if the value is in the container, 0 otherwise
+ */
+static int roaring_container_contains(RoaringContainer *container, ushort value)
+{
+     if (container->type == ROARING_BITMAP)
+          return (((ullong *) container->data)[value >> 6] >> (value & 63)) & 1;
+
+     ushort *data = (ushort *) container->data;
+     int low = 0, high = (int) container->size - 1;
+     if (container->type == ROARING_ARRAY) {
+          while (low <= high) {
+               int mid = (low + high) / 2;
+               if (data[mid] == value)
+                    return 1;
+               else if (data[mid] < value)
+                    low = mid + 1;
+               else
+                    high = mid - 1;
+          }
+     } else {
+          // finds the last run starting at or before the value
+          while (low <= high) {
+               int mid = (low + high) / 2;
+               if (data[2 * mid] <= value)
+                    low = mid + 1;
+               else
+                    high = mid - 1;
+          }
+          if (high >= 0 && value <= (uint) data[2 * high] + data[2 * high + 1])
+               return 1;
+     }
+
+     return 0;
+}
+
+/**
+ * @brief Destroys a container
+ *
+ * @param container Container to be destroyed
+ */
+static void roaring_container_destroy(RoaringContainer *container)
+{
+     free(container->data);
+     container->data = NULL;
+     container->size = 0;
+     container->cardinality = 0;
+}
+
+/**
+ * @brief Copies a container
+ *
+ * @param container Container to be copied
+ *
+ * @return Copy of the container
+ */
+static RoaringContainer roaring_container_copy(RoaringContainer *container)
+{
+     RoaringContainer copy = *container;
+     size_t bytes;
+
+     if (container->type == ROARING_BITMAP)
+          bytes = ROARING_BITMAP_WORDS * sizeof(ullong);
+     else if (container->type == ROARING_RUN)
+          bytes = 2 * container->size * sizeof(ushort);
+     else
+          bytes = container->size * sizeof(ushort);
+
+     copy.data = malloc(bytes);
+     memcpy(copy.data, container->data, bytes);
+
+     return copy;
+}
+
+/**
+ * @brief Computes the memory used by a container
+ *
+ * @param container Container
+ *
+ * @return Number of bytes
+ */
+static size_t roaring_container_memory(RoaringContainer *container)
+{
+     if (container->type == ROARING_BITMAP)
+          return ROARING_BITMAP_WORDS * sizeof(ullong);
+     else if (container->type == ROARING_RUN)
+          return 2 * container->size * sizeof(ushort);
+     else
+          return container->size * sizeof(ushort);
+}
+
+/**
+ * @brief Counts the values in the intersection of two containers
+ *
+ * @param container1 First container
+ * @param container2 Second container
+ *
+ * @return Cardinality of the intersection
+ */
+static uint roaring_container_and_cardinality(RoaringContainer *container1,
+                                              RoaringContainer *container2)
+{
+     uint i;
+     uint cardinality = 0;
+
+     if (container1->type != ROARING_ARRAY && container2->type == ROARING_ARRAY) {
+          RoaringContainer *tmp = container1;
+          container1 = container2;
+          container2 = tmp;
+     }
+
+     if (container1->type == ROARING_ARRAY) {
+          ushort *data = (ushort *) container1->data;
+          for (i = 0; i < container1->size; i++)
+               cardinality += roaring_container_contains(container2, data[i]);
+     } else {
+          ullong words1[ROARING_BITMAP_WORDS], words2[ROARING_BITMAP_WORDS];
+          ullong *bits1 = (ullong *) container1->data;
+          ullong *bits2 = (ullong *) container2->data;
+          if (container1->type != ROARING_BITMAP) {
+               roaring_container_to_words(container1, words1);
+               bits1 = words1;
+          }
+          if (container2->type != ROARING_BITMAP) {
+               roaring_container_to_words(container2, words2);
+               bits2 = words2;
+          }
+          for (i = 0; i < ROARING_BITMAP_WORDS; i++)
+               cardinality += __builtin_popcountll(bits1[i] & bits2[i]);
+     }
+
+     return cardinality;
+}
+
+/**
+ * @brief Computes the intersection of two containers
+ *
+ * @param container1 First container
+ * @param container2 Second container
+ * @param result Intersection container
+ *
+ * @return 1 if the intersection is not empty, 0 otherwise
+ */
+static int roaring_container_and(RoaringContainer *container1, RoaringContainer *container2,
+                                 RoaringContainer *result)
+{
+     uint i;
+
+     if (container1->type != ROARING_ARRAY && container2->type == ROARING_ARRAY) {
+          RoaringContainer *tmp = container1;
+          container1 = container2;
+          container2 = tmp;
+     }
+
+     if (container1->type == ROARING_ARRAY) {
+          ushort values[ROARING_ARRAY_MAX];
+          ushort *data = (ushort *) container1->data;
+          uint number = 0;
+          for (i = 0; i < container1->size; i++)
+               if (roaring_container_contains(container2, data[i]))
+                    values[number++] = data[i];
+          if (number == 0)
+               return 0;
+          roaring_container_from_values(result, container1->key, values, number);
+     } else {
+          ullong words1[ROARING_BITMAP_WORDS], words2[ROARING_BITMAP_WORDS];
+          ullong any = 0;
+          roaring_container_to_words(container1, words1);
+          roaring_container_to_words(container2, words2);
+          for (i = 0; i < ROARING_BITMAP_WORDS; i++) {
+               words1[i] &= words2[i];
+               any |= words1[i];
+          }
+          if (any == 0)
+               return 0;
+          roaring_container_from_words(result, container1->key, words1);
+     }
+
+     return 1;
+}
+
+/**
+ * @brief Computes the union of two containers
+ *
+ * @param container1 First container
+ * @param container2 Second container
+ * @param result Union container
+ */
+static void roaring_container_or(RoaringContainer *container1, RoaringContainer *container2,
+                                 RoaringContainer *result)
+{
+     uint i;
+
+     if (container1->type == ROARING_ARRAY && container2->type == ROARING_ARRAY) {
+          ushort values[2 * ROARING_ARRAY_MAX];
+          ushort *data1 = (ushort *) container1->data;
+          ushort *data2 = (ushort *) container2->data;
+          uint j = 0, k = 0, number = 0;
+          while (j < container1->size && k < container2->size) {
+               if (data1[j] == data2[k]) {
+                    values[number++] = data1[j++];
+                    k++;
+               } else if (data1[j] < data2[k]) {
+                    values[number++] = data1[j++];
+               } else {
+                    values[number++] = data2[k++];
+               }
+          }
+          while (j < container1->size)
+               values[number++] = data1[j++];
+          while (k < container2->size)
+               values[number++] = data2[k++];
+          roaring_container_from_values(result, container1->key, values, number);
+     } else {
+          ullong words1[ROARING_BITMAP_WORDS], words2[ROARING_BITMAP_WORDS];
+          roaring_container_to_words(container1, words1);
+          roaring_container_to_words(container2, words2);
+          for (i = 0; i < ROARING_BITMAP_WORDS; i++)
+               words1[i] |= words2[i];
+          roaring_container_from_words(result, container1->key, words1);
+     }
+}
+
+/**
+ * @brief Initializes a roaring bitmap
+ *
+ * @param bitmap Roaring bitmap to be initialized
+ */
+void roaring_init(Roaring *bitmap)
+{
+     bitmap->size = 0;
+     bitmap->containers = NULL;
+}
+
+/**
+ * @brief Makes a roaring bitmap from the items of a list sorted by item
+ *        in ascending order. Frequencies are discarded.
+ *
+ * @param list List sorted by item
+ *
+ * @return Roaring bitmap
+ */
+Roaring roaring_from_list(List *list)
+{
+     Roaring bitmap;
+     roaring_init(&bitmap);
+     if (list->size == 0)
+          return bitmap;
+
+     uint number_of_keys = (list->data[list->size - 1].item >> 16) -
+          (list->data[0].item >> 16) + 1;
+     if (number_of_keys > list->size)
+          number_of_keys = list->size;
+     bitmap.containers = (RoaringContainer *) malloc(number_of_keys * sizeof(RoaringContainer));
+
+     uint i = 0;
+     ushort *values = (ushort *) malloc(ROARING_CHUNK_SIZE * sizeof(ushort));
+     while (i < list->size) {
+          uint key = list->data[i].item >> 16;
+          uint number = 0;
+          for (; i < list->size && (list->data[i].item >> 16) == key; i++) {
+               ushort value = (ushort) (list->data[i].item & 0xFFFF);
+               if (number == 0 || values[number - 1] != value)
+                    values[number++] = value;
+          }
+          roaring_container_from_values(&bitmap.containers[bitmap.size++], (ushort) key,
+                                        values, number);
+     }
+     free(values);
+
+     bitmap.containers = realloc(bitmap.containers, bitmap.size * sizeof(RoaringContainer));
+
+     return bitmap;
+}
+
+/**
+ * @brief Converts a roaring bitmap to a list of items with frequency 1
+ *
+ * @param bitmap Roaring bitmap
+ *
+ * @return List sorted by item
+ */
+List roaring_to_list(Roaring *bitmap)
+{
+     uint i, j;
+     List list;
+
+     list.size = 0;
+     list.data = (Item *) malloc(roaring_cardinality(bitmap) * sizeof(Item));
+     uint *ids = (uint *) malloc(ROARING_CHUNK_SIZE * sizeof(uint));
+     for (i = 0; i < bitmap->size; i++) {
+          uint number = roaring_container_values(&bitmap->containers[i], ids);
+          for (j = 0; j < number; j++) {
+               list.data[list.size].item = ids[j];
+               list.data[list.size++].freq = 1;
+          }
+     }
+     free(ids);
+
+     return list;
+}
+
+/**
+ * @brief Destroys a roaring bitmap
+ *
+ * @param bitmap Roaring bitmap to be destroyed
+ */
+void roaring_destroy(Roaring *bitmap)
+{
+     uint i;
+
+     for (i = 0; i < bitmap->size; i++)
+          roaring_container_destroy(&bitmap->containers[i]);
+
+     free(bitmap->containers);
+     roaring_init(bitmap);
+}
+
+/**
+ * @brief Prints in screen the containers of a roaring bitmap
+ *
+ * @param bitmap Roaring bitmap to be printed
+ */
+void roaring_print(Roaring *bitmap)
+{
+     uint i;
+     const char *names[] = {"array", "bitmap", "run"};
+
+     printf ("%u -- ", roaring_cardinality(bitmap));
+     for (i = 0; i < bitmap->size; i++)
+          printf ("%u:%s[%u] ", bitmap->containers[i].key,
+                  names[bitmap->containers[i].type], bitmap->containers[i].cardinality);
+     printf("\n");
+}
+
+/**
+ * @brief Computes the number of ids in a roaring bitmap
+ *
+ * @param bitmap Roaring bitmap
+ *
+ * @return Cardinality of the bitmap
+ */
+uint roaring_cardinality(Roaring *bitmap)
+{
+     uint i;
+     uint cardinality = 0;
+
+     for (i = 0; i < bitmap->size; i++)
+          cardinality += bitmap->containers[i].cardinality;
+
+     return cardinality;
+}
+
+/**
+ * @brief Checks if a roaring bitmap has a given id
+ *
+ * @param bitmap Roaring bitmap
+ * @param id Id to be searched
+ *
+ * @return 1 if the id is in the bitmap, 0 otherwise
+ */
+int roaring_contains(Roaring *bitmap, uint id)
+{
+     int low = 0, high = (int) bitmap->size - 1;
+     ushort key = (ushort) (id >> 16);
+
+     while (low <= high) {
+          int mid = (low + high) / 2;
+          if (bitmap->containers[mid].key == key)
+               return roaring_container_contains(&bitmap->containers[mid], (ushort) (id & 0xFFFF));
+          else if (bitmap->containers[mid].key < key)
+               low = mid + 1;
+          else
+               high = mid - 1;
+     }
+
+     return 0;
+}
+
+/**
+ * @brief Increments the counter of an id and appends the id to the
+ *        touched ids the first time it is counted
+ *
+ * @param id Id
+ * @param counts Counters indexed by id
+ * @param touched Ids with a nonzero counter or NULL
+ * @param size Number of touched ids
+ */
+static void roaring_count(uint id, uint *counts, uint *touched, uint *size)
+{
+     if (touched != NULL && counts[id] == 0)
+          touched[(*size)++] = id;
+     counts[id]++;
+}
+
+/**
+ * @brief Increments the counter of each id in a roaring bitmap. Ids are
+ *        visited once, so the ids of many bitmaps are collected in the
+ *        same pass without computing their union.
+ *
+ * @param bitmap Roaring bitmap
+ * @param counts Counters indexed by id
+ * @param touched Array where ids whose counter was zero are appended, or
+ *        NULL
+ * @param size Number of ids in touched
+ */
+void roaring_accumulate(Roaring *bitmap, uint *counts, uint *touched, uint *size)
+{
+     uint i, j, v;
+
+     for (i = 0; i < bitmap->size; i++) {
+          RoaringContainer *container = &bitmap->containers[i];
+          uint high = (uint) container->key << 16;
+          if (container->type == ROARING_ARRAY) {
+               ushort *data = (ushort *) container->data;
+               for (j = 0; j < container->size; j++)
+                    roaring_count(high | data[j], counts, touched, size);
+          } else if (container->type == ROARING_RUN) {
+               ushort *data = (ushort *) container->data;
+               for (j = 0; j < container->size; j++)
+                    for (v = data[2 * j]; v <= (uint) data[2 * j] + data[2 * j + 1]; v++)
+                         roaring_count(high | v, counts, touched, size);
+          } else {
+               ullong *words = (ullong *) container->data;
+               for (j = 0; j < ROARING_BITMAP_WORDS; j++) {
+                    ullong w = words[j];
+                    while (w) {
+                         roaring_count(high | ((j << 6) + __builtin_ctzll(w)), counts, touched, size);
+                         w &= w - 1;
+                    }
+               }
+          }
+     }
+}
+
+/**
+ * @brief Computes the intersection of two roaring bitmaps
+ *
+ * @param bitmap1 First roaring bitmap
+ * @param bitmap2 Second roaring bitmap
+ *
+ * @return Intersection bitmap
+ */
+Roaring roaring_and(Roaring *bitmap1, Roaring *bitmap2)
+{
+     uint i = 0, j = 0;
+     Roaring result;
+
+     uint number_of_keys = min(bitmap1->size, bitmap2->size);
+     result.size = 0;
+     result.containers = (RoaringContainer *) malloc(number_of_keys * sizeof(RoaringContainer));
+     while (i < bitmap1->size && j < bitmap2->size) {
+          if (bitmap1->containers[i].key == bitmap2->containers[j].key) {
+               if (roaring_container_and(&bitmap1->containers[i], &bitmap2->containers[j],
+                                         &result.containers[result.size]))
+                    result.size++;
+               i++;
+               j++;
+          } else if (bitmap1->containers[i].key < bitmap2->containers[j].key) {
+               i++;
+          } else {
+               j++;
+          }
+     }
+     result.containers = realloc(result.containers, result.size * sizeof(RoaringContainer));
+
+     return result;
+}
+
+/**
+ * @brief Computes the union of two roaring bitmaps
+ *
+ * @param bitmap1 First roaring bitmap
+ * @param bitmap2 Second roaring bitmap
+ *
+ * @return Union bitmap
+ */
+Roaring roaring_or(Roaring *bitmap1, Roaring *bitmap2)
+{
+     uint i = 0, j = 0;
+     Roaring result;
+
+     result.size = 0;
+     result.containers = (RoaringContainer *) malloc((bitmap1->size + bitmap2->size) *
+                                                     sizeof(RoaringContainer));
+     while (i < bitmap1->size && j < bitmap2->size) {
+          if (bitmap1->containers[i].key == bitmap2->containers[j].key) {
+               roaring_container_or(&bitmap1->containers[i], &bitmap2->containers[j],
+                                    &result.containers[result.size++]);
+               i++;
+               j++;
+          } else if (bitmap1->containers[i].key < bitmap2->containers[j].key) {
+               result.containers[result.size++] = roaring_container_copy(&bitmap1->containers[i++]);
+          } else {
+               result.containers[result.size++] = roaring_container_copy(&bitmap2->containers[j++]);
+          }
+     }
+
+     while (i < bitmap1->size)
+          result.containers[result.size++] = roaring_container_copy(&bitmap1->containers[i++]);
+
+     while (j < bitmap2->size)
+          result.containers[result.size++] = roaring_container_copy(&bitmap2->containers[j++]);
+
+     result.containers = realloc(result.containers, result.size * sizeof(RoaringContainer));
+
+     return result;
+}
+
+/**
+ * @brief Computes the size of the intersection of two roaring bitmaps
+ *        without materializing it
+ *
+ * @param bitmap1 First roaring bitmap
+ * @param bitmap2 Second roaring bitmap
+ *
+ * @return Size of the intersection
+ */
+uint roaring_and_cardinality(Roaring *bitmap1, Roaring *bitmap2)
+{
+     uint i = 0, j = 0;
+     uint cardinality = 0;
+
+     while (i < bitmap1->size && j < bitmap2->size) {
+          if (bitmap1->containers[i].key == bitmap2->containers[j].key) {
+               cardinality += roaring_container_and_cardinality(&bitmap1->containers[i],
+                                                                &bitmap2->containers[j]);
+               i++;
+               j++;
+          } else if (bitmap1->containers[i].key < bitmap2->containers[j].key) {
+               i++;
+          } else {
+               j++;
+          }
+     }
+
+     return cardinality;
+}
+
+/**
+ * @brief Computes the memory used by a roaring bitmap
+ *
+ * @param bitmap Roaring bitmap
+ *
+ * @return Number of bytes
+ */
+size_t roaring_memory(Roaring *bitmap)
+{
+     uint i;
+     size_t bytes = bitmap->size * sizeof(RoaringContainer);
+
+     for (i = 0; i < bitmap->size; i++)
+          bytes += roaring_container_memory(&bitmap->containers[i]);
+
+     return bytes;
+}
+
+/**
+ * @brief Initializes a database of roaring bitmaps
+ *
+ * @param bitmapdb Database of roaring bitmaps to be initialized
+ */
+void roaringdb_init(RoaringDB *bitmapdb)
+{
+     bitmapdb->size = 0;
+     bitmapdb->dim = 0;
+     bitmapdb->bitmaps = NULL;
+}
+
+/**
+ * @brief Makes a database of roaring bitmaps from a database of lists
+ *        (e.g. the rows of an inverted file). Lists must be sorted by
+ *        item in ascending order.
+ *
+ * @param listdb Database of lists
+ *
+ * @return Database of roaring bitmaps
+ */
+RoaringDB roaringdb_from_listdb(ListDB *listdb)
+{
+     uint i;
+     RoaringDB bitmapdb;
+
+     bitmapdb.size = listdb->size;
+     bitmapdb.dim = listdb->dim;
+     bitmapdb.bitmaps = (Roaring *) malloc(listdb->size * sizeof(Roaring));
+     for (i = 0; i < listdb->size; i++)
+          bitmapdb.bitmaps[i] = roaring_from_list(&listdb->lists[i]);
+
+     return bitmapdb;
+}
+
+/**
+ * @brief Destroys a database of roaring bitmaps
+ *
+ * @param bitmapdb Database of roaring bitmaps to be destroyed
+ */
+void roaringdb_destroy(RoaringDB *bitmapdb)
+{
+     uint i;
+
+     for (i = 0; i < bitmapdb->size; i++)
+          roaring_destroy(&bitmapdb->bitmaps[i]);
+
+     free(bitmapdb->bitmaps);
+     roaringdb_init(bitmapdb);
+}
+
+/**
+ * @brief Computes the memory used by a database of roaring bitmaps
+ *
+ * @param bitmapdb Database of roaring bitmaps
+ *
+ * @return Number of bytes
+ */
+size_t roaringdb_memory(RoaringDB *bitmapdb)
+{
+     uint i;
+     size_t bytes = bitmapdb->size * sizeof(Roaring);
+
+     for (i = 0; i < bitmapdb->size; i++)
+          bytes += roaring_memory(&bitmapdb->bitmaps[i]);
+
+     return bytes;
+}
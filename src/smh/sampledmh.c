@@ -19,6 +19,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "ifindex.h"
 #include "sampledmh.h"
@@ -76,7 +77,8 @@ ListDB sampledmh_mine(ListDB *listdb,
             tuple_size,
             table_size);
 
-     // Hashing database & storing candidates
+     // Hashing database & storing candidates, each pass reads the lists in order
+     listdb_advise(listdb, LISTDB_ACCESS_SEQUENTIAL);
      uint i;
      for (i = 0; i < number_of_tuples; i++){
           printf("\rMining table %u/%u: %u random permutations for %u lists",
@@ -116,7 +118,8 @@ ListDB sampledmh_mine_weighted(ListDB *listdb,
      listdb_init(&coitems);
      coitems.dim = listdb->size;
           
-     // Hashing database & storing candidates
+     // Hashing database & storing candidates, each pass reads the lists in order
+     listdb_advise(listdb, LISTDB_ACCESS_SEQUENTIAL);
      uint i;
      for (i = 0; i < number_of_tuples; i++){
           printf("Mining table %u/%u: %u random permutations for %u lists\r",
@@ -135,6 +138,213 @@ ListDB sampledmh_mine_weighted(ListDB *listdb,
      return coitems;
 }
 
+/**
+ * @brief Retrieves the sets of items that were stored in the same bucket
+ *
+ * @param cosets Database where the co-occurring sets are added
+ * @param hash_table Hash table
+ * @param min_set_size Minimum size of a co-occurring set
+ */ 
+void sampledmh_get_cosets(SetDB *cosets, HashTable *hash_table, uint min_set_size)
+{
+     uint i;
+
+     for (i = 0; i < hash_table->used_buckets.size; i++){ // scan buckets to find co-occurring items
+          Bucket *bucket = &hash_table->buckets[hash_table->used_buckets.data[i].item];
+          if (bucket->items.size >= min_set_size) {
+               Set coset = set_from_list(&bucket->items);
+               setdb_push(cosets, &coset);
+          }
+          
+          list_destroy(&bucket->items);
+          bucket->hash_value = 0;
+     }
+
+     list_destroy(&hash_table->used_buckets);
+}
+
+/**
+ * @brief Function for mining a database of sets based on Min-Hashing
+ *        without weighting. Mined sets are returned without frequencies.
+ *
+ * @param setdb Database of sets
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param min_set_size Minimum size of a mined set
+ */
+SetDB sampledmh_mine_sets(SetDB *setdb,
+                          uint tuple_size,
+                          uint number_of_tuples,
+                          uint table_size,
+                          uint min_set_size)
+{
+     HashTable hash_table = mh_create(table_size, tuple_size, setdb->dim);
+     uint *indices = (uint *) malloc(setdb->size * sizeof(uint));
+
+     SetDB cosets;
+     setdb_init(&cosets);
+     cosets.dim = setdb->size;
+
+     printf("Mining a database of %u sets (dim = %u) with %u tuples of %u values (table size = %u)\n",
+            setdb->size,
+            setdb->dim,
+            number_of_tuples,
+            tuple_size,
+            table_size);
+
+     uint i;
+     for (i = 0; i < number_of_tuples; i++){
+          printf("\rMining table %u/%u: %u random permutations for %u sets",
+                 i + 1, number_of_tuples, tuple_size, setdb->size);
+          fflush(stdout);
+          mh_generate_permutations(setdb->dim, tuple_size, hash_table.permutations);
+          mh_store_setdb(setdb, &hash_table, indices);
+          sampledmh_get_cosets(&cosets, &hash_table, min_set_size);
+     }
+     printf("\n");
+     mh_destroy(&hash_table);
+     free(indices);
+
+     return cosets;
+}
+
+/**
+ * @brief Function for mining a database of sets based on Min-Hashing
+ *        with weighting. Mined sets are returned without frequencies.
+ *
+ * @param setdb Database of sets
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param weights Weight of each item
+ * @param min_set_size Minimum size of a mined set
+ */
+SetDB sampledmh_mine_weighted_sets(SetDB *setdb,
+                                   uint tuple_size,
+                                   uint number_of_tuples,
+                                   uint table_size,
+                                   double *weights,
+                                   uint min_set_size)
+{
+     HashTable hash_table = mh_create(table_size, tuple_size, setdb->dim);
+     uint *indices = (uint *) malloc(setdb->size * sizeof(uint));
+
+     SetDB cosets;
+     setdb_init(&cosets);
+     cosets.dim = setdb->size;
+          
+     uint i;
+     for (i = 0; i < number_of_tuples; i++){
+          printf("Mining table %u/%u: %u random permutations for %u sets\r",
+                 i + 1, number_of_tuples, tuple_size, setdb->size);
+
+          mh_generate_permutations(setdb->dim, tuple_size, hash_table.permutations);
+          mh_weight_permutations(setdb->dim, tuple_size, hash_table.permutations, weights);
+          mh_store_setdb(setdb, &hash_table, indices);
+          sampledmh_get_cosets(&cosets, &hash_table, min_set_size);
+     }
+
+     mh_destroy(&hash_table);
+     free(indices);
+
+     return cosets;
+}
+
+/**
+ * @brief Function for mining a database of lists that is read in batches
+ *        based on Min-Hashing without weighting. The database is read
+ *        once per MinHash tuple and mined sets are returned without
+ *        frequencies.
+ *
+ * @param reader Reader of the database of lists
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param min_set_size Minimum size of a mined set
+ */
+SetDB sampledmh_mine_reader(ListDBReader *reader,
+                            uint tuple_size,
+                            uint number_of_tuples,
+                            uint table_size,
+                            uint min_set_size)
+{
+     listdb_reader_count(reader);
+     HashTable hash_table = mh_create(table_size, tuple_size, reader->dim);
+     uint *indices = (uint *) malloc(reader->size * sizeof(uint));
+
+     SetDB cosets;
+     setdb_init(&cosets);
+     cosets.dim = reader->size;
+
+     printf("Mining a database of %u lists (dim = %u) with %u tuples of %u values (table size = %u)\n",
+            reader->size,
+            reader->dim,
+            number_of_tuples,
+            tuple_size,
+            table_size);
+
+     uint i;
+     for (i = 0; i < number_of_tuples; i++){
+          printf("\rMining table %u/%u: %u random permutations for %u lists",
+                 i + 1, number_of_tuples, tuple_size, reader->size);
+          fflush(stdout);
+          mh_generate_permutations(reader->dim, tuple_size, hash_table.permutations);
+          mh_store_reader(reader, &hash_table, indices);
+          sampledmh_get_cosets(&cosets, &hash_table, min_set_size);
+     }
+     printf("\n");
+     mh_destroy(&hash_table);
+     free(indices);
+
+     return cosets;
+}
+
+/**
+ * @brief Function for mining a database of lists that is read in batches
+ *        based on Min-Hashing with weighting. The database is read once
+ *        per MinHash tuple and mined sets are returned without
+ *        frequencies.
+ *
+ * @param reader Reader of the database of lists
+ * @param tuple_size Number of MinHash values per tuple
+ * @param number_of_tuples Number of MinHash tuples
+ * @param table_size Number of buckets in the hash table
+ * @param weights Weight of each item
+ * @param min_set_size Minimum size of a mined set
+ */
+SetDB sampledmh_mine_weighted_reader(ListDBReader *reader,
+                                     uint tuple_size,
+                                     uint number_of_tuples,
+                                     uint table_size,
+                                     double *weights,
+                                     uint min_set_size)
+{
+     listdb_reader_count(reader);
+     HashTable hash_table = mh_create(table_size, tuple_size, reader->dim);
+     uint *indices = (uint *) malloc(reader->size * sizeof(uint));
+
+     SetDB cosets;
+     setdb_init(&cosets);
+     cosets.dim = reader->size;
+          
+     uint i;
+     for (i = 0; i < number_of_tuples; i++){
+          printf("Mining table %u/%u: %u random permutations for %u lists\r",
+                 i + 1, number_of_tuples, tuple_size, reader->size);
+
+          mh_generate_permutations(reader->dim, tuple_size, hash_table.permutations);
+          mh_weight_permutations(reader->dim, tuple_size, hash_table.permutations, weights);
+          mh_store_reader(reader, &hash_table, indices);
+          sampledmh_get_cosets(&cosets, &hash_table, min_set_size);
+     }
+
+     mh_destroy(&hash_table);
+     free(indices);
+
+     return cosets;
+}
+
 /**
  * @brief Generates a database of lists with frequencies equal to 1
  *        from a database of lists with frequencies greater than 1
@@ -176,41 +386,403 @@ ListDB sampledmh_expand_frequencies_and_weights(ListDB *listdb, ListDB *ifindex,
 }
 
 /**
- * @brief Prunes co-occurring sets.
+ * @brief Prunes co-occurring sets with any kind of inverted file. Sets are
+ *        queried in batches to bound the memory of the results, keeping
+ *        the documents in which at least ovr percent of their items
+ *        occurred. Items that co-occur in very few of the retrieved
+ *        documents are removed from the sets and sets retrieving less
+ *        than hits documents are destroyed.
  *
- * @param ifindex Inverted file index
+ * @param index Inverted file
  * @param mined Co-occurring sets
  * @param stop Minimum number of items in co-occurring sets
  * @param hits Minimum number of hits of co-occurring set
  * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
  * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
  */
-void sampledmh_prune(ListDB *ifindex, ListDB *mined, uint stop, uint hits, double ovr, double cooc)
+void sampledmh_prune_index(SMHPruneIndex *index, ListDB *mined, uint stop, uint hits,
+                           double ovr, double cooc)
 {
-     // query inverted file with mined sets
-
-     // leaves documents in which at least ovr_th percent of the mined sets occurred
-     uint i, j;
-     for (i = 0; i < mined->size; i++) {
-          uint ovr_th = (uint) round((double) mined->lists[i].size * ovr);
-          List retdoc = ifindex_query(ifindex,&mined->lists[i]);
-          list_delete_less_frequent(&retdoc, ovr_th);
-         
-          uint cooc_th = (uint) round((double) retdoc.size * cooc);
-          for (j = 0; j < mined->lists[i].size; j++) {
-               // removes items from sets which co-occured in very few documents with the rest
-               uint curr_item = mined->lists[i].data[j].item;
-               if (list_intersection_size(&ifindex->lists[curr_item], &retdoc) < cooc_th) {
-                    list_delete_position(&mined->lists[i], j);
+     int i;
+     uint first;
+     uint *ovr_th = (uint *) malloc(IFINDEX_QUERY_BATCH * sizeof(uint));
+     ListDB retdocs = listdb_create(IFINDEX_QUERY_BATCH, index->dim);
+     for (first = 0; first < mined->size; first += IFINDEX_QUERY_BATCH) {
+          ListDB batch;
+          listdb_init(&batch);
+          batch.size = mined->size - first < IFINDEX_QUERY_BATCH ?
+               mined->size - first : IFINDEX_QUERY_BATCH;
+          batch.dim = mined->dim;
+          batch.lists = mined->lists + first;
+
+          // leaves documents in which at least ovr_th percent of the mined sets occurred
+          for (i = 0; i < batch.size; i++)
+               ovr_th[i] = (uint) round((double) batch.lists[i].size * ovr);
+          if (index->query_batch != NULL) {
+               index->query_batch(index, &batch, ovr_th, &retdocs);
+          } else {
+#pragma omp parallel
+               {
+                    IFAccumulator acc = ifindex_accumulator_create(index->dim);
+#pragma omp for schedule(dynamic)
+                    for (i = 0; i < batch.size; i++)
+                         retdocs.lists[i] = index->query(index, &batch.lists[i], ovr_th[i], &acc);
+                    ifindex_accumulator_destroy(&acc);
                }
           }
 
-          // destroy mined lists that occur in less than a given number of documents
-          if (retdoc.size < hits) 
-               list_destroy(&mined->lists[i]);
-          list_destroy(&retdoc);
+#pragma omp parallel for schedule(dynamic)
+          for (i = 0; i < batch.size; i++) {
+               uint j;
+               List *retdoc = &retdocs.lists[i];
+               void *state = index->prepare != NULL ? index->prepare(index, retdoc) : NULL;
+               uint cooc_th = (uint) round((double) retdoc->size * cooc);
+               for (j = 0; j < mined->lists[first + i].size; j++) {
+                    // removes items from sets which co-occured in very few documents with the rest
+                    uint curr_item = mined->lists[first + i].data[j].item;
+                    if (index->cooccurrences(index, state, curr_item, retdoc) < cooc_th) {
+                         listdb_detach_list(mined, first + i);
+                         list_delete_position(&mined->lists[first + i], j);
+                    }
+               }
+               if (index->release != NULL)
+                    index->release(index, state);
+
+               // destroy mined lists that occur in less than a given number of documents
+               if (retdoc->size < hits)
+                    listdb_destroy_list(mined, first + i);
+               list_destroy(retdoc);
+          }
      }
+     listdb_destroy(&retdocs);
+     free(ovr_th);
 
      // removes small sets
      listdb_delete_smallest(mined, stop);
 }
+
+/**
+ * @brief Prunes co-occurring sets. Sets with the same items share the
+ *        results of their queries through a cache.
+ *
+ * @param ifindex Inverted file index
+ * @param mined Co-occurring sets
+ * @param stop Minimum number of items in co-occurring sets
+ * @param hits Minimum number of hits of co-occurring set
+ * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
+ * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
+ */
+void sampledmh_prune(ListDB *ifindex, ListDB *mined, uint stop, uint hits, double ovr, double cooc)
+{
+     IFCache cache = ifindex_cache_create(IFINDEX_CACHE_CAPACITY);
+     sampledmh_prune_cached(ifindex, mined, stop, hits, ovr, cooc, &cache);
+     ifindex_cache_destroy(&cache);
+}
+
+/**
+ * @brief Answers a batch of queries to an inverted file index
+ *
+ * @param index Inverted file index
+ * @param queries Batch of queries
+ * @param min_hits Minimum number of hits of the documents of each query
+ * @param results Lists where the results are stored
+ */
+static void sampledmh_query_lists(SMHPruneIndex *index, ListDB *queries, uint *min_hits,
+                                  ListDB *results)
+{
+     ifindex_query_batch((ListDB *) index->index, queries, min_hits, index->cache, results);
+}
+
+/**
+ * @brief Counts the retrieved documents that contain an item using an
+ *        inverted file index
+ *
+ * @param index Inverted file index
+ * @param state Unused
+ * @param item Item
+ * @param retdoc Retrieved documents
+ *
+ * @return Number of retrieved documents that contain the item
+ */
+static uint sampledmh_cooccurrences_lists(SMHPruneIndex *index, void *state, uint item,
+                                          List *retdoc)
+{
+     ListDB *ifindex = (ListDB *) index->index;
+     if (ifindex->access != NULL)
+          listdb_record_access(ifindex, item);
+
+     return ifindex_intersection_size(ifindex, &index->skips, item, retdoc);
+}
+
+/**
+ * @brief Prunes co-occurring sets reusing the query results in a cache,
+ *        which keeps its hit and miss counters for later calls.
+ *
+ * @param ifindex Inverted file index
+ * @param mined Co-occurring sets
+ * @param stop Minimum number of items in co-occurring sets
+ * @param hits Minimum number of hits of co-occurring set
+ * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
+ * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
+ * @param cache Cache of query results of the inverted file or NULL
+ */
+void sampledmh_prune_cached(ListDB *ifindex, ListDB *mined, uint stop, uint hits, double ovr,
+                            double cooc, IFCache *cache)
+{
+     // query inverted file with mined sets, only their posting lists are paged in
+     listdb_advise(ifindex, LISTDB_ACCESS_RANDOM);
+
+     SMHPruneIndex index;
+     memset(&index, 0, sizeof(SMHPruneIndex));
+     index.index = ifindex;
+     index.dim = ifindex->dim;
+     ifindex_skips_open(&index.skips, ifindex);
+     index.cache = cache;
+     index.query_batch = sampledmh_query_lists;
+     index.cooccurrences = sampledmh_cooccurrences_lists;
+     sampledmh_prune_index(&index, mined, stop, hits, ovr, cooc);
+}
+
+/**
+ * @brief Answers a batch of queries to the partitions of an inverted file
+ *        index
+ *
+ * @param index Partitions of the inverted file index
+ * @param queries Batch of queries
+ * @param min_hits Minimum number of hits of the documents of each query
+ * @param results Lists where the results are stored
+ */
+static void sampledmh_query_partitions(SMHPruneIndex *index, ListDB *queries, uint *min_hits,
+                                       ListDB *results)
+{
+     ifindex_partitions_query_batch((IFPartitions *) index->index, queries, min_hits, results);
+}
+
+/**
+ * @brief Splits the retrieved documents of a set by partition
+ *
+ * @param index Partitions of the inverted file index
+ * @param retdoc Retrieved documents
+ *
+ * @return Local ids of the retrieved documents of each partition
+ */
+static void *sampledmh_split_partitions(SMHPruneIndex *index, List *retdoc)
+{
+     IFPartitions *partitions = (IFPartitions *) index->index;
+     List *local = (List *) malloc(partitions->size * sizeof(List));
+     ifindex_partitions_split(partitions, retdoc, local);
+
+     return local;
+}
+
+/**
+ * @brief Counts the retrieved documents that contain an item adding up
+ *        the co-occurrences over the partitions
+ *
+ * @param index Partitions of the inverted file index
+ * @param state Local ids of the retrieved documents of each partition
+ * @param item Item
+ * @param retdoc Retrieved documents
+ *
+ * @return Number of retrieved documents that contain the item
+ */
+static uint sampledmh_cooccurrences_partitions(SMHPruneIndex *index, void *state, uint item,
+                                               List *retdoc)
+{
+     return ifindex_partitions_intersection_size((IFPartitions *) index->index, item,
+                                                 (List *) state);
+}
+
+/**
+ * @brief Destroys the retrieved documents split by partition
+ *
+ * @param index Partitions of the inverted file index
+ * @param state Local ids of the retrieved documents of each partition
+ */
+static void sampledmh_release_partitions(SMHPruneIndex *index, void *state)
+{
+     uint p;
+     IFPartitions *partitions = (IFPartitions *) index->index;
+     List *local = (List *) state;
+     for (p = 0; p < partitions->size; p++)
+          list_destroy(&local[p]);
+     free(local);
+}
+
+/**
+ * @brief Prunes co-occurring sets using the partitions of an inverted
+ *        file index (see sampledmh_prune). Each set is queried on every
+ *        partition and the co-occurrences of its items are added up over
+ *        the partitions.
+ *
+ * @param partitions Partitions of the inverted file index
+ * @param mined Co-occurring sets
+ * @param stop Minimum number of items in co-occurring sets
+ * @param hits Minimum number of hits of co-occurring set
+ * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
+ * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
+ */
+void sampledmh_prune_partitioned(IFPartitions *partitions, ListDB *mined, uint stop, uint hits,
+                                 double ovr, double cooc)
+{
+     uint p;
+     for (p = 0; p < partitions->size; p++)
+          listdb_advise(&partitions->parts[p], LISTDB_ACCESS_RANDOM);
+
+     SMHPruneIndex index;
+     memset(&index, 0, sizeof(SMHPruneIndex));
+     index.index = partitions;
+     index.dim = partitions->dim;
+     index.query_batch = sampledmh_query_partitions;
+     index.prepare = sampledmh_split_partitions;
+     index.cooccurrences = sampledmh_cooccurrences_partitions;
+     index.release = sampledmh_release_partitions;
+     sampledmh_prune_index(&index, mined, stop, hits, ovr, cooc);
+}
+
+/**
+ * @brief Queries a compressed inverted file index with an accumulator
+ *
+ * @param index Compressed inverted file index
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param acc Accumulator of the thread
+ *
+ * @return Retrieved documents sorted by item
+ */
+static List sampledmh_query_compressed(SMHPruneIndex *index, List *query, uint min_hits,
+                                       IFAccumulator *acc)
+{
+     return ifindex_query_compressed_threshold((CListDB *) index->index, query, min_hits, acc);
+}
+
+/**
+ * @brief Counts the retrieved documents that contain an item using a
+ *        compressed inverted file index
+ *
+ * @param index Compressed inverted file index
+ * @param state Unused
+ * @param item Item
+ * @param retdoc Retrieved documents
+ *
+ * @return Number of retrieved documents that contain the item
+ */
+static uint sampledmh_cooccurrences_compressed(SMHPruneIndex *index, void *state, uint item,
+                                               List *retdoc)
+{
+     CListDB *ifindex = (CListDB *) index->index;
+
+     return clist_intersection_size_list(&ifindex->lists[item], retdoc);
+}
+
+/**
+ * @brief Prunes co-occurring sets using a compressed inverted file index.
+ *        Posting lists are decoded on the fly while they are traversed.
+ *
+ * @param ifindex Compressed inverted file index
+ * @param mined Co-occurring sets
+ * @param stop Minimum number of items in co-occurring sets
+ * @param hits Minimum number of hits of co-occurring set
+ * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
+ * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
+ */
+void sampledmh_prune_compressed(CListDB *ifindex, ListDB *mined, uint stop, uint hits,
+                                double ovr, double cooc)
+{
+     SMHPruneIndex index;
+     memset(&index, 0, sizeof(SMHPruneIndex));
+     index.index = ifindex;
+     index.dim = ifindex->dim;
+     index.query = sampledmh_query_compressed;
+     index.cooccurrences = sampledmh_cooccurrences_compressed;
+     sampledmh_prune_index(&index, mined, stop, hits, ovr, cooc);
+}
+
+/**
+ * @brief Queries an inverted file index of roaring bitmaps with an
+ *        accumulator
+ *
+ * @param index Inverted file index of roaring bitmaps
+ * @param query Query list
+ * @param min_hits Minimum number of hits of a retrieved document
+ * @param acc Accumulator of the thread
+ *
+ * @return Retrieved documents sorted by item
+ */
+static List sampledmh_query_roaring(SMHPruneIndex *index, List *query, uint min_hits,
+                                    IFAccumulator *acc)
+{
+     return ifindex_query_roaring_threshold((RoaringDB *) index->index, query, min_hits, acc);
+}
+
+/**
+ * @brief Converts the retrieved documents of a set to a roaring bitmap
+ *
+ * @param index Inverted file index of roaring bitmaps
+ * @param retdoc Retrieved documents
+ *
+ * @return Roaring bitmap of the retrieved documents
+ */
+static void *sampledmh_bitmap_roaring(SMHPruneIndex *index, List *retdoc)
+{
+     Roaring *retbitmap = (Roaring *) malloc(sizeof(Roaring));
+     *retbitmap = roaring_from_list(retdoc);
+
+     return retbitmap;
+}
+
+/**
+ * @brief Counts the retrieved documents that contain an item using an
+ *        inverted file index of roaring bitmaps
+ *
+ * @param index Inverted file index of roaring bitmaps
+ * @param state Roaring bitmap of the retrieved documents
+ * @param item Item
+ * @param retdoc Retrieved documents
+ *
+ * @return Number of retrieved documents that contain the item
+ */
+static uint sampledmh_cooccurrences_roaring(SMHPruneIndex *index, void *state, uint item,
+                                            List *retdoc)
+{
+     RoaringDB *ifindex = (RoaringDB *) index->index;
+
+     return roaring_and_cardinality(&ifindex->bitmaps[item], (Roaring *) state);
+}
+
+/**
+ * @brief Destroys the roaring bitmap of the retrieved documents
+ *
+ * @param index Inverted file index of roaring bitmaps
+ * @param state Roaring bitmap of the retrieved documents
+ */
+static void sampledmh_release_roaring(SMHPruneIndex *index, void *state)
+{
+     roaring_destroy((Roaring *) state);
+     free(state);
+}
+
+/**
+ * @brief Prunes co-occurring sets using an inverted file index whose rows
+ *        are roaring bitmaps.
+ *
+ * @param ifindex Inverted file index of roaring bitmaps
+ * @param mined Co-occurring sets
+ * @param stop Minimum number of items in co-occurring sets
+ * @param hits Minimum number of hits of co-occurring set
+ * @param ovr Minimum overlap between a co-occurring set and a document to retrieve it
+ * @param coocc Minimum overlap between list of retrieved documents and item entry in inverted file
+ */
+void sampledmh_prune_roaring(RoaringDB *ifindex, ListDB *mined, uint stop, uint hits,
+                             double ovr, double cooc)
+{
+     SMHPruneIndex index;
+     memset(&index, 0, sizeof(SMHPruneIndex));
+     index.index = ifindex;
+     index.dim = ifindex->dim;
+     index.query = sampledmh_query_roaring;
+     index.prepare = sampledmh_bitmap_roaring;
+     index.cooccurrences = sampledmh_cooccurrences_roaring;
+     index.release = sampledmh_release_roaring;
+     sampledmh_prune_index(&index, mined, stop, hits, ovr, cooc);
+}
@@ -0,0 +1,506 @@
+/**
+ * @file sets.c
+ * @author Gibran Fuentes Pineda <gibranfp@turing.iimas.unam.mx>
+ * @date 2015
+ *
+ * @section GPL
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * http://www.gnu.org/copyleft/gpl.html
+ *
+ * @brief Operations on sets and databases of sets.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sets.h"
+
+/**
+ * @brief Initializes a set structure to zero
+ *
+ * @param set Set to initialize
+ */
+void set_init(Set *set)
+{
+     set->size = 0;
+     set->data = NULL;
+}
+
+/**
+ * @brief Destroys a set
+ *
+ * @param set Set to be destroyed
+ */
+void set_destroy(Set *set)
+{
+     free(set->data);
+     set_init(set);
+}
+
+/**
+ * @brief Adds an item to the end of a set
+ *
+ * @param set Set where the item will be added
+ * @param item Item to be added
+ */
+void set_push(Set *set, uint item)
+{
+     uint newsize = set->size + 1;
+
+     set->data = realloc(set->data, newsize * sizeof(uint));
+     set->data[set->size] = item;
+     set->size = newsize;
+}
+
+/**
+ * @brief Prints in screen the items of a set
+ *
+ * @param set Set to be printed
+ */
+void set_print(Set *set)
+{
+     uint i;
+
+     printf ("%d -- ", set->size);
+     for (i = 0; i < set->size; i++)
+          printf ("%d[%d] ", set->data[i], i);
+     printf("\n");
+}
+
+/**
+ * @brief Creates a set from the items of a list. Frequencies are dropped.
+ *
+ * @param list List (sorted by item)
+ *
+ * @return Set with the items of the list
+ */
+Set set_from_list(List *list)
+{
+     uint i;
+     Set set;
+     set.size = list->size;
+     set.data = (uint *) malloc(list->size * sizeof(uint));
+     for (i = 0; i < list->size; i++)
+          set.data[i] = list->data[i].item;
+
+     return set;
+}
+
+/**
+ * @brief Creates a list from the items of a set with frequencies equal to 1
+ *
+ * @param set Set
+ *
+ * @return List with the items of the set
+ */
+List set_to_list(Set *set)
+{
+     uint i;
+     List list = list_create(set->size);
+     for (i = 0; i < set->size; i++) {
+          list.data[i].item = set->data[i];
+          list.data[i].freq = 1;
+     }
+
+     return list;
+}
+
+/**
+ * @brief Computes the size of the intersection of a pair of sets
+ *
+ * @param set1 First set
+ * @param set2 Second set
+ *
+ * @return Size of the intersection
+ */
+uint set_intersection_size(Set *set1, Set *set2)
+{
+     uint i = 0, j = 0;
+     uint intersection_size = 0;
+
+     while (i < set1->size && j < set2->size) {
+          if (set1->data[i] == set2->data[j]) {
+               intersection_size++;
+               i++;
+               j++;
+          } else if (set1->data[i] < set2->data[j]) {
+               i++;
+          } else {
+               j++;
+          }
+     }
+
+     return intersection_size;
+}
+
+/**
+ * @brief Computes the jaccard similarity coefficient of a pair of sets.
+ *
+ * @param set1 First set
+ * @param set2 Second set
+ *
+ * @return Jaccard similarity coefficient between sets
+ */
+double set_jaccard(Set *set1, Set *set2)
+{
+     if (set1->size > 0 && set2->size > 0){
+          uint intersection_size = set_intersection_size(set1, set2);
+          uint union_size = (set1->size + set2->size) - intersection_size;
+          return (double) intersection_size / (double) union_size;
+     } else {
+          return 0.0;
+     }
+}
+
+/**
+ * @brief Computes the overlap coefficient of a pair of sets.
+ *
+ * @param set1 First set
+ * @param set2 Second set
+ *
+ * @return Overlap coefficient between sets
+ */
+double set_overlap(Set *set1, Set *set2)
+{
+     if (set1->size > 0 && set2->size > 0){
+          uint intersection_size = set_intersection_size(set1, set2);
+          uint min_size = min(set1->size, set2->size);
+          return (double) intersection_size / min_size;
+     } else {
+          return 0.0;
+     }
+}
+
+/**
+ * @brief Checks if the similarity of a pair of sets is greater than a
+ *        threshold. The intersection stops as soon as the threshold is
+ *        reached or can no longer be reached.
+ *
+ * @param set1 First set
+ * @param set2 Second set
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ * @param thres Similarity threshold
+ *
+ * @return 1 if the similarity is greater than the threshold, 0 otherwise
+ */
+int set_similarity_above(Set *set1, Set *set2, int measure, double thres)
+{
+     uint needed = list_min_intersection_size(set1->size, set2->size, measure, thres);
+     uint bound = min(set1->size, set2->size);
+     if (needed > bound)
+          return 0;
+     if (needed == 0)
+          return 1;
+
+     uint i = 0, j = 0;
+     uint intersection_size = 0;
+     while (i < set1->size && j < set2->size) {
+          if (set1->data[i] == set2->data[j]) {
+               intersection_size++;
+               if (intersection_size >= needed)
+                    return 1;
+               i++;
+               j++;
+          } else {
+               if (set1->data[i] < set2->data[j])
+                    i++;
+               else
+                    j++;
+
+               // stop if the remaining items can not reach the threshold
+               uint left1 = set1->size - i;
+               uint left2 = set2->size - j;
+               uint left = min(left1, left2);
+               if (intersection_size + left < needed)
+                    return 0;
+          }
+     }
+
+     return 0;
+}
+
+/**
+ * @brief Initializes a database of sets to zero
+ *
+ * @param setdb Database of sets to initialize
+ */
+void setdb_init(SetDB *setdb)
+{
+     setdb->size = 0;
+     setdb->dim = 0;
+     setdb->sets = NULL;
+}
+
+/**
+ * @brief Creates a database of a given size with empty sets
+ *
+ * @param size Size of the database to create
+ * @param dim Largest item value plus one
+ *
+ * @return Created database
+ */
+SetDB setdb_create(uint size, uint dim)
+{
+     SetDB setdb;
+     setdb.size = size;
+     setdb.dim = dim;
+     setdb.sets = (Set *) calloc(size, sizeof(Set));
+
+     return setdb;
+}
+
+/**
+ * @brief Destroys a database of sets
+ *
+ * @param setdb Database of sets to be destroyed
+ */
+void setdb_destroy(SetDB *setdb)
+{
+     uint i;
+     for (i = 0; i < setdb->size; i++)
+          set_destroy(&setdb->sets[i]);
+
+     free(setdb->sets);
+     setdb_init(setdb);
+}
+
+/**
+ * @brief Prints a database of sets
+ *
+ * @param setdb Database to be printed
+ */
+void setdb_print(SetDB *setdb)
+{
+     uint i;
+     for (i = 0; i < setdb->size; i++) {
+          printf("[  %d  ] ", i);
+          set_print(&setdb->sets[i]);
+     }
+}
+
+/**
+ * @brief Adds a set to the end of a database
+ *
+ * @param setdb Database where the set will be added
+ * @param set Set to be added
+ */
+void setdb_push(SetDB *setdb, Set *set)
+{
+     uint newsize = setdb->size + 1;
+     setdb->sets = realloc(setdb->sets, newsize * sizeof(Set));
+     setdb->sets[setdb->size] = *set;
+     setdb->size = newsize;
+}
+
+/**
+ * @brief Set size comparison for qsort in descending order.
+ *
+ * @param a First set to compare
+ * @param b Second set to compare
+ *
+ * @return 0 if the sets are equal, positive if the second set
+ *         is greater than the first and negative otherwise.
+ */
+static int setdb_size_compare_back(const void *a, const void *b)
+{
+     int a_size = ((Set *)a)->size;
+     int b_size = ((Set *)b)->size;
+
+     return b_size - a_size;
+}
+
+/**
+ * @brief Sorts a database of sets based on their size in descending order
+ *
+ * @param setdb Database to be sorted
+ */
+void setdb_sort_by_size_back(SetDB *setdb)
+{
+     qsort(setdb->sets, setdb->size, sizeof(Set), setdb_size_compare_back);
+}
+
+/**
+ * @brief Deletes sets smaller than a given size
+ *
+ * @param setdb Database where the sets will be deleted
+ * @param min_size Minimum size
+ */
+void setdb_delete_smallest(SetDB *setdb, uint min_size)
+{
+     uint pos;
+
+     setdb_sort_by_size_back(setdb);
+     for (pos = 0; pos < setdb->size; pos++)
+          if (setdb->sets[pos].size < min_size)
+               break;
+
+     if (pos < setdb->size) {
+          uint i;
+          for (i = pos; i < setdb->size; i++)
+               set_destroy(&setdb->sets[i]);
+
+          setdb->size = pos;
+          setdb->sets = realloc(setdb->sets, setdb->size * sizeof(Set));
+     }
+}
+
+/**
+ * @brief Creates a database of sets from a database of lists
+ *
+ * @param listdb Database of lists (sorted by item)
+ *
+ * @return Database of sets
+ */
+SetDB setdb_from_listdb(ListDB *listdb)
+{
+     uint i;
+     SetDB setdb = setdb_create(listdb->size, listdb->dim);
+     for (i = 0; i < listdb->size; i++)
+          setdb.sets[i] = set_from_list(&listdb->lists[i]);
+
+     return setdb;
+}
+
+/**
+ * @brief Creates a database of lists with frequencies equal to 1 from
+ *        a database of sets
+ *
+ * @param setdb Database of sets
+ *
+ * @return Database of lists
+ */
+ListDB setdb_to_listdb(SetDB *setdb)
+{
+     uint i;
+     ListDB listdb = listdb_create(setdb->size, setdb->dim);
+     for (i = 0; i < setdb->size; i++)
+          listdb.lists[i] = set_to_list(&setdb->sets[i]);
+
+     return listdb;
+}
+
+/**
+ * @brief Checks in a single pass which candidate sets of a database have
+ *        a similarity to a query set greater than a threshold.
+ *
+ * @param setdb Database of sets
+ * @param query Query set
+ * @param candidates IDs of the candidate sets in the database
+ * @param measure Similarity measure (LIST_JACCARD or LIST_OVERLAP)
+ * @param thres Similarity threshold
+ * @param passed Bitmap of (candidates->size + 63) / 64 words where bit i
+ *               is set if the i-th candidate passes the threshold
+ */
+void setdb_similarity_batch(SetDB *setdb, Set *query, List *candidates, int measure,
+                            double thres, ullong *passed)
+{
+     uint i;
+     memset(passed, 0, ((candidates->size + 63) / 64) * sizeof(ullong));
+     for (i = 0; i < candidates->size; i++)
+          if (set_similarity_above(query, &setdb->sets[candidates->data[i].item], measure, thres))
+               passed[i / 64] |= 1ULL << (i % 64);
+}
+
+/**
+ * @brief Saves a database of sets in the same format as a database of
+ *        lists, with frequencies equal to 1, so it can be read with
+ *        listdb_load_from_file.
+ *
+ * @param filename File where the sets will be saved
+ * @param setdb Database of sets
+ */
+void setdb_save_to_file(char *filename, SetDB *setdb)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"w"))) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     uint i, j;
+     for (i = 0; i < setdb->size; i++) {
+          fprintf(file,"%u", setdb->sets[i].size);
+          for (j = 0; j < setdb->sets[i].size; j++)
+               fprintf(file," %u:1", setdb->sets[i].data[j]);
+          fprintf(file,"\n");
+     }
+
+     if (fclose(file)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Saves a database of sets in the binary list database format
+ *        without frequencies, which takes half the space of a list
+ *        database. It can be loaded with listdb_open_mmap.
+ *
+ * @param filename File where the sets will be saved
+ * @param setdb Database of sets
+ */
+void setdb_save_binary(char *filename, SetDB *setdb)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"wb"))) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     uint i;
+     ListDBHeader header;
+     memset(&header, 0, sizeof(ListDBHeader));
+     memcpy(header.magic, LISTDB_MAGIC, sizeof(header.magic));
+     header.version = LISTDB_VERSION;
+     header.flags = 0;
+     header.size = setdb->size;
+     header.dim = setdb->dim;
+     for (i = 0; i < setdb->size; i++)
+          header.number_of_items += setdb->sets[i].size;
+
+     ullong *offsets = (ullong *) malloc((setdb->size + 1) * sizeof(ullong));
+     offsets[0] = 0;
+     for (i = 0; i < setdb->size; i++)
+          offsets[i + 1] = offsets[i] + setdb->sets[i].size;
+
+     int failed = fwrite(&header, sizeof(ListDBHeader), 1, file) != 1 ||
+          fwrite(offsets, sizeof(ullong), setdb->size + 1, file) != setdb->size + 1;
+     for (i = 0; !failed && i < setdb->size; i++)
+          failed = fwrite(setdb->sets[i].data, sizeof(uint), setdb->sets[i].size, file) !=
+               setdb->sets[i].size;
+     free(offsets);
+
+     if (failed) {
+          fprintf(stderr,"Error: Could not write file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     if (fclose(file)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Computes the memory used by a database of sets
+ *
+ * @param setdb Database of sets
+ *
+ * @return Number of bytes
+ */
+size_t setdb_memory(SetDB *setdb)
+{
+     uint i;
+     size_t bytes = setdb->size * sizeof(Set);
+     for (i = 0; i < setdb->size; i++)
+          bytes += setdb->sets[i].size * sizeof(uint);
+
+     return bytes;
+}
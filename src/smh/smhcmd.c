@@ -30,8 +30,30 @@
 #include "sampledmh.h"
 #include "mhlink.h"
 
+#ifdef HAVE_ZLIB
+#define SMHCMD_CONTAINER_FLAGS CLISTDB_ZLIB
+#else
+#define SMHCMD_CONTAINER_FLAGS 0
+#endif
+
 enum WeightScheme {TF, LOGTF, BINTF, IDF, IDS, TFIDF, TFIDS};
 
+/**
+ * @brief Loads a list database from a text file, a binary list database,
+ *        a manifest of shards or a compressed list container.
+ *
+ * @param filename Name of the file
+ *
+ * @return List database
+ */
+ListDB smhcmd_load(char *filename)
+{
+     if (clistdb_is_container(filename))
+          return clistdb_load(filename);
+
+     return listdb_load(filename);
+}
+
 /**
  * @brief Prints help in screen.
  */
@@ -39,12 +61,32 @@ void usage(void)
 {
      printf("usage: smhcmd ifindex [OPTIONS]... [INPUT_FILE] [OUTPUT_FILE]\n"
             "       smhcmd weights [OPTIONS]... [CORPUS_FILE] [INVERTED_FILE] [WEIGHTS_FILE]\n"
+            "       smhcmd weights [OPTIONS]... [STATS_FILE] [WEIGHTS_FILE]\n"
             "       smhcmd discover [OPTIONS]... [INPUT_FILE] [OUTPUT_FILE]\n"
-            "Creates inverted file structure from corpus, computes weights and discovers patterns\n\n"
+            "       smhcmd query [OPTIONS]... [INVERTED_FILE] [QUERIES_FILE] [OUTPUT_FILE]\n"
+            "       smhcmd stats [CORPUS_FILE] [STATS_FILE]\n"
+            "Creates inverted file structure from corpus, computes weights, discovers patterns,\n"
+            "retrieves the top scored documents of queries and saves corpus statistics\n"
+            "(document lengths and frequencies of the terms) used instead of the corpus\n"
+            "and its inverted file to compute weights and expand frequencies\n"
+            "Input files can be text or binary list databases or manifests of shards\n"
+            "(the format is detected); query reads manifests of inverted file partitions\n"
+            "discover also reads compressed list containers\n\n"
             "General options:\n"
             "   --help\t\tPrints this help\n"
+            "ifindex options:\n"
+            "   -b, --binary\t Saves the inverted file as a binary list database with skip pointers\n"
+            "   -Z, --container\t Saves the inverted file as a compressed list container\n"
+            "   -a, --append\t Adds the documents of INPUT_FILE to the inverted file OUTPUT_FILE,\n"
+            "               \t which is updated in its own format\n"
+            "   -d, --offset[=number of documents]\t Id of the first appended document\n"
+            "                                     \t (required to append to a text inverted file)\n"
+            "   -p, --partitions[=1]\t Splits the inverted file into partitions of consecutive\n"
+            "                       \t documents (one per shard for manifests), saved next to\n"
+            "                       \t OUTPUT_FILE, which lists them as a manifest\n"
             "weights options:\n"
             "   -w, --weight[=idf]\tWeighting scheme to use\n"
+            "   -b, --binary\t Saves the weights in binary format (checked against the corpus)\n"
             "discover options:\n"
             "   -r, --tuple_size[=4]\tNumber of hashes per tuple in mining phase\n"
             "   -l, --number_of_tuples[=500]\tNumber of tuples in mining phase\n"
@@ -57,8 +99,104 @@ void usage(void)
             "                                       table (power of 2) in clustering phase\n"
             "   -o, --overlap[=0.7]\tOverlap threshold for clustering phase\n"
             "   -c, --min_cluster_size[=3]\t Minimum size of cluster to consider as meaningful\n"
-            "   -e, --expand[=NULL]\t Corpus file used to consider frequencies\n"
-            "   -w, --weights[=NULL]\t Weights file used to consider item weights \n");
+            "   -e, --expand[=NULL]\t Inverted file or statistics used to consider frequencies\n"
+            "   -w, --weights[=NULL]\t Weights file (text or binary) used to consider item weights \n"
+            "   -k, --compress\t Keeps mined sets compressed during clustering\n"
+            "   -m, --stream\t Reads the input in batches instead of loading it (not with --expand)\n"
+            "   -b, --binary\t Saves the models as a binary list database\n"
+            "   -Z, --container\t Saves the models as a compressed list container\n"
+            "query options:\n"
+            "   -k, --top[=10]\t Number of documents retrieved for each query\n"
+            "   -w, --weights[=NULL]\t Weights file (text or binary) of the items\n"
+            "   -c, --cache[=64]\t Megabytes of results kept for repeated queries (0 disables it)\n"
+            "Each line of the query output has the number of retrieved documents followed\n"
+            "by document:score pairs sorted by decreasing score\n");
+}
+
+/**
+ * @brief Creates the partitions of an inverted file from a corpus file,
+ *        or one partition per shard of a manifest.
+ *
+ * @param input Corpus file or manifest of shards
+ * @param output Manifest of the partitions
+ * @param number_of_partitions Number of partitions of a corpus file
+ * @param binary 1 to save the partitions as binary list databases
+ */
+void smhcmd_ifindex_partitions(char *input, char *output, uint number_of_partitions, uint binary)
+{
+     IFPartitions partitions;
+     if (listdb_is_manifest(input)) {
+          printf("Creating an inverted file partition for each shard in %s . . .\n", input);
+          ListDBManifest manifest = listdb_manifest_load(input);
+          partitions = ifindex_partitions_from_manifest(&manifest);
+          listdb_manifest_destroy(&manifest);
+     } else {
+          printf("Creating %u inverted file partitions from corpus file %s . . .\n",
+                 number_of_partitions, input);
+          ListDB corpus = listdb_load(input);
+          partitions = ifindex_partitions_make(&corpus, number_of_partitions);
+          listdb_destroy(&corpus);
+     }
+     printf("Number of documents: %d\nVocabulary size: %d\nNumber of partitions: %d\n",
+            partitions.dim, partitions.vocsize, partitions.size);
+
+     printf("Saving inverted file partitions listed in %s\n", output);
+     ifindex_partitions_save(output, &partitions, binary);
+     ifindex_partitions_destroy(&partitions);
+}
+
+/**
+ * @brief Adds the documents of a corpus to an existing inverted file. The
+ *        updated index is written next to the old one and then renamed,
+ *        so the file is replaced at once and keeps its format. Binary
+ *        files and containers store the number of documents, but a text
+ *        file only tells the largest document id with postings, so the
+ *        offset must be given for it.
+ *
+ * @param input Corpus file with the new documents
+ * @param output Inverted file to update
+ * @param offset Id of the first new document or -1 for the number of
+ *        documents of the inverted file
+ */
+void smhcmd_ifindex_append(char *input, char *output, long offset)
+{
+     printf("Loading inverted file %s . . .\n", output);
+     int binary = listdb_is_binary(output);
+     int container = clistdb_is_container(output);
+     if (offset < 0 && !binary && !container) {
+          fprintf(stderr,"Error: The number of documents of text inverted file %s is "
+                  "unknown (trailing empty documents are not stored). Give the id of "
+                  "the first new document with --offset\n", output);
+          exit(EXIT_FAILURE);
+     }
+     ListDB ifindex = smhcmd_load(output);
+     printf("Number of documents: %d\nVocabulary size: %d\n", ifindex.dim, ifindex.size);
+
+     printf("Appending documents from corpus file %s . . .\n", input);
+     ListDB corpus = listdb_load(input);
+     ifindex_append(&ifindex, &corpus, offset < 0 ? ifindex.dim : (uint) offset);
+     listdb_destroy(&corpus);
+     printf("Number of documents: %d\nVocabulary size: %d\n", ifindex.dim, ifindex.size);
+
+     char *temporary = (char *) malloc(strlen(output) + 5);
+     sprintf(temporary, "%s.tmp", output);
+     printf("Saving inverted file into %s\n", output);
+     if (container)
+          clistdb_save(temporary, &ifindex, SMHCMD_CONTAINER_FLAGS);
+     else if (binary)
+          ifindex_save(temporary, &ifindex);
+     else
+          listdb_save_to_file(temporary, &ifindex);
+     listdb_destroy(&ifindex);
+
+     if (rename(temporary, output) != 0) {
+          fprintf(stderr,"Error: Could not replace file %s\n", output);
+          exit(EXIT_FAILURE);
+     }
+     free(temporary);
+
+     fprintf(stderr,"Warning: Weights and statistics computed before appending to %s "
+             "are stale. Recompute them with smhcmd weights and smhcmd stats\n", output);
 }
 
 /**
@@ -70,22 +208,54 @@ void usage(void)
 void smhcmd_ifindex(int opnum, char **opts)
 {
      char *input, *output;     
+     uint binary = 0;
+     uint container = 0;
+     uint append = 0;
+     uint partitions = 0;
+     long offset = -1;
      int op;
      int option_index = 0;
      
      static struct option long_options[] =
           {
                {"help", no_argument, 0, 'h'},
+               {"binary", no_argument, 0, 'b'},
+               {"container", no_argument, 0, 'Z'},
+               {"append", no_argument, 0, 'a'},
+               {"offset", required_argument, 0, 'd'},
+               {"partitions", required_argument, 0, 'p'},
                {0, 0, 0, 0}
           };
 
      //Command-line option parser
-     while((op = getopt_long( opnum, opts, "h", long_options, 
+     while((op = getopt_long( opnum, opts, "hbZad:p:", long_options, 
                               &option_index)) != -1){
-          int this_option_optind = optind ? optind : 1;
           switch (op) {
           case 0:
                break;
+          case 'b':
+               binary = 1;
+               break;
+          case 'Z':
+               container = 1;
+               break;
+          case 'a':
+               append = 1;
+               break;
+          case 'd':
+               offset = atol(optarg);
+               if (offset < 0) {
+                    fprintf(stderr,"Error: The offset must be non-negative.\n");
+                    exit(EXIT_FAILURE);
+               }
+               break;
+          case 'p':
+               partitions = atoi(optarg);
+               if (partitions == 0) {
+                    fprintf(stderr,"Error: The number of partitions must be positive.\n");
+                    exit(EXIT_FAILURE);
+               }
+               break;
           case 'h':
                usage();
                exit(EXIT_SUCCESS);
@@ -98,19 +268,44 @@ void smhcmd_ifindex(int opnum, char **opts)
                abort ();
           }
      }
-     if (optind + 2 == opnum){ 
+     if (partitions > 0 && (append || container)) {
+          fprintf(stderr,"Error: Partitions can not be appended to or saved as containers.\n");
+          exit(EXIT_FAILURE);
+     }
+     if (partitions > 0 && optind + 2 == opnum) {
+          input = opts[optind++];
+          output = opts[optind++];
+          smhcmd_ifindex_partitions(input, output, partitions, binary);
+     } else if (append && optind + 2 == opnum) {
+          input = opts[optind++];
+          output = opts[optind++];
+          smhcmd_ifindex_append(input, output, offset);
+     } else if (optind + 2 == opnum){ 
           input = opts[optind++];
           output = opts[optind++];
 
-          printf("Reading corpus file %s . . .\n", input);
-          ListDB corpus = listdb_load_from_file(input);
-          printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, corpus.dim);
-
-          printf("Creating inverted file . . .\n");
-          ListDB ifindex = ifindex_make_from_corpus(&corpus);
+          ListDB ifindex;
+          if (listdb_is_manifest(input)) {
+               printf("Creating inverted file from the shards in %s . . .\n", input);
+               ListDBManifest manifest = listdb_manifest_load(input);
+               ifindex = ifindex_make_from_manifest(&manifest);
+               listdb_manifest_destroy(&manifest);
+          } else {
+               printf("Creating inverted file from corpus file %s . . .\n", input);
+               ListDBReader reader;
+               listdb_reader_open(&reader, input, LISTDB_BATCH_ITEMS);
+               ifindex = ifindex_make_from_reader(&reader);
+               listdb_reader_close(&reader);
+          }
+          printf("Number of documents: %d\nVocabulary size: %d\n", ifindex.dim, ifindex.size);
 
           printf("Saving inverted file into %s\n",output);
-          listdb_save_to_file(output, &ifindex);
+          if (container)
+               clistdb_save(output, &ifindex, SMHCMD_CONTAINER_FLAGS);
+          else if (binary)
+               ifindex_save(output, &ifindex);
+          else
+               listdb_save_to_file(output, &ifindex);
      } else {
           if (optind + 2 > opnum)
                fprintf(stderr, "Error: Missing arguments.\n"
@@ -122,6 +317,52 @@ void smhcmd_ifindex(int opnum, char **opts)
      }
 }
 
+/**
+ * @brief Computes weights from the statistics of a corpus
+ *
+ * @param stats_path Corpus statistics file
+ * @param output Weights file
+ * @param weight_scheme Weighting scheme (idf or ids)
+ * @param binary 1 to save the weights in binary format
+ */
+void smhcmd_weights_from_stats(char *stats_path, char *output, char *weight_scheme, uint binary)
+{
+     StatsFile stats;
+     weights_stats_open(&stats, stats_path);
+     uint number_of_docs = stats.header->number_of_docs;
+     uint number_of_terms = stats.header->number_of_terms;
+     printf("Computing %s weights from %s\n", weight_scheme, stats_path);
+     printf("Number of documents: %d\nVocabulary size: %d\n", number_of_docs, number_of_terms);
+
+     double *weights;
+     uint size, scheme;
+     ullong fingerprint;
+     if ( strcmp(weight_scheme, "idf") == 0 ) {
+          weights = weights_from_stats(&stats, weights_idf);
+          size = number_of_terms;
+          scheme = WEIGHTS_IDF;
+          fingerprint = weights_fingerprint(stats.docterms, number_of_docs);
+     } else if ( strcmp(weight_scheme, "ids") == 0 ) {
+          weights = weights_documents_from_stats(&stats, weights_ids);
+          size = number_of_docs;
+          scheme = WEIGHTS_IDS;
+          fingerprint = weights_fingerprint(stats.df, number_of_terms);
+     } else {
+          printf ("Unrecognized weighting scheme %s.\n "
+                  "Try `smhcmd --help' for more information.\n", 
+                  weight_scheme);
+          exit(EXIT_FAILURE);
+     }
+
+     printf("Saving weights into %s\n", output);
+     if (binary)
+          weights_save_binary(output, size, weights, scheme, fingerprint);
+     else
+          weights_save_to_file(output, size, weights);
+     free(weights);
+     weights_stats_close(&stats);
+}
+
 /**
  * @brief Computes weights of the items in a database of lists
  *
@@ -132,6 +373,7 @@ void smhcmd_weights(int opnum, char **opts)
 {
      char *weight_scheme = "idf";
      char *corpus_path, *ifindex_path, *output;     
+     uint binary = 0;
      int op;
      int option_index = 0;
      
@@ -139,13 +381,13 @@ void smhcmd_weights(int opnum, char **opts)
           {
                {"help", no_argument, 0, 'h'},
                {"weight", required_argument, 0, 'w'},
+               {"binary", no_argument, 0, 'b'},
                {0, 0, 0, 0}
           };
 
      //Command-line option parser
-     while((op = getopt_long( opnum, opts, "hw:", long_options, 
+     while((op = getopt_long( opnum, opts, "hbw:", long_options, 
                               &option_index)) != -1){
-          int this_option_optind = optind ? optind : 1;
           switch (op) {
           case 0:
                break;
@@ -156,6 +398,9 @@ void smhcmd_weights(int opnum, char **opts)
           case 'w':
                weight_scheme = optarg;
                break;
+          case 'b':
+               binary = 1;
+               break;
           case '?':
                fprintf(stderr,"Error: Unknown options.\n"
                        "Try `smhcmd --help' for more information.\n");
@@ -164,37 +409,51 @@ void smhcmd_weights(int opnum, char **opts)
                abort ();
           }
      }
-     if (optind + 3 == opnum){ 
+     if (optind + 2 == opnum && weights_is_stats(opts[optind])) {
+          corpus_path = opts[optind++];
+          output = opts[optind++];
+          smhcmd_weights_from_stats(corpus_path, output, weight_scheme, binary);
+     } else if (optind + 3 == opnum){ 
           corpus_path= opts[optind++];
           ifindex_path = opts[optind++];
           output = opts[optind++];
 
-          printf("Reading corpus file %s . . .\n", corpus_path);
-          ListDB corpus = listdb_load_from_file(corpus_path);
-          printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, corpus.dim);
-
-          printf("Loading inverted file from file %s . . .\n", ifindex_path);
-          ListDB ifindex = listdb_load_from_file(ifindex_path);
+          // corpus and inverted file are read in batches
+          ListDBReader corpus, ifindex;
+          listdb_reader_open(&corpus, corpus_path, LISTDB_BATCH_ITEMS);
+          listdb_reader_open(&ifindex, ifindex_path, LISTDB_BATCH_ITEMS);
           double *weights;
-          printf("Computing %s weights\n", weight_scheme);
+          printf("Computing %s weights from %s and %s\n", weight_scheme, corpus_path, ifindex_path);
           if ( strcmp(weight_scheme, "idf") == 0 ) {
-               weights =  weights_from_corpus_and_ifindex(&corpus,
-                                                          &ifindex,
-                                                          weights_idf);
+               weights =  weights_from_readers(&corpus,
+                                               &ifindex,
+                                               weights_idf);
+               printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, ifindex.size);
                printf("Saving weights into %s\n", output);
-               weights_save_to_file(output, ifindex.size, weights);
+               if (binary)
+                    weights_save_binary(output, ifindex.size, weights, WEIGHTS_IDF,
+                                        weights_fingerprint_reader(&corpus));
+               else
+                    weights_save_to_file(output, ifindex.size, weights);
           } else if ( strcmp(weight_scheme, "ids") == 0 ) {
-               weights = weights_from_corpus_and_ifindex(&ifindex,
-                                                         &corpus,
-                                                         weights_ids);
+               weights = weights_from_readers(&ifindex,
+                                              &corpus,
+                                              weights_ids);
+               printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, ifindex.size);
                printf("Saving weights into %s\n", output);
-               weights_save_to_file(output, corpus.size, weights);
+               if (binary)
+                    weights_save_binary(output, corpus.size, weights, WEIGHTS_IDS,
+                                        weights_fingerprint_reader(&ifindex));
+               else
+                    weights_save_to_file(output, corpus.size, weights);
           } else {
                printf ("Unrecognized weighting scheme %s.\n "
                        "Try `smhcmd --help' for more information.\n", 
                        weight_scheme);
                exit(EXIT_FAILURE);
           }
+          listdb_reader_close(&corpus);
+          listdb_reader_close(&ifindex);
      } else {
           if (optind + 2 > opnum)
                fprintf(stderr, "Error: Missing arguments.\n"
@@ -224,6 +483,10 @@ void smhcmd_discover(int opnum, char **opts)
      double overlap = 0.7; 
      uint min_cluster_size = 3;
      unsigned long long seed = 12345678;
+     uint compress = 0;
+     uint stream = 0;
+     uint binary = 0;
+     uint container = 0;
      char *input, *output, *weights_file = NULL,  *ifindex_file = NULL;
      
      int op;
@@ -244,13 +507,16 @@ void smhcmd_discover(int opnum, char **opts)
                {"expand", required_argument, 0, 'e'},
                {"weights", required_argument, 0, 'w'},
                {"seed", required_argument, 0, 'a'},
+               {"compress", no_argument, 0, 'k'},
+               {"stream", no_argument, 0, 'm'},
+               {"binary", no_argument, 0, 'b'},
+               {"container", no_argument, 0, 'Z'},
                {0, 0, 0, 0}
           };
 
      //Command-line option parser
-     while((op = getopt_long( opnum, opts, "ha:r:l:t:s:x:y:z:o:c:e:w:", long_options, 
+     while((op = getopt_long( opnum, opts, "hkmbZa:r:l:t:s:x:y:z:o:c:e:w:", long_options, 
                               &option_index)) != -1){
-          int this_option_optind = optind ? optind : 1;
           switch (op)
           {
           case 0:
@@ -295,6 +561,18 @@ void smhcmd_discover(int opnum, char **opts)
           case 'a':
             seed = (unsigned long long) atoll(optarg);
                break;
+          case 'k':
+               compress = 1;
+               break;
+          case 'm':
+               stream = 1;
+               break;
+          case 'b':
+               binary = 1;
+               break;
+          case 'Z':
+               container = 1;
+               break;
           case '?':
                fprintf(stderr,"Error: Unknown options.\n"
                        "Try `smhcmd --help' for more information.\n");
@@ -308,69 +586,341 @@ void smhcmd_discover(int opnum, char **opts)
           input = opts[optind++];
           output = opts[optind++];
 
-          printf("Reading sets from %s . . .\n", input);
-          ListDB corpus = listdb_load_from_file(input);
-          printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, corpus.dim);
-          
-          ListDB mined;
+          double *weights = NULL;
+          WeightsFile mapped_weights = {NULL, NULL, 0};
           if (weights_file != NULL) {
                printf("Loading weights . . . ");
-               double *weights = weights_load_from_file(weights_file);
-               printf("Mining . . . ");
-               if (ifindex_file != NULL) {
-                    ListDB ifindex = listdb_load_from_file(ifindex_file);
-                    uint *maxfreq = mh_get_cumulative_frequency(&corpus, &ifindex);
-                    ListDB expanded_corpus = mh_expand_listdb(&corpus, maxfreq);
-                    mined = sampledmh_mine_weighted(&expanded_corpus,
-                                                    mine_tuple_size,
-                                                    mine_number_of_tuples,
-                                                    mine_table_size,
-                                                    weights,
-                                                    min_set_size);
+               if (weights_is_binary(weights_file)) {
+                    weights_open_mmap(&mapped_weights, weights_file);
+                    weights = mapped_weights.weights;
                } else {
-                    mined = sampledmh_mine_weighted(&corpus,
-                                                    mine_tuple_size,
-                                                    mine_number_of_tuples,
-                                                    mine_table_size,
-                                                    weights,
-                                                    min_set_size);
+                    weights = weights_load_from_file(weights_file);
                }
-          } else {
-               printf("Mining . . . ");
+          }
+
+          SetDB mined;
+          if (stream) {
                if (ifindex_file != NULL) {
-                    ListDB ifindex = listdb_load_from_file(ifindex_file);
+                    fprintf(stderr,"Error: --stream can not be used with --expand.\n"
+                            "Try `smhcmd --help' for more information.\n");
+                    exit(EXIT_FAILURE);
+               }
+
+               // the input is read once per MinHash tuple
+               ListDBReader reader;
+               listdb_reader_open(&reader, input, LISTDB_BATCH_ITEMS);
+               if (mapped_weights.header != NULL) {
+                    ullong fingerprint = weights_fingerprint_reader(&reader);
+                    weights_validate(&mapped_weights, fingerprint, reader.dim);
+               }
+               printf("Mining . . . ");
+               if (weights != NULL)
+                    mined = sampledmh_mine_weighted_reader(&reader,
+                                                           mine_tuple_size,
+                                                           mine_number_of_tuples,
+                                                           mine_table_size,
+                                                           weights,
+                                                           min_set_size);
+               else
+                    mined = sampledmh_mine_reader(&reader,
+                                                  mine_tuple_size,
+                                                  mine_number_of_tuples,
+                                                  mine_table_size,
+                                                  min_set_size);
+               listdb_reader_close(&reader);
+          } else {
+               printf("Reading sets from %s . . .\n", input);
+               ListDB corpus = smhcmd_load(input);
+               printf("Number of documents: %d\nVocabulary size: %d\n", corpus.size, corpus.dim);
+               if (mapped_weights.header != NULL)
+                    weights_validate_listdb(&mapped_weights, &corpus);
+          
+               // mining and clustering only need the sets of items
+               SetDB sets;
+               if (ifindex_file != NULL && weights_is_stats(ifindex_file)) {
+                    // cumulative frequencies are read from the statistics
+                    StatsFile stats;
+                    weights_stats_open(&stats, ifindex_file);
+                    weights_stats_validate_listdb(&stats, &corpus);
+                    sets = mh_expand_setdb(&corpus, stats.cumfreq);
+                    weights_stats_close(&stats);
+               } else if (ifindex_file != NULL) {
+                    ListDB ifindex = smhcmd_load(ifindex_file);
                     uint *maxfreq = mh_get_cumulative_frequency(&corpus, &ifindex);
-                    ListDB expanded_corpus = mh_expand_listdb(&corpus, maxfreq);
-                    mined = sampledmh_mine(&expanded_corpus,
-                                           mine_tuple_size,
-                                           mine_number_of_tuples,
-                                           mine_table_size,
-                                           min_set_size);
+                    sets = mh_expand_setdb(&corpus, maxfreq);
+                    free(maxfreq);
+                    listdb_destroy(&ifindex);
                } else {
-                    mined = sampledmh_mine(&corpus,
-                                           mine_tuple_size,
-                                           mine_number_of_tuples,
-                                           mine_table_size,
-                                           min_set_size);
+                    sets = setdb_from_listdb(&corpus);
                }
+               listdb_destroy(&corpus);
+
+               printf("Mining . . . ");
+               if (weights != NULL)
+                    mined = sampledmh_mine_weighted_sets(&sets,
+                                                         mine_tuple_size,
+                                                         mine_number_of_tuples,
+                                                         mine_table_size,
+                                                         weights,
+                                                         min_set_size);
+               else
+                    mined = sampledmh_mine_sets(&sets,
+                                                mine_tuple_size,
+                                                mine_number_of_tuples,
+                                                mine_table_size,
+                                                min_set_size);
+               setdb_destroy(&sets);
           }
+          if (mapped_weights.header != NULL)
+               weights_close(&mapped_weights);
+          else
+               free(weights);
           
           printf("Sorting sets by size and deleting the smallest ones . . .\n");
-          listdb_sort_by_size_back(&mined);
-          listdb_delete_smallest(&mined, min_set_size);
+          setdb_sort_by_size_back(&mined);
+          setdb_delete_smallest(&mined, min_set_size);
           printf("Number of mined sets: %d\nDimensionality: %d\n", mined.size, mined.dim);
 
           printf("Clustering mined sets . . .\n");
-          ListDB models = mhlink_cluster(&mined,
-                                         cluster_tuple_size,
-                                         cluster_number_of_tuples,
-                                         cluster_table_size,
-                                         list_overlap,
-                                         overlap,
-                                         min_cluster_size);
+          ListDB models;
+          if (compress) {
+               ListDB mined_lists = setdb_to_listdb(&mined);
+               setdb_destroy(&mined);
+               CListDB cmined = clistdb_from_listdb(&mined_lists);
+               listdb_destroy(&mined_lists);
+               printf("Compressed mined sets: %zu bytes\n", clistdb_memory(&cmined));
+               models = mhlink_cluster_compressed(&cmined,
+                                                  cluster_tuple_size,
+                                                  cluster_number_of_tuples,
+                                                  cluster_table_size,
+                                                  clist_overlap,
+                                                  overlap,
+                                                  min_cluster_size);
+               clistdb_destroy(&cmined);
+          } else {
+               models = mhlink_cluster_sets(&mined,
+                                            cluster_tuple_size,
+                                            cluster_number_of_tuples,
+                                            cluster_table_size,
+                                            set_overlap,
+                                            overlap,
+                                            min_cluster_size);
+               setdb_destroy(&mined);
+          }
           
           printf("Saving models in %s\n", output);
-          listdb_save_to_file(output, &models);
+          if (container)
+               clistdb_save(output, &models, SMHCMD_CONTAINER_FLAGS);
+          else if (binary)
+               listdb_save_binary(output, &models);
+          else
+               listdb_save_to_file(output, &models);
+     } else {
+          if (optind + 2 > opnum)
+               fprintf(stderr, "Error: Missing arguments.\n"
+                       "Try `smhcmd --help' for more information.\n");
+          else
+               fprintf(stderr, "Error: Unknown arguments.\n"
+                       "Try `smhcmd --help' for more information.\n");
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Retrieves the documents with the largest scores for each query
+ *        of a list database.
+ *
+ * @param opnum Number of command line options.
+ * @param opts Command line options.
+ */
+void smhcmd_query(int opnum, char **opts)
+{
+     char *ifindex_path, *queries_path, *output;
+     char *weights_file = NULL;
+     uint k = 10;
+     size_t cache_size = IFINDEX_CACHE_CAPACITY;
+     int op;
+     int option_index = 0;
+
+     static struct option long_options[] =
+          {
+               {"help", no_argument, 0, 'h'},
+               {"top", required_argument, 0, 'k'},
+               {"weights", required_argument, 0, 'w'},
+               {"cache", required_argument, 0, 'c'},
+               {0, 0, 0, 0}
+          };
+
+     //Command-line option parser
+     while((op = getopt_long( opnum, opts, "hk:w:c:", long_options,
+                              &option_index)) != -1){
+          switch (op) {
+          case 0:
+               break;
+          case 'h':
+               usage();
+               exit(EXIT_SUCCESS);
+               break;
+          case 'k':
+               k = atoi(optarg);
+               break;
+          case 'w':
+               weights_file = optarg;
+               break;
+          case 'c':
+               cache_size = (size_t) atol(optarg) << 20;
+               break;
+          case '?':
+               fprintf(stderr,"Error: Unknown options.\n"
+                       "Try `smhcmd --help' for more information.\n");
+               exit(EXIT_FAILURE);
+          default:
+               abort ();
+          }
+     }
+     if (optind + 3 == opnum){
+          ifindex_path = opts[optind++];
+          queries_path = opts[optind++];
+          output = opts[optind++];
+
+          printf("Loading inverted file %s . . .\n", ifindex_path);
+          IFPartitions ifindex = ifindex_partitions_load(ifindex_path);
+          printf("Number of documents: %d\nVocabulary size: %d\n", ifindex.dim, ifindex.vocsize);
+
+          double *weights = NULL;
+          WeightsFile mapped_weights = {NULL, NULL, 0};
+          if (weights_file != NULL) {
+               printf("Loading weights . . .\n");
+               if (weights_is_binary(weights_file)) {
+                    weights_open_mmap(&mapped_weights, weights_file);
+                    if (mapped_weights.header->size < ifindex.vocsize) {
+                         fprintf(stderr,"Error: %s has %llu weights but there are %u items\n",
+                                 weights_file, mapped_weights.header->size, ifindex.vocsize);
+                         exit(EXIT_FAILURE);
+                    }
+                    weights = mapped_weights.weights;
+               } else {
+                    weights = weights_load_from_file(weights_file);
+               }
+          }
+
+          ListDB queries = smhcmd_load(queries_path);
+          printf("Retrieving the top %u documents of %u queries . . .\n", k, queries.size);
+
+          FILE *file;
+          if (!(file = fopen(output, "w"))) {
+               fprintf(stderr,"Error: Could not create file %s\n", output);
+               exit(EXIT_FAILURE);
+          }
+
+          uint i, j;
+          Score *results = (Score *) malloc(k * sizeof(Score));
+          IFCache cache = ifindex_cache_create(cache_size);
+          for (i = 0; i < queries.size; i++) {
+               for (j = 0; j < queries.lists[i].size; j++) {
+                    if (queries.lists[i].data[j].item >= ifindex.vocsize) {
+                         fprintf(stderr,"Error: Item %u of query %u is not in the inverted file\n",
+                                 queries.lists[i].data[j].item, i);
+                         exit(EXIT_FAILURE);
+                    }
+               }
+               // repeated queries take their results from the cache
+               size_t bytes;
+               uint size;
+               Score *cached = (Score *) ifindex_cache_get(&cache, &queries.lists[i], k, &bytes);
+               if (cached != NULL) {
+                    size = bytes / sizeof(Score);
+                    memcpy(results, cached, bytes);
+                    free(cached);
+               } else {
+                    size = ifindex_partitions_query_topk(&ifindex, &queries.lists[i], weights, k,
+                                                         results);
+                    ifindex_cache_put(&cache, &queries.lists[i], k, results, size * sizeof(Score));
+               }
+               fprintf(file, "%u", size);
+               for (j = 0; j < size; j++)
+                    fprintf(file, " %u:%g", results[j].index, results[j].value);
+               fprintf(file, "\n");
+          }
+          if (fclose(file)) {
+               fprintf(stderr,"Error: Could not write file %s\n", output);
+               exit(EXIT_FAILURE);
+          }
+          printf("Results saved into %s\n", output);
+          printf("Cache hits: %llu\nCache misses: %llu\n", cache.hits, cache.misses);
+          ifindex_cache_destroy(&cache);
+
+          free(results);
+          listdb_destroy(&queries);
+          if (mapped_weights.header != NULL)
+               weights_close(&mapped_weights);
+          else
+               free(weights);
+          ifindex_partitions_destroy(&ifindex);
+     } else {
+          if (optind + 3 > opnum)
+               fprintf(stderr, "Error: Missing arguments.\n"
+                       "Try `smhcmd --help' for more information.\n");
+          else
+               fprintf(stderr, "Error: Unknown arguments.\n"
+                       "Try `smhcmd --help' for more information.\n");
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Saves the statistics of a corpus
+ *
+ * @param opnum Number of command line options.
+ * @param opts Command line options.
+ */
+void smhcmd_stats(int opnum, char **opts)
+{
+     char *input, *output;
+     int op;
+     int option_index = 0;
+
+     static struct option long_options[] =
+          {
+               {"help", no_argument, 0, 'h'},
+               {0, 0, 0, 0}
+          };
+
+     //Command-line option parser
+     while((op = getopt_long( opnum, opts, "h", long_options,
+                              &option_index)) != -1){
+          switch (op) {
+          case 0:
+               break;
+          case 'h':
+               usage();
+               exit(EXIT_SUCCESS);
+               break;
+          case '?':
+               fprintf(stderr,"Error: Unknown options.\n"
+                       "Try `smhcmd --help' for more information.\n");
+               exit(EXIT_FAILURE);
+          default:
+               abort ();
+          }
+     }
+     if (optind + 2 == opnum){
+          input = opts[optind++];
+          output = opts[optind++];
+
+          // the corpus is read in batches
+          printf("Computing statistics of corpus file %s . . .\n", input);
+          ListDBReader corpus;
+          listdb_reader_open(&corpus, input, LISTDB_BATCH_ITEMS);
+          weights_stats_save(output, &corpus);
+          listdb_reader_close(&corpus);
+
+          StatsFile stats;
+          weights_stats_open(&stats, output);
+          printf("Number of documents: %llu\nVocabulary size: %llu\n",
+                 stats.header->number_of_docs, stats.header->number_of_terms);
+          weights_stats_close(&stats);
+          printf("Statistics saved into %s\n", output);
      } else {
           if (optind + 2 > opnum)
                fprintf(stderr, "Error: Missing arguments.\n"
@@ -396,6 +946,10 @@ int main(int argc, char **argv)
                smhcmd_weights(argc - 1, &argv[1]);
           else if ( strcmp(argv[1], "discover") == 0 )
                smhcmd_discover(argc - 1, &argv[1]);
+          else if ( strcmp(argv[1], "query") == 0 )
+               smhcmd_query(argc - 1, &argv[1]);
+          else if ( strcmp(argv[1], "stats") == 0 )
+               smhcmd_stats(argc - 1, &argv[1]);
           else if ( strcmp(argv[1], "--help") == 0 || 
                     strcmp(argv[1], "-h") == 0 ){
                usage();
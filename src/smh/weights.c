@@ -23,6 +23,10 @@
 #include <string.h>
 #include <math.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "weights.h"
 
 /**
@@ -376,6 +380,55 @@ uint weights_intweight(double weight)
      return round(weight * 100000000L);
 }
 
+/**
+ * Arguments read by each weighting scheme. Some schemes pass their
+ * arguments to others in a different order, so these are the arguments
+ * that end up being used rather than the ones suggested by the name.
+ */
+static const struct {
+     double (*wg)(uint,uint,uint,uint,uint,uint);
+     uint depends;
+} weights_schemes[] = {
+     {weights_termfreq, WEIGHTS_DEPENDS_TF},
+     {weights_logtf, WEIGHTS_DEPENDS_TF},
+     {weights_bintf, 0},
+     {weights_idf, WEIGHTS_DEPENDS_DF},
+     {weights_itf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC},
+     {weights_ids, WEIGHTS_DEPENDS_DF},
+     {weights_tfidf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_logtfidf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_itfidf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_logitfidf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_tfids, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_logtfids, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_itfidfids, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_logitfidfids, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC},
+     {weights_tfdr, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC},
+     {weights_logtfdr, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC},
+     {weights_drtf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC},
+     {weights_drlogtf, WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DOC}
+};
+
+/**
+ * @brief Finds which arguments a weighting function reads, so the
+ *        weights that do not depend on the term frequency or the document
+ *        can be computed once and reused.
+ *
+ * @param wg Weighting function
+ *
+ * @return Mask of WEIGHTS_DEPENDS_* flags (all of them for functions that
+ *         are not weighting schemes of this file)
+ */
+uint weights_dependencies(double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i;
+     for (i = 0; i < sizeof(weights_schemes) / sizeof(weights_schemes[0]); i++)
+          if (weights_schemes[i].wg == wg)
+               return weights_schemes[i].depends;
+
+     return WEIGHTS_DEPENDS_TF | WEIGHTS_DEPENDS_DF | WEIGHTS_DEPENDS_DOC;
+}
+
 /**
  * @brief Computes weights of the items in an inverted file
  *
@@ -395,6 +448,49 @@ double *weights_from_corpus_and_ifindex(ListDB *corpus, ListDB *ifindex,
      return weights;
 }
 
+/**
+ * @brief Computes weights of the items in an inverted file reading the
+ *        corpus and the inverted file in batches. Only the size of each
+ *        list of the inverted file is kept in memory.
+ *
+ * @param corpus Reader of the corpus
+ * @param ifindex Reader of the inverted file
+ * @param wg Function to compute weight
+ *
+ * @return Array with the weight of each item
+ */
+double *weights_from_readers(ListDBReader *corpus, ListDBReader *ifindex,
+                             double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i;
+     uint capacity = 0, number_of_items = 0;
+     uint *df = NULL;
+
+     // gets the size of each list in the inverted file
+     ListDB batch;
+     listdb_init(&batch);
+     listdb_reader_rewind(ifindex);
+     while (listdb_reader_next_batch(ifindex, &batch) > 0) {
+          if (number_of_items + batch.size > capacity) {
+               capacity = max(number_of_items + batch.size, 2 * capacity);
+               df = realloc(df, capacity * sizeof(uint));
+          }
+          for (i = 0; i < batch.size; i++)
+               df[number_of_items++] = batch.lists[i].size;
+     }
+     listdb_destroy(&batch);
+
+     // gets the number of lists in the corpus
+     listdb_reader_count(corpus);
+
+     double *weights = (double *) malloc(number_of_items * sizeof(double));
+     for (i = 0; i < number_of_items; i++)
+          weights[i] = wg(0, df[i], 0, 0, corpus->size, number_of_items);
+     free(df);
+     
+     return weights;
+}
+
 /**
  * @brief Loads the weights of all the items from a file
  *        Format: 
@@ -453,21 +549,537 @@ double *weights_load_from_file(char *filename)
  *
  */
 void weights_save_to_file(char *filename, uint number_of_items, double *weights)
+{
+     int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if (fd == -1) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // formats chunks of weights in parallel and writes them in order
+     uint number_of_chunks = (number_of_items + WEIGHTS_CHUNK_SIZE - 1) / WEIGHTS_CHUNK_SIZE;
+     char **buffers = (char **) malloc(number_of_chunks * sizeof(char *));
+     size_t *lengths = (size_t *) malloc(number_of_chunks * sizeof(size_t));
+     uint i;
+#pragma omp parallel for schedule(dynamic)
+     for (i = 0; i < number_of_chunks; i++) {
+          uint first = i * WEIGHTS_CHUNK_SIZE;
+          uint last = first + WEIGHTS_CHUNK_SIZE;
+          if (last > number_of_items)
+               last = number_of_items;
+
+          size_t capacity = (size_t) (last - first) * 16;
+          size_t length = 0;
+          char *buffer = (char *) malloc(capacity);
+          uint j;
+          for (j = first; j < last; j++) {
+               int written;
+               while ((written = snprintf(buffer + length, capacity - length,
+                                          " %lf\n", weights[j])) >= (int) (capacity - length)) {
+                    capacity *= 2;
+                    buffer = (char *) realloc(buffer, capacity);
+               }
+               length += written;
+          }
+          buffers[i] = buffer;
+          lengths[i] = length;
+     }
+
+     for (i = 0; i < number_of_chunks; i++) {
+          listdb_write_buffer(fd, buffers[i], lengths[i], filename);
+          free(buffers[i]);
+     }
+     free(buffers);
+     free(lengths);
+
+     if (close(fd)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Mixes the size of the next list into a fingerprint
+ *
+ * @param hash Fingerprint of the previous lists
+ * @param size Size of the list
+ *
+ * @return Fingerprint
+ */
+static ullong weights_fingerprint_mix(ullong hash, uint size)
+{
+     hash ^= size + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+     hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+
+     return hash ^ (hash >> 31);
+}
 
+/**
+ * @brief Computes the fingerprint of a list database whose items are
+ *        weighted (the corpus for term weights and the inverted file for
+ *        document weights) from the size of each of its lists, in order.
+ *        It covers the number of lists and items, and how the items are
+ *        spread over the lists. Sizes are exact in text and binary files.
+ *
+ * @param sizes Size of each list
+ * @param number_of_lists Number of lists in the database
+ *
+ * @return Fingerprint
+ */
+ullong weights_fingerprint(uint *sizes, uint number_of_lists)
+{
+     uint i;
+     ullong hash = WEIGHTS_FINGERPRINT_SEED;
+     for (i = 0; i < number_of_lists; i++)
+          hash = weights_fingerprint_mix(hash, sizes[i]);
+
+     return hash;
+}
+
+/**
+ * @brief Computes the fingerprint of a list database (see
+ *        weights_fingerprint)
+ *
+ * @param listdb List database
+ *
+ * @return Fingerprint
+ */
+ullong weights_fingerprint_listdb(ListDB *listdb)
+{
+     uint i;
+     ullong hash = WEIGHTS_FINGERPRINT_SEED;
+     for (i = 0; i < listdb->size; i++)
+          hash = weights_fingerprint_mix(hash, listdb->lists[i].size);
+
+     return hash;
+}
+
+/**
+ * @brief Computes the fingerprint of a list database read in batches (see
+ *        weights_fingerprint). The reader is rewound and also counts the
+ *        lists and items of the database.
+ *
+ * @param reader Reader of the list database
+ *
+ * @return Fingerprint
+ */
+ullong weights_fingerprint_reader(ListDBReader *reader)
+{
+     uint i;
+     ullong hash = WEIGHTS_FINGERPRINT_SEED;
+     ListDB batch;
+     listdb_init(&batch);
+     listdb_reader_rewind(reader);
+     while (listdb_reader_next_batch(reader, &batch) > 0)
+          for (i = 0; i < batch.size; i++)
+               hash = weights_fingerprint_mix(hash, batch.lists[i].size);
+     listdb_destroy(&batch);
+     listdb_reader_rewind(reader);
+
+     return hash;
+}
+
+/**
+ * @brief Saves weights in a binary file that can be mapped in memory
+ *
+ * @param filename File where the weights are saved
+ * @param number_of_items Number of weights
+ * @param weights Weights
+ * @param scheme Weighting scheme (WEIGHTS_IDF, WEIGHTS_IDS or WEIGHTS_UNKNOWN)
+ * @param fingerprint Fingerprint of the weighted list database
+ */
+void weights_save_binary(char *filename, uint number_of_items, double *weights, uint scheme,
+                         ullong fingerprint)
+{
+     int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if (fd == -1) {
+          fprintf(stderr,"Error: Could not create file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     WeightsHeader header;
+     memset(&header, 0, sizeof(header));
+     memcpy(header.magic, WEIGHTS_MAGIC, sizeof(header.magic));
+     header.version = WEIGHTS_VERSION;
+     header.scheme = scheme;
+     header.size = number_of_items;
+     header.fingerprint = fingerprint;
+
+     listdb_write_buffer(fd, (char *) &header, sizeof(header), filename);
+     listdb_write_buffer(fd, (char *) weights, number_of_items * sizeof(double), filename);
+
+     if (close(fd)) {
+          fprintf(stderr,"Error: Could not close file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Checks if a file contains binary weights
+ *
+ * @param filename File to check
+ *
+ * @return 1 if the file starts with the magic string of the binary
+ *         format, 0 otherwise
+ */
+int weights_is_binary(char *filename)
 {
      FILE *file;
-     
-     if (!(file = fopen(filename,"w"))) {
+     if (!(file = fopen(filename,"rb"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     char magic[8];
+     int binary = fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic) &&
+          memcmp(magic, WEIGHTS_MAGIC, sizeof(magic)) == 0;
+     fclose(file);
+
+     return binary;
+}
+
+/**
+ * @brief Maps a binary weights file in memory and checks its header. The
+ *        weights are used in place, without parsing or copying them.
+ *
+ * @param file Mapped weights file
+ * @param filename Binary weights file
+ */
+void weights_open_mmap(WeightsFile *file, char *filename)
+{
+     int fd;
+     if ((fd = open(filename, O_RDONLY)) == -1) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     struct stat st;
+     if (fstat(fd, &st) == -1 || st.st_size < sizeof(WeightsHeader)) {
+          fprintf(stderr,"Error: %s is not a binary weights file\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     file->mapping_size = st.st_size;
+     void *mapping = mmap(NULL, file->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (mapping == MAP_FAILED) {
+          fprintf(stderr,"Error: Could not map file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // checking header
+     file->header = (WeightsHeader *) mapping;
+     file->weights = (double *) (file->header + 1);
+     if (memcmp(file->header->magic, WEIGHTS_MAGIC, sizeof(file->header->magic)) != 0) {
+          fprintf(stderr,"Error: %s is not a binary weights file\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     if (file->header->version != WEIGHTS_VERSION) {
+          fprintf(stderr,"Error: Unsupported version %u of binary weights file %s\n",
+                  file->header->version, filename);
+          exit(EXIT_FAILURE);
+     }
+     if (file->mapping_size != sizeof(WeightsHeader) + file->header->size * sizeof(double)) {
+          fprintf(stderr,"Error: Binary weights file %s is truncated or corrupted\n", filename);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Checks that binary weights were computed for a list database.
+ *        The fingerprint must match and there must be exactly one weight
+ *        for every item of the database.
+ *
+ * @param file Mapped weights file
+ * @param fingerprint Fingerprint of the weighted database
+ * @param dim Dimensionality of the weighted database
+ */
+void weights_validate(WeightsFile *file, ullong fingerprint, uint dim)
+{
+     if (file->header->fingerprint != fingerprint) {
+          fprintf(stderr,"Error: Weights were computed for a different corpus "
+                  "(the sizes of its lists do not match the fingerprint)\n");
+          exit(EXIT_FAILURE);
+     }
+     if (file->header->size != dim) {
+          fprintf(stderr,"Error: There are %llu weights but the corpus has %u items\n",
+                  file->header->size, dim);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Checks that binary weights were computed for a list database
+ *
+ * @param file Mapped weights file
+ * @param listdb Weighted list database
+ */
+void weights_validate_listdb(WeightsFile *file, ListDB *listdb)
+{
+     weights_validate(file, weights_fingerprint_listdb(listdb), listdb->dim);
+}
+
+/**
+ * @brief Unmaps a binary weights file
+ *
+ * @param file Mapped weights file
+ */
+void weights_close(WeightsFile *file)
+{
+     munmap(file->header, file->mapping_size);
+     file->header = NULL;
+     file->weights = NULL;
+     file->mapping_size = 0;
+}
+
+/**
+ * @brief Computes the statistics of a corpus read in batches and saves
+ *        them in binary format, so weighting and expansion do not need
+ *        to read the corpus or its inverted file again. Documents are
+ *        expected to have each term once.
+ *
+ * @param filename Statistics file
+ * @param corpus Reader of the corpus
+ */
+void weights_stats_save(char *filename, ListDBReader *corpus)
+{
+     uint i, j;
+     ullong number_of_docs = 0, number_of_terms = 0, number_of_items = 0;
+     ullong doc_capacity = 0, term_capacity = 0;
+     uint *doclens = NULL, *docterms = NULL, *df = NULL, *maxfreq = NULL;
+     ullong *cf = NULL;
+
+     ListDB batch;
+     listdb_init(&batch);
+     listdb_reader_rewind(corpus);
+     while (listdb_reader_next_batch(corpus, &batch) > 0) {
+          if (number_of_docs + batch.size > doc_capacity) {
+               doc_capacity = max(number_of_docs + batch.size, 2 * doc_capacity);
+               doclens = (uint *) realloc(doclens, doc_capacity * sizeof(uint));
+               docterms = (uint *) realloc(docterms, doc_capacity * sizeof(uint));
+          }
+          if (batch.dim > term_capacity) {
+               ullong capacity = max(batch.dim, 2 * term_capacity);
+               df = (uint *) realloc(df, capacity * sizeof(uint));
+               maxfreq = (uint *) realloc(maxfreq, capacity * sizeof(uint));
+               cf = (ullong *) realloc(cf, capacity * sizeof(ullong));
+               memset(df + term_capacity, 0, (capacity - term_capacity) * sizeof(uint));
+               memset(maxfreq + term_capacity, 0, (capacity - term_capacity) * sizeof(uint));
+               memset(cf + term_capacity, 0, (capacity - term_capacity) * sizeof(ullong));
+               term_capacity = capacity;
+          }
+          if (number_of_terms < batch.dim)
+               number_of_terms = batch.dim;
+
+          for (i = 0; i < batch.size; i++) {
+               List *doc = &batch.lists[i];
+               uint length = 0;
+               for (j = 0; j < doc->size; j++) {
+                    Item *item = &doc->data[j];
+                    length += item->freq;
+                    df[item->item]++;
+                    cf[item->item] += item->freq;
+                    if (maxfreq[item->item] < item->freq)
+                         maxfreq[item->item] = item->freq;
+               }
+               doclens[number_of_docs] = length;
+               docterms[number_of_docs] = doc->size;
+               number_of_docs++;
+               number_of_items += doc->size;
+          }
+     }
+     listdb_destroy(&batch);
+
+     uint *cumfreq = (uint *) malloc((number_of_terms + 1) * sizeof(uint));
+     for (i = 0; i < number_of_terms; i++)
+          cumfreq[i] = maxfreq[i] + (i > 0 ? cumfreq[i - 1] : 0);
+
+     int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if (fd == -1) {
           fprintf(stderr,"Error: Could not create file %s\n", filename);
           exit(EXIT_FAILURE);
      }
 
-     uint i;
-     for (i = 0; i < number_of_items; i++)
-          fprintf(file," %lf\n", weights[i]);
-     
-     if (fclose(file)) {
+     StatsHeader header;
+     memset(&header, 0, sizeof(header));
+     memcpy(header.magic, STATS_MAGIC, sizeof(header.magic));
+     header.version = STATS_VERSION;
+     header.number_of_docs = number_of_docs;
+     header.number_of_terms = number_of_terms;
+     header.number_of_items = number_of_items;
+
+     listdb_write_buffer(fd, (char *) &header, sizeof(header), filename);
+     listdb_write_buffer(fd, (char *) cf, number_of_terms * sizeof(ullong), filename);
+     listdb_write_buffer(fd, (char *) doclens, number_of_docs * sizeof(uint), filename);
+     listdb_write_buffer(fd, (char *) docterms, number_of_docs * sizeof(uint), filename);
+     listdb_write_buffer(fd, (char *) df, number_of_terms * sizeof(uint), filename);
+     listdb_write_buffer(fd, (char *) maxfreq, number_of_terms * sizeof(uint), filename);
+     listdb_write_buffer(fd, (char *) cumfreq, number_of_terms * sizeof(uint), filename);
+
+     if (close(fd)) {
           fprintf(stderr,"Error: Could not close file %s\n", filename);
           exit(EXIT_FAILURE);
      }
+     free(doclens);
+     free(docterms);
+     free(df);
+     free(maxfreq);
+     free(cf);
+     free(cumfreq);
+}
+
+/**
+ * @brief Checks if a file contains corpus statistics
+ *
+ * @param filename File to check
+ *
+ * @return 1 if the file starts with the magic string of the statistics
+ *         format, 0 otherwise
+ */
+int weights_is_stats(char *filename)
+{
+     FILE *file;
+     if (!(file = fopen(filename,"rb"))) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     char magic[8];
+     int stats = fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic) &&
+          memcmp(magic, STATS_MAGIC, sizeof(magic)) == 0;
+     fclose(file);
+
+     return stats;
+}
+
+/**
+ * @brief Maps a corpus statistics file in memory and checks its header
+ *
+ * @param file Mapped statistics file
+ * @param filename Statistics file
+ */
+void weights_stats_open(StatsFile *file, char *filename)
+{
+     int fd;
+     if ((fd = open(filename, O_RDONLY)) == -1) {
+          fprintf(stderr,"Error: Could not open file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     struct stat st;
+     if (fstat(fd, &st) == -1 || st.st_size < sizeof(StatsHeader)) {
+          fprintf(stderr,"Error: %s is not a corpus statistics file\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     file->mapping_size = st.st_size;
+     void *mapping = mmap(NULL, file->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (mapping == MAP_FAILED) {
+          fprintf(stderr,"Error: Could not map file %s\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     // checking header
+     StatsHeader *header = (StatsHeader *) mapping;
+     file->header = header;
+     if (memcmp(header->magic, STATS_MAGIC, sizeof(header->magic)) != 0) {
+          fprintf(stderr,"Error: %s is not a corpus statistics file\n", filename);
+          exit(EXIT_FAILURE);
+     }
+     if (header->version != STATS_VERSION) {
+          fprintf(stderr,"Error: Unsupported version %u of corpus statistics file %s\n",
+                  header->version, filename);
+          exit(EXIT_FAILURE);
+     }
+     if (file->mapping_size != sizeof(StatsHeader) + header->number_of_terms * sizeof(ullong) +
+         (2 * header->number_of_docs + 3 * header->number_of_terms) * sizeof(uint)) {
+          fprintf(stderr,"Error: Corpus statistics file %s is truncated or corrupted\n", filename);
+          exit(EXIT_FAILURE);
+     }
+
+     file->cf = (ullong *) (header + 1);
+     file->doclens = (uint *) (file->cf + header->number_of_terms);
+     file->docterms = file->doclens + header->number_of_docs;
+     file->df = file->docterms + header->number_of_docs;
+     file->maxfreq = file->df + header->number_of_terms;
+     file->cumfreq = file->maxfreq + header->number_of_terms;
+}
+
+/**
+ * @brief Checks that corpus statistics were computed for a database of
+ *        lists
+ *
+ * @param file Mapped statistics file
+ * @param listdb Database of lists
+ */
+void weights_stats_validate_listdb(StatsFile *file, ListDB *listdb)
+{
+     uint i;
+     ullong number_of_items = 0;
+     for (i = 0; i < listdb->size; i++)
+          number_of_items += listdb->lists[i].size;
+
+     if (file->header->number_of_docs != listdb->size ||
+         file->header->number_of_items != number_of_items ||
+         file->header->number_of_terms < listdb->dim) {
+          fprintf(stderr,"Error: Statistics were computed for a different corpus "
+                  "(%llu documents, %llu items and %llu terms)\n", file->header->number_of_docs,
+                  file->header->number_of_items, file->header->number_of_terms);
+          exit(EXIT_FAILURE);
+     }
+}
+
+/**
+ * @brief Computes the weights of the terms of a corpus from its
+ *        statistics (see weights_from_readers)
+ *
+ * @param file Mapped statistics file
+ * @param wg Function to compute weight
+ *
+ * @return Array with the weight of each term
+ */
+double *weights_from_stats(StatsFile *file, double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i;
+     uint number_of_terms = file->header->number_of_terms;
+     double *weights = (double *) malloc(number_of_terms * sizeof(double));
+     for (i = 0; i < number_of_terms; i++)
+          weights[i] = wg(0, file->df[i], 0, 0, file->header->number_of_docs, number_of_terms);
+
+     return weights;
+}
+
+/**
+ * @brief Computes the weights of the documents of a corpus from its
+ *        statistics, with the roles of documents and terms swapped as in
+ *        weights_from_readers(ifindex, corpus)
+ *
+ * @param file Mapped statistics file
+ * @param wg Function to compute weight
+ *
+ * @return Array with the weight of each document
+ */
+double *weights_documents_from_stats(StatsFile *file, double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i;
+     uint number_of_docs = file->header->number_of_docs;
+     double *weights = (double *) malloc(number_of_docs * sizeof(double));
+     for (i = 0; i < number_of_docs; i++)
+          weights[i] = wg(0, file->docterms[i], 0, 0, file->header->number_of_terms,
+                          number_of_docs);
+
+     return weights;
+}
+
+/**
+ * @brief Unmaps a corpus statistics file
+ *
+ * @param file Mapped statistics file
+ */
+void weights_stats_close(StatsFile *file)
+{
+     munmap(file->header, file->mapping_size);
+     memset(file, 0, sizeof(StatsFile));
 }
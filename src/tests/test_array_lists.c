@@ -321,14 +321,57 @@ void test_less_more_frequent(void)
      printf ("%s",none);
 }
 
+uint test_merge_multi(void)
+{
+     uint number_of_lists[2] = {10, 200};
+     uint i, k, failed = 0;
+
+     for (k = 0; k < 2; k++) {
+          List *lists = (List *) malloc(number_of_lists[k] * sizeof(List));
+          List **pointers = (List **) malloc(number_of_lists[k] * sizeof(List *));
+          List appended;
+          list_init(&appended);
+          for (i = 0; i < number_of_lists[k]; i++) {
+               lists[i] = list_random(MAX_LIST_SIZE, 100);
+               list_sort_by_item(&lists[i]);
+               list_unique(&lists[i]);
+               list_append(&appended, &lists[i]);
+               pointers[i] = &lists[i];
+          }
+          list_sort_by_item(&appended);
+          list_unique(&appended);
+
+          List merged = list_merge_multi(pointers, number_of_lists[k]);
+          uint errors = appended.size != merged.size;
+          for (i = 0; !errors && i < merged.size; i++)
+               if (appended.data[i].item != merged.data[i].item ||
+                   appended.data[i].freq != merged.data[i].freq)
+                    errors++;
+          printf("%sMerge of %u lists: %s%s\n", errors ? red : green, number_of_lists[k],
+                 errors ? "FAILED" : "OK", none);
+          failed += errors;
+
+          for (i = 0; i < number_of_lists[k]; i++)
+               list_destroy(&lists[i]);
+          list_destroy(&appended);
+          list_destroy(&merged);
+          free(lists);
+          free(pointers);
+     }
+
+     return failed;
+}
+
 int main()
 {
+     uint errors = 0;
      srand((long int) time(NULL));
 
      /* test_min_max(); */
      /* test_sort_unique_find_search(); */
      /* test_less_more_frequent(); */
      test_jaccard_overlap_histogramsim();
+     errors += test_merge_multi();
      /* test_concat_append_add_union_intersection_difference(); */
      /* test_pop_delete(); */
      /* test_sort_unique_find_search(); */
@@ -336,5 +379,5 @@ int main()
      /* test_insert_duplicate_copy(); */
      
      
-     return 0;
+     return errors != 0;
 }
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "compressed_lists.h"
+
+#define red "\033[0;31m"
+#define cyan "\033[0;36m"
+#define green "\033[0;32m"
+#define blue "\033[0;34m"
+#define brown "\033[0;33m"
+#define magenta "\033[0;35m"
+#define none "\033[0m"
+
+#define MAX_LIST_SIZE 1000
+#define ELEMENT_MAX_VALUE 5000
+
+uint test_encode_decode(void)
+{
+     ListDB listdb = listdb_random(50, MAX_LIST_SIZE, ELEMENT_MAX_VALUE);
+     listdb_apply_to_all(&listdb, list_sort_by_item);
+     listdb_apply_to_all(&listdb, list_unique);
+
+     CListDB clistdb = clistdb_from_listdb(&listdb);
+     ListDB decoded = clistdb_to_listdb(&clistdb);
+
+     uint i, j, errors = 0;
+     size_t bytes = 0;
+     for (i = 0; i < listdb.size; i++) {
+          bytes += listdb.lists[i].size * sizeof(Item);
+          if (!list_equal(&listdb.lists[i], &decoded.lists[i]))
+               errors++;
+          for (j = 0; j < listdb.lists[i].size; j++)
+               if (listdb.lists[i].data[j].freq != decoded.lists[i].data[j].freq)
+                    errors++;
+     }
+
+     printf("%s=========================\nCompressed list\n=========================\n", brown);
+     clist_print(&clistdb.lists[0]);
+     printf("%sOriginal: %zu bytes, compressed: %zu bytes\n", cyan, bytes, clistdb_memory(&clistdb));
+     printf("%sEncode/decode errors: %u%s\n", errors ? red : green, errors, none);
+
+     listdb_destroy(&decoded);
+     clistdb_destroy(&clistdb);
+     listdb_destroy(&listdb);
+
+     return errors;
+}
+
+uint test_union_intersection_seek(void)
+{
+     List list1 = list_random(MAX_LIST_SIZE, ELEMENT_MAX_VALUE);
+     List list2 = list_random(MAX_LIST_SIZE, ELEMENT_MAX_VALUE);
+     list_sort_by_item(&list1);
+     list_unique(&list1);
+     list_sort_by_item(&list2);
+     list_unique(&list2);
+
+     CList clist1 = clist_encode(&list1);
+     CList clist2 = clist_encode(&list2);
+
+     List inter = list_intersection(&list1, &list2);
+     List cinter = clist_intersection(&clist1, &clist2);
+     List uni = list_union(&list1, &list2);
+     List cuni = clist_union(&clist1, &clist2);
+
+     printf("%sIntersection size %u (compressed %u, compressed with list %u)\n", blue,
+            list_intersection_size(&list1, &list2),
+            clist_intersection_size(&clist1, &clist2),
+            clist_intersection_size_list(&clist1, &list2));
+     uint errors = !list_equal(&inter, &cinter) + !list_equal(&uni, &cuni);
+     printf("%sIntersection %s\n", list_equal(&inter, &cinter) ? green : red,
+            list_equal(&inter, &cinter) ? "OK" : "FAILED");
+     printf("%sUnion %s\n", list_equal(&uni, &cuni) ? green : red,
+            list_equal(&uni, &cuni) ? "OK" : "FAILED");
+     printf("%sJaccard %lf (compressed %lf), overlap %lf (compressed %lf)\n", magenta,
+            list_jaccard(&list1, &list2), clist_jaccard(&clist1, &clist2),
+            list_overlap(&list1, &list2), clist_overlap(&clist1, &clist2));
+
+     CListIter iter;
+     clist_iter_init(&iter, &clist1);
+     uint target = rand() % ELEMENT_MAX_VALUE;
+     Item *found = clist_iter_seek(&iter, target);
+     if (found != NULL)
+          printf("%sFirst item >= %u: %u\n", cyan, target, found->item);
+     else
+          printf("%sNo item >= %u\n", cyan, target);
+     printf("%s", none);
+
+     list_destroy(&inter);
+     list_destroy(&cinter);
+     list_destroy(&uni);
+     list_destroy(&cuni);
+     clist_destroy(&clist1);
+     clist_destroy(&clist2);
+     list_destroy(&list1);
+     list_destroy(&list2);
+
+     return errors;
+}
+
+uint test_container(void)
+{
+     uint flags, i, errors = 0;
+     char *filename = "test_container.smhc";
+     ListDB listdb = listdb_random(5000, 1000, 100000);
+     listdb_apply_to_all(&listdb, list_sort_by_item);
+     listdb_apply_to_all(&listdb, list_unique);
+
+#ifdef HAVE_ZLIB
+     for (flags = 0; flags <= CLISTDB_ZLIB; flags++) {
+#else
+     for (flags = 0; flags < CLISTDB_ZLIB; flags++) {
+#endif
+          clistdb_save(filename, &listdb, flags);
+          if (!clistdb_is_container(filename))
+               errors++;
+
+          ListDB loaded = clistdb_load(filename);
+          if (loaded.size != listdb.size || loaded.dim != listdb.dim)
+               errors++;
+          for (i = 0; !errors && i < listdb.size; i++)
+               if (!list_equal(&listdb.lists[i], &loaded.lists[i]))
+                    errors++;
+          listdb_destroy(&loaded);
+
+          // random access to a single list and to a range spanning blocks
+          CListDBFile file;
+          clistdb_file_open(&file, filename);
+          uint position = rand() % listdb.size;
+          List list = clistdb_file_get(&file, position);
+          if (!list_equal(&listdb.lists[position], &list))
+               errors++;
+          list_destroy(&list);
+
+          ListDB range = clistdb_file_range(&file, 1000, 4000);
+          for (i = 0; i < range.size; i++)
+               if (!list_equal(&listdb.lists[1000 + i], &range.lists[i]))
+                    errors++;
+          printf("%sContainer (flags = %u, blocks = %llu) errors: %u%s\n", errors ? red : green,
+                 flags, file.header->number_of_blocks, errors, none);
+          listdb_destroy(&range);
+          clistdb_file_close(&file);
+     }
+
+     listdb_destroy(&listdb);
+     remove(filename);
+
+     return errors;
+}
+
+uint test_corrupted(void)
+{
+     uint errors = 0;
+     char *filename = "test_corrupted.smhc";
+     ListDB listdb = listdb_random(10, 100, 1000);
+     listdb_apply_to_all(&listdb, list_sort_by_item);
+     listdb_apply_to_all(&listdb, list_unique);
+     if (listdb.lists[0].size == 0) {
+          Item item = {0, 1};
+          list_push(&listdb.lists[0], item);
+     }
+     clistdb_save(filename, &listdb, 0);
+
+     // points the first block of the first list past the end of its bytes
+     CListDBFile file;
+     clistdb_file_open(&file, filename);
+     long offset = (long) file.index[0].offset + 3 * sizeof(uint);
+     clistdb_file_close(&file);
+     uint bad_offset = 1u << 30;
+     FILE *fp = fopen(filename, "r+b");
+     fseek(fp, offset, SEEK_SET);
+     fwrite(&bad_offset, sizeof(uint), 1, fp);
+     fclose(fp);
+
+     // decoding the list must fail cleanly instead of reading out of bounds
+     fflush(stdout); // the child must not print the buffered output again
+     pid_t pid = fork();
+     if (pid == 0) {
+          clistdb_file_open(&file, filename);
+          List list = clistdb_file_get(&file, 0);
+          list_destroy(&list);
+          exit(EXIT_SUCCESS);
+     }
+     int status;
+     waitpid(pid, &status, 0);
+     if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_FAILURE)
+          errors++;
+
+     printf("%sCorrupted container errors: %u%s\n", errors ? red : green, errors, none);
+     listdb_destroy(&listdb);
+     remove(filename);
+
+     return errors;
+}
+
+int main()
+{
+     uint errors = 0;
+     srand((long int) time(NULL));
+
+     errors += test_encode_decode();
+     errors += test_union_intersection_seek();
+     errors += test_container();
+     errors += test_corrupted();
+
+     return errors != 0;
+}
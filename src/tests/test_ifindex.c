@@ -2,6 +2,9 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "ifindex.h"
 
 #define red "\033[0;31m"
@@ -38,11 +41,727 @@ void test_query(void)
      printf("%s", none);
 }
 
+uint test_query_threshold(void)
+{
+     uint i, j, min_hits, errors = 0;
+     ListDB corpus = listdb_random(300, 20, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     CListDB cifindex = clistdb_from_listdb(&ifindex);
+     ListDB queries = listdb_random(30, 40, 50); // long queries touch most documents
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+
+     // one accumulator is reused by all the queries and thresholds
+     IFAccumulator acc = ifindex_accumulator_create(ifindex.dim);
+     for (i = 0; i < queries.size; i++) {
+          List merged = ifindex_query_compressed(&cifindex, &queries.lists[i]);
+          for (min_hits = 0; min_hits < 4; min_hits++) {
+               List expected = ifindex_query(&ifindex, &queries.lists[i]);
+               if (min_hits == 0 && !list_equal(&expected, &merged))
+                    errors++;
+               list_delete_less_frequent(&expected, min_hits);
+               list_sort_by_item(&expected);
+               List retrieved = ifindex_query_threshold(&ifindex, &queries.lists[i], min_hits, &acc);
+               List decoded = ifindex_query_compressed_threshold(&cifindex, &queries.lists[i],
+                                                                 min_hits, &acc);
+               if (!list_equal(&expected, &retrieved) || !list_equal(&expected, &decoded))
+                    errors++;
+               for (j = 0; !errors && j < retrieved.size; j++)
+                    if (expected.data[j].freq != retrieved.data[j].freq ||
+                        expected.data[j].freq != decoded.data[j].freq)
+                         errors++;
+               list_destroy(&expected);
+               list_destroy(&retrieved);
+               list_destroy(&decoded);
+          }
+          list_destroy(&merged);
+     }
+     if (acc.size != 0)
+          errors++;
+     for (i = 0; i < acc.dim; i++)
+          if (acc.counts[i] != 0)
+               errors++;
+
+     printf("%sThreshold query errors: %u%s\n", errors ? red : green, errors, none);
+     ifindex_accumulator_destroy(&acc);
+     listdb_destroy(&queries);
+     clistdb_destroy(&cifindex);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_query_roaring(void)
+{
+     uint i, j, min_hits, errors = 0;
+     ListDB corpus = listdb_random(300, 20, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     for (i = 0; i < corpus.size; i++) // roaring hits count the query items of a document
+          for (j = 0; j < corpus.lists[i].size; j++)
+               corpus.lists[i].data[j].freq = 1;
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     RoaringDB rifindex = roaringdb_from_listdb(&ifindex);
+     ListDB queries = listdb_random(30, 40, 50);
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+
+     IFAccumulator acc = ifindex_accumulator_create(ifindex.dim);
+     for (i = 0; i < queries.size; i++) {
+          for (min_hits = 0; min_hits < 4; min_hits++) {
+               List expected = ifindex_query_threshold(&ifindex, &queries.lists[i], min_hits, &acc);
+               List retrieved = ifindex_query_roaring_threshold(&rifindex, &queries.lists[i],
+                                                                min_hits, &acc);
+               if (!list_equal(&expected, &retrieved))
+                    errors++;
+               for (j = 0; !errors && j < retrieved.size; j++)
+                    if (expected.data[j].freq != retrieved.data[j].freq)
+                         errors++;
+               list_destroy(&expected);
+               list_destroy(&retrieved);
+          }
+
+          // queries without a threshold reuse the accumulator of the thread
+          List expected = ifindex_query(&ifindex, &queries.lists[i]);
+          List retrieved = ifindex_query_roaring(&rifindex, &queries.lists[i]);
+          if (!list_equal(&expected, &retrieved))
+               errors++;
+          for (j = 0; !errors && j < retrieved.size; j++)
+               if (expected.data[j].freq != retrieved.data[j].freq)
+                    errors++;
+          list_destroy(&expected);
+          list_destroy(&retrieved);
+     }
+     if (acc.size != 0)
+          errors++;
+     for (i = 0; i < acc.dim; i++)
+          if (acc.counts[i] != 0)
+               errors++;
+
+     printf("%sRoaring query errors: %u%s\n", errors ? red : green, errors, none);
+     ifindex_accumulator_destroy(&acc);
+     listdb_destroy(&queries);
+     roaringdb_destroy(&rifindex);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_query_batch(void)
+{
+     uint i, j, round, errors = 0;
+     ListDB corpus = listdb_random(2000, 30, 200);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     ListDB queries = listdb_random(500, 60, 200); // queries of very different cost
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+     uint *min_hits = (uint *) malloc(queries.size * sizeof(uint));
+     for (i = 0; i < queries.size; i++)
+          min_hits[i] = rand() % 4;
+
+     // batches with and without a cache match the serial queries
+     IFCache cache = ifindex_cache_create(IFINDEX_CACHE_CAPACITY);
+     ListDB multi = ifindex_query_multi(&ifindex, &queries);
+     for (round = 0; round < 3; round++) {
+          ListDB results = listdb_create(queries.size, ifindex.dim);
+          ifindex_query_batch(&ifindex, &queries, min_hits, round > 0 ? &cache : NULL, &results);
+          for (i = 0; i < queries.size; i++) {
+               List expected = ifindex_query(&ifindex, &queries.lists[i]);
+               if (round == 0 && !list_equal(&expected, &multi.lists[i]))
+                    errors++;
+               list_delete_less_frequent(&expected, min_hits[i]);
+               list_sort_by_item(&expected);
+               if (!list_equal(&expected, &results.lists[i]))
+                    errors++;
+               for (j = 0; !errors && j < expected.size; j++)
+                    if (expected.data[j].freq != results.lists[i].data[j].freq)
+                         errors++;
+               list_destroy(&expected);
+          }
+          listdb_destroy(&results);
+     }
+
+     printf("%sBatch query errors: %u%s\n", errors ? red : green, errors, none);
+     ifindex_cache_destroy(&cache);
+     free(min_hits);
+     listdb_destroy(&multi);
+     listdb_destroy(&queries);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_query_topk(void)
+{
+     uint i, j, k = 5, errors = 0;
+     ListDB corpus = listdb_random(200, 30, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     ListDB queries = listdb_random(20, 8, 50);
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+
+     double *weights = (double *) malloc(ifindex.size * sizeof(double));
+     for (i = 0; i < ifindex.size; i++)
+          weights[i] = log(1.0 + (double) corpus.size / (ifindex.lists[i].size + 1));
+     uint *maxfreq = (uint *) malloc(ifindex.size * sizeof(uint));
+     ifindex_max_frequencies(&ifindex, maxfreq);
+
+     // compares the top k documents with the scores of all documents
+     Score *results = (Score *) malloc(k * sizeof(Score));
+     double *scores = (double *) malloc(corpus.size * sizeof(double));
+     for (i = 0; i < queries.size; i++) {
+          uint size = ifindex_query_topk(&ifindex, &queries.lists[i], weights, maxfreq, k, results);
+          List retrieved = ifindex_query(&ifindex, &queries.lists[i]);
+          if (size != (retrieved.size < k ? retrieved.size : k))
+               errors++;
+
+          for (j = 0; j < corpus.size; j++) {
+               Item *item, *found;
+               scores[j] = 0.0;
+               for (item = corpus.lists[j].data; item < corpus.lists[j].data + corpus.lists[j].size; item++)
+                    if ((found = list_binary_search(&queries.lists[i], *item)) != NULL)
+                         scores[j] += (double) found->freq * weights[item->item] * item->freq;
+          }
+          for (j = 0; j < size; j++) {
+               uint better = 0, d;
+               for (d = 0; d < corpus.size; d++)
+                    if (scores[d] > results[j].value + 1e-9)
+                         better++;
+               if (fabs(scores[results[j].index] - results[j].value) > 1e-9 || better > j ||
+                   (j > 0 && results[j].value > results[j - 1].value))
+                    errors++;
+          }
+          list_destroy(&retrieved);
+     }
+
+     printf("%sTop-%u query errors: %u%s\n", errors ? red : green, k, errors, none);
+     free(scores);
+     free(results);
+     free(maxfreq);
+     free(weights);
+     listdb_destroy(&queries);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_skips(void)
+{
+     uint i, errors = 0;
+     char *filename = "test_ifindex_skips.bin";
+
+     ListDB corpus = listdb_random(3000, 20, 40);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     ifindex_save(filename, &ifindex);
+     ListDB mapped = listdb_open_mmap(filename);
+
+     IFSkips skips;
+     uint *maxfreq = (uint *) malloc(ifindex.size * sizeof(uint));
+     ifindex_max_frequencies(&ifindex, maxfreq);
+     if (!ifindex_skips_open(&skips, &mapped))
+          errors++;
+     else
+          for (i = 0; i < ifindex.size; i++)
+               if (skips.maxfreq[i] != maxfreq[i])
+                    errors++;
+
+     // seeks and intersections with skip pointers match the ones without them
+     for (i = 0; i < 1000; i++) {
+          uint term = rand() % ifindex.size;
+          uint position = rand() % (ifindex.lists[term].size + 1);
+          uint doc = rand() % corpus.size;
+          if (ifindex_skip_seek(&mapped, &skips, term, position, doc) !=
+              ifindex_skip_seek(&ifindex, NULL, term, position, doc))
+               errors++;
+     }
+     for (i = 0; i < 100; i++) {
+          uint term = rand() % ifindex.size;
+          List docs = list_random(1 + rand() % 40, corpus.size);
+          list_sort_by_item(&docs);
+          list_unique(&docs);
+          if (ifindex_intersection_size(&mapped, &skips, term, &docs) !=
+              list_intersection_size(&ifindex.lists[term], &docs))
+               errors++;
+          list_destroy(&docs);
+     }
+     for (i = 0; i < ifindex.size; i++)
+          if (!list_equal(&mapped.lists[i], &ifindex.lists[i]))
+               errors++;
+
+     printf("%sSkip pointer errors: %u%s\n", errors ? red : green, errors, none);
+     free(maxfreq);
+     listdb_destroy(&mapped);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+     remove(filename);
+
+     return errors;
+}
+
+uint test_append(void)
+{
+     uint i, errors = 0;
+     ListDB corpus = listdb_random(300, 20, 60);
+     ListDB first = listdb_create(200, corpus.dim);
+     ListDB second = listdb_create(100, corpus.dim);
+     for (i = 0; i < corpus.size; i++)
+          if (i < first.size)
+               first.lists[i] = list_duplicate(&corpus.lists[i]);
+          else
+               second.lists[i - first.size] = list_duplicate(&corpus.lists[i]);
+
+     // appending the second part matches the index of the whole corpus
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     ListDB appended = ifindex_make_from_corpus(&first);
+     ifindex_append(&appended, &second, first.size);
+     if (appended.size != ifindex.size || appended.dim != ifindex.dim)
+          errors++;
+     for (i = 0; !errors && i < ifindex.size; i++)
+          if (!list_equal(&appended.lists[i], &ifindex.lists[i]))
+               errors++;
+
+     printf("%sAppend errors: %u%s\n", errors ? red : green, errors, none);
+     listdb_destroy(&appended);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&second);
+     listdb_destroy(&first);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_manifest(void)
+{
+     uint i, j, errors = 0;
+     ListDB corpus = listdb_random(90, 20, 60);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+
+     // three shards (text, binary, text) with a gap of 5 documents before the last one
+     ListDB shard;
+     listdb_init(&shard);
+     shard.dim = corpus.dim;
+     shard.lists = corpus.lists;
+     shard.size = 30;
+     listdb_save_to_file("test_ifindex_shard0.txt", &shard);
+     shard.lists = corpus.lists + 30;
+     listdb_save_binary("test_ifindex_shard1.bin", &shard);
+     shard.lists = corpus.lists + 65;
+     shard.size = 25;
+     listdb_save_to_file("test_ifindex_shard2.txt", &shard);
+     for (i = 60; i < 65; i++)
+          list_destroy(&corpus.lists[i]);
+
+     FILE *file = fopen("test_ifindex_manifest.txt", "w");
+     fprintf(file, "%s\ntest_ifindex_shard0.txt 0\ntest_ifindex_shard1.bin 30\n"
+             "test_ifindex_shard2.txt 65\n", LISTDB_MANIFEST_MAGIC);
+     fclose(file);
+
+     ListDBManifest manifest = listdb_manifest_load("test_ifindex_manifest.txt");
+     ListDB sharded = ifindex_make_from_manifest(&manifest);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     if (sharded.size != ifindex.size || sharded.dim != ifindex.dim)
+          errors++;
+     for (i = 0; !errors && i < ifindex.size; i++) {
+          if (!list_equal(&ifindex.lists[i], &sharded.lists[i]))
+               errors++;
+          for (j = 0; !errors && j < ifindex.lists[i].size; j++)
+               if (ifindex.lists[i].data[j].freq != sharded.lists[i].data[j].freq)
+                    errors++;
+     }
+
+     printf("%sManifest errors: %u%s\n", errors ? red : green, errors, none);
+     listdb_manifest_destroy(&manifest);
+     listdb_destroy(&sharded);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+     remove("test_ifindex_shard0.txt");
+     remove("test_ifindex_shard1.bin");
+     remove("test_ifindex_shard2.txt");
+     remove("test_ifindex_manifest.txt");
+
+     return errors;
+}
+
+uint test_partitions(void)
+{
+     uint i, j, k = 5, errors = 0;
+     ListDB corpus = listdb_random(500, 20, 60);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     IFPartitions partitions = ifindex_partitions_make(&corpus, 3);
+     ListDB queries = listdb_random(20, 8, 60);
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+
+     // merged results of the partitions match the ones of the whole index
+     Score *expected = (Score *) malloc(k * sizeof(Score));
+     Score *results = (Score *) malloc(k * sizeof(Score));
+     if (partitions.dim != corpus.size || partitions.vocsize != ifindex.size)
+          errors++;
+     for (i = 0; i < queries.size; i++) {
+          List retrieved = ifindex_query(&ifindex, &queries.lists[i]);
+          List merged = ifindex_partitions_query(&partitions, &queries.lists[i]);
+          if (!list_equal(&retrieved, &merged))
+               errors++;
+          for (j = 0; j < retrieved.size && j < merged.size; j++)
+               if (retrieved.data[j].freq != merged.data[j].freq)
+                    errors++;
+
+          uint size = ifindex_query_topk(&ifindex, &queries.lists[i], NULL, NULL, k, expected);
+          if (ifindex_partitions_query_topk(&partitions, &queries.lists[i], NULL, k, results) != size)
+               errors++;
+          for (j = 0; j < size; j++)
+               if (results[j].index != expected[j].index || results[j].value != expected[j].value)
+                    errors++;
+          list_destroy(&retrieved);
+          list_destroy(&merged);
+     }
+
+     printf("%sPartition errors: %u%s\n", errors ? red : green, errors, none);
+     free(results);
+     free(expected);
+     listdb_destroy(&queries);
+     ifindex_partitions_destroy(&partitions);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_cache(void)
+{
+     uint i, errors = 0;
+     ListDB corpus = listdb_random(300, 20, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     ListDB queries = listdb_random(10, 8, 50);
+     listdb_apply_to_all(&queries, list_sort_by_item);
+     listdb_apply_to_all(&queries, list_unique);
+
+     // each query is answered twice, the second time from the cache
+     IFCache cache = ifindex_cache_create(IFINDEX_CACHE_CAPACITY);
+     IFAccumulator acc = ifindex_accumulator_create(ifindex.dim);
+     for (i = 0; i < 2 * queries.size; i++) {
+          List *query = &queries.lists[i % queries.size];
+          List expected = ifindex_query_threshold(&ifindex, query, 2, &acc);
+          List cached = ifindex_query_cached(&ifindex, query, 2, &cache, &acc);
+          if (!list_equal(&expected, &cached))
+               errors++;
+          list_destroy(&expected);
+          list_destroy(&cached);
+     }
+     if (cache.hits < queries.size || cache.hits + cache.misses != 2 * queries.size ||
+         cache.size != cache.misses)
+          errors++;
+     ifindex_cache_destroy(&cache);
+
+     // a cache with room for a single result evicts the previous one
+     uint value = 1;
+     cache = ifindex_cache_create(sizeof(IFCacheEntry) + queries.lists[0].size * sizeof(Item) +
+                                  sizeof(uint));
+     ifindex_cache_put(&cache, &queries.lists[0], 0, &value, sizeof(uint));
+     ifindex_cache_put(&cache, &queries.lists[0], 1, &value, sizeof(uint));
+     size_t bytes;
+     uint *found = (uint *) ifindex_cache_get(&cache, &queries.lists[0], 1, &bytes);
+     if (found == NULL || *found != value || bytes != sizeof(uint) || cache.evictions != 1 ||
+         ifindex_cache_get(&cache, &queries.lists[0], 0, &bytes) != NULL)
+          errors++;
+     free(found);
+
+     printf("%sCache errors: %u (hits %llu, misses %llu)%s\n", errors ? red : green, errors,
+            cache.hits, cache.misses, none);
+     ifindex_cache_destroy(&cache);
+     ifindex_accumulator_destroy(&acc);
+     listdb_destroy(&queries);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+void weight_reference(ListDB *ifindex, ListDB *corpus, double (*wg)(uint,uint,uint,uint,uint,uint))
+{
+     uint i, j;
+     uint *docsizes = (uint *) calloc(corpus->size, sizeof(uint));
+     for (i = 0; i < corpus->size; i++)
+          for (j = 0; j < corpus->lists[i].size; j++)
+               docsizes[i] += corpus->lists[i].data[j].freq;
+
+     // one call of the weighting function per posting
+     for (i = 0; i < ifindex->size; i++) {
+          for (j = 0; j < ifindex->lists[i].size; j++) {
+               uint doc = ifindex->lists[i].data[j].item;
+               double wval = wg(ifindex->lists[i].data[j].freq, ifindex->lists[i].size,
+                                docsizes[doc], corpus->lists[doc].size, corpus->size,
+                                ifindex->size);
+               ifindex->lists[i].data[j].freq = weights_intweight(wval);
+               if (ifindex->lists[i].data[j].freq == 0)
+                    ifindex->lists[i].data[j].freq = 1;
+          }
+     }
+     free(docsizes);
+}
+
+uint test_weight(void)
+{
+     uint i, j, s, errors = 0;
+     double (*schemes[])(uint,uint,uint,uint,uint,uint) = {
+          weights_termfreq, weights_logtf, weights_bintf, weights_idf, weights_itf,
+          weights_ids, weights_tfidf, weights_logtfidf, weights_itfidf, weights_logitfidf,
+          weights_tfids, weights_logtfids, weights_itfidfids, weights_logitfidfids,
+          weights_tfdr, weights_logtfdr, weights_drtf, weights_drlogtf};
+     uint number_of_schemes = sizeof(schemes) / sizeof(schemes[0]);
+     ListDB corpus = listdb_random(1000, 30, 300);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     for (i = 0; i < corpus.size; i++) // frequencies in and out of the precomputed table
+          for (j = 0; j < corpus.lists[i].size; j++)
+               corpus.lists[i].data[j].freq = 1 + rand() % (2 * WEIGHTS_TF_TABLE);
+
+     // the parallel weighting gives the same weights as one call per posting
+     for (s = 0; s < number_of_schemes; s++) {
+          ListDB weighted = ifindex_make_from_corpus(&corpus);
+          ListDB expected = ifindex_make_from_corpus(&corpus);
+          ifindex_weight(&weighted, &corpus, schemes[s]);
+          weight_reference(&expected, &corpus, schemes[s]);
+          for (i = 0; i < expected.size; i++)
+               for (j = 0; j < expected.lists[i].size; j++)
+                    if (expected.lists[i].data[j].freq != weighted.lists[i].data[j].freq)
+                         errors++;
+          listdb_destroy(&weighted);
+          listdb_destroy(&expected);
+     }
+
+     printf("%sWeighting errors: %u%s\n", errors ? red : green, errors, none);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
+uint test_stats(void)
+{
+     uint i, j, k, errors = 0;
+     char *corpus_file = "test_ifindex_corpus.bin", *stats_file = "test_ifindex_stats.bin";
+     ListDB corpus = listdb_random(300, 20, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     for (i = 0; i < corpus.size; i++)
+          for (j = 0; j < corpus.lists[i].size; j++)
+               corpus.lists[i].data[j].freq = 1 + rand() % 4;
+     listdb_save_binary(corpus_file, &corpus);
+
+     ListDBReader reader;
+     listdb_reader_open(&reader, corpus_file, LISTDB_BATCH_ITEMS);
+     weights_stats_save(stats_file, &reader);
+     listdb_reader_close(&reader);
+     StatsFile stats;
+     weights_stats_open(&stats, stats_file);
+
+     // statistics match the inverted file and weights computed from the corpus
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     uint *maxfreq = (uint *) malloc(ifindex.size * sizeof(uint));
+     ifindex_max_frequencies(&ifindex, maxfreq);
+     if (stats.header->number_of_docs != corpus.size || stats.header->number_of_terms != ifindex.size)
+          errors++;
+     for (i = 0; !errors && i < ifindex.size; i++)
+          if (stats.df[i] != ifindex.lists[i].size || stats.maxfreq[i] != maxfreq[i] ||
+              stats.cumfreq[i] != maxfreq[i] + (i > 0 ? stats.cumfreq[i - 1] : 0))
+               errors++;
+
+     // saved inverted files are weighted whether they are loaded or mapped
+     char *ifindex_file = "test_ifindex_stats_if.bin";
+     ifindex_save(ifindex_file, &ifindex);
+     ListDB weighted[3];
+     weighted[0] = ifindex_make_from_corpus(&corpus);
+     weighted[1] = listdb_load(ifindex_file);
+     weighted[2] = listdb_open_mmap(ifindex_file);
+     ifindex_weight(&ifindex, &corpus, weights_logtfdr);
+     for (k = 0; k < 3; k++) {
+          ifindex_weight_stats(&weighted[k], &stats, weights_logtfdr);
+          if (weighted[k].size != ifindex.size)
+               errors++;
+          for (i = 0; !errors && i < ifindex.size; i++)
+               for (j = 0; j < ifindex.lists[i].size; j++)
+                    if (ifindex.lists[i].data[j].freq != weighted[k].lists[i].data[j].freq)
+                         errors++;
+          listdb_destroy(&weighted[k]);
+     }
+
+     printf("%sStatistics errors: %u%s\n", errors ? red : green, errors, none);
+     free(maxfreq);
+     weights_stats_close(&stats);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+     remove(corpus_file);
+     remove(stats_file);
+     remove(ifindex_file);
+
+     return errors;
+}
+
+uint test_weights(void)
+{
+     uint i, j, k, errors = 0;
+     char *binary_file = "test_ifindex_weights.bin", *text_file = "test_ifindex_weights.txt";
+     ListDB corpus = listdb_random(300, 20, 50);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     double *weights = weights_from_corpus_and_ifindex(&corpus, &ifindex, weights_idf);
+     weights_save_binary(binary_file, ifindex.size, weights, WEIGHTS_IDF,
+                         weights_fingerprint_listdb(&corpus));
+     weights_save_to_file(text_file, ifindex.size, weights);
+     if (!weights_is_binary(binary_file) || weights_is_binary(text_file))
+          errors++;
+
+     // mapped weights are bit-identical and belong to the corpus
+     WeightsFile file;
+     weights_open_mmap(&file, binary_file);
+     if (file.header->size != ifindex.size || file.header->scheme != WEIGHTS_IDF ||
+         memcmp(file.weights, weights, ifindex.size * sizeof(double)) != 0)
+          errors++;
+     weights_validate_listdb(&file, &corpus);
+
+     // weights of another corpus are rejected when they are loaded: an
+     // item moves to another list, one item is added and one term is
+     // missing
+     ListDB others[3];
+     for (k = 0; k < 3; k++) {
+          others[k] = listdb_create(corpus.size, corpus.dim);
+          for (i = 0; i < corpus.size; i++)
+               others[k].lists[i] = list_duplicate(&corpus.lists[i]);
+     }
+     Item item = {0, 1};
+     for (j = 1; others[0].lists[j].size == 0; j++);
+     list_pop(&others[0].lists[j]);
+     list_push(&others[0].lists[0], item);
+     list_push(&others[1].lists[0], item);
+     others[2].dim--;
+     int status;
+     pid_t pid;
+     for (k = 0; k < 3; k++) {
+          fflush(stdout); // the child must not print the buffered output again
+          pid = fork();
+          if (pid == 0) {
+               weights_validate_listdb(&file, &others[k]);
+               exit(EXIT_SUCCESS);
+          }
+          waitpid(pid, &status, 0);
+          if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_FAILURE)
+               errors++;
+          listdb_destroy(&others[k]);
+     }
+     weights_close(&file);
+
+     // truncated files are rejected when they are mapped
+     truncate(binary_file, sizeof(WeightsHeader) + sizeof(double));
+     fflush(stdout);
+     pid = fork();
+     if (pid == 0) {
+          weights_open_mmap(&file, binary_file);
+          exit(EXIT_SUCCESS);
+     }
+     waitpid(pid, &status, 0);
+     if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_FAILURE)
+          errors++;
+
+     printf("%sBinary weights errors: %u%s\n", errors ? red : green, errors, none);
+     free(weights);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+     remove(binary_file);
+     remove(text_file);
+
+     return errors;
+}
+
+/**
+ * Prunes the lists of a database and pushes an item to each of them
+ */
+void prune_and_grow(ListDB *listdb)
+{
+     uint i;
+     Item item = {7, 3};
+     ifindex_discard_less_frequent(listdb, 3);
+     for (i = 0; i < listdb->size; i++) {
+          list_sort_by_item(&listdb->lists[i]);
+          list_push(&listdb->lists[i], item);
+     }
+}
+
+uint test_mutable(void)
+{
+     uint i, k, errors = 0;
+     char *filenames[2] = {"test_mutable.txt", "test_mutable.bin"};
+     ListDB corpus = listdb_random(200, 20, 60);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     listdb_save_to_file(filenames[0], &corpus);
+     listdb_save_binary(filenames[1], &corpus);
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+     prune_and_grow(&corpus);
+     prune_and_grow(&ifindex);
+
+     // loaded databases and their inverted files can be modified in place
+     for (k = 0; k < 2; k++) {
+          ListDB loaded = k == 0 ? listdb_load_from_file(filenames[k]) : listdb_load(filenames[k]);
+          ListDB loaded_ifindex = ifindex_make_from_corpus(&loaded);
+          prune_and_grow(&loaded);
+          prune_and_grow(&loaded_ifindex);
+          if (loaded.size != corpus.size || loaded_ifindex.size != ifindex.size)
+               errors++;
+          for (i = 0; !errors && i < corpus.size; i++)
+               if (!list_equal(&loaded.lists[i], &corpus.lists[i]))
+                    errors++;
+          for (i = 0; !errors && i < ifindex.size; i++)
+               if (!list_equal(&loaded_ifindex.lists[i], &ifindex.lists[i]))
+                    errors++;
+          listdb_destroy(&loaded_ifindex);
+          listdb_destroy(&loaded);
+          remove(filenames[k]);
+     }
+
+     printf("%sMutable database errors: %u%s\n", errors ? red : green, errors, none);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+
+     return errors;
+}
+
 int main()
 {
+     uint errors = 0;
      srand((long int) time(NULL));
      
      test_query();
+     errors += test_query_threshold();
+     errors += test_query_roaring();
+     errors += test_query_batch();
+     errors += test_query_topk();
+     errors += test_skips();
+     errors += test_append();
+     errors += test_manifest();
+     errors += test_partitions();
+     errors += test_cache();
+     errors += test_weight();
+     errors += test_stats();
+     errors += test_weights();
+     errors += test_mutable();
      
-     return 0;
+     return errors != 0;
 }
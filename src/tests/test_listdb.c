@@ -141,6 +141,132 @@ void test_append_add(void)
 	printf("%s", none);
 }
 
+uint test_similarity_batch(void)
+{
+	uint i, errors = 0;
+	double thres = 0.1;
+	ListDB listdb = listdb_random(200, 100, 300);
+	listdb_apply_to_all(&listdb, list_sort_by_item);
+	listdb_apply_to_all(&listdb, list_unique);
+
+	List candidates;
+	list_init(&candidates);
+	for (i = 0; i < listdb.size; i++) {
+		Item item = {i, 1};
+		list_push(&candidates, item);
+	}
+
+	ullong *passed = (ullong *) malloc(((candidates.size + 63) / 64) * sizeof(ullong));
+	listdb_similarity_batch(&listdb, &listdb.lists[0], &candidates, LIST_OVERLAP, thres, passed);
+	for (i = 0; i < candidates.size; i++)
+		if (((passed[i / 64] >> (i % 64)) & 1ULL) !=
+		    (list_overlap(&listdb.lists[0], &listdb.lists[i]) > thres))
+			errors++;
+
+	listdb_similarity_batch(&listdb, &listdb.lists[0], &candidates, LIST_JACCARD, thres, passed);
+	for (i = 0; i < candidates.size; i++)
+		if (((passed[i / 64] >> (i % 64)) & 1ULL) !=
+		    (list_jaccard(&listdb.lists[0], &listdb.lists[i]) > thres))
+			errors++;
+
+	printf("%sBatch similarity errors: %u%s\n", errors ? red : green, errors, none);
+
+	free(passed);
+	list_destroy(&candidates);
+	listdb_destroy(&listdb);
+
+	return errors;
+}
+
+uint test_binary(void)
+{
+	uint i, errors = 0;
+	char *filename = "test_listdb.bin";
+	ListDB listdb = listdb_random(50, 100, 300);
+	listdb_save_binary(filename, &listdb);
+
+	ListDB mapped = listdb_open_mmap(filename);
+	ListDB loaded = listdb_load(filename);
+	if (mapped.size != listdb.size || mapped.dim != listdb.dim || mapped.storage != LISTDB_MAPPED)
+		errors++;
+	if (loaded.size != listdb.size || loaded.storage == LISTDB_MAPPED)
+		errors++;
+	for (i = 0; !errors && i < listdb.size; i++)
+		if (!list_equal(&listdb.lists[i], &mapped.lists[i]) ||
+		    !list_equal(&listdb.lists[i], &loaded.lists[i]))
+			errors++;
+
+	// loaded and unmapped lists are written in place
+	listdb_unmap(&mapped);
+	for (i = 0; !errors && i < listdb.size; i++) {
+		if (mapped.lists[i].size == 0)
+			continue;
+		mapped.lists[i].data[0].freq++;
+		loaded.lists[i].data[0].freq++;
+		if (!list_equal(&loaded.lists[i], &mapped.lists[i]))
+			errors++;
+	}
+	if (mapped.storage == LISTDB_MAPPED)
+		errors++;
+
+	printf("%sBinary database errors: %u%s\n", errors ? red : green, errors, none);
+
+	listdb_destroy(&mapped);
+	listdb_destroy(&loaded);
+	listdb_destroy(&listdb);
+	remove(filename);
+
+	return errors;
+}
+
+uint test_text(void)
+{
+	uint i, j, errors = 0;
+	char *filename = "test_listdb.txt";
+	ListDB listdb = listdb_random(30000, 100, 100000); // spans several chunks
+	uint dim = 0;
+
+	// blank lines, carriage returns and a last line without newline
+	FILE *file = fopen(filename, "w");
+	for (i = 0; i < listdb.size; i++) {
+		if (i % 1000 == 0)
+			fprintf(file, "\n");
+		fprintf(file, "%u", listdb.lists[i].size);
+		for (j = 0; j < listdb.lists[i].size; j++) {
+			fprintf(file, " %u:%u", listdb.lists[i].data[j].item, listdb.lists[i].data[j].freq);
+			if (dim < listdb.lists[i].data[j].item + 1)
+				dim = listdb.lists[i].data[j].item + 1;
+		}
+		if (i + 1 < listdb.size)
+			fprintf(file, i % 7 == 0 ? "\r\n" : "\n");
+	}
+	fclose(file);
+
+	ListDB loaded = listdb_load_from_file(filename);
+	ListDB arena = listdb_load_from_file_arena(filename);
+	if (loaded.size != listdb.size || loaded.dim != dim || loaded.storage != LISTDB_HEAP)
+		errors++;
+	if (arena.size != listdb.size || arena.dim != dim || arena.storage != LISTDB_ARENA)
+		errors++;
+	for (i = 0; !errors && i < listdb.size; i++) {
+		if (!list_equal(&listdb.lists[i], &loaded.lists[i])
+		    || !list_equal(&listdb.lists[i], &arena.lists[i]))
+			errors++;
+		for (j = 0; !errors && j < listdb.lists[i].size; j++)
+			if (listdb.lists[i].data[j].freq != loaded.lists[i].data[j].freq
+			    || listdb.lists[i].data[j].freq != arena.lists[i].data[j].freq)
+				errors++;
+	}
+
+	printf("%sText database errors: %u%s\n", errors ? red : green, errors, none);
+	listdb_destroy(&arena);
+	listdb_destroy(&loaded);
+	listdb_destroy(&listdb);
+	remove(filename);
+
+	return errors;
+}
+
 void test_load(char *input, char *output)
 {
 	ListDB listdb = listdb_load_from_file(input);
@@ -148,13 +274,248 @@ void test_load(char *input, char *output)
 	printf ("Read database of %d lists (max item = %d)\n", listdb.size, listdb.dim);
 }
 
+uint test_reader(void)
+{
+	uint i, b, round, errors = 0;
+	char *filenames[2] = {"test_listdb.txt", "test_listdb.bin"};
+	ListDB listdb = listdb_random(50, 100, 300);
+	listdb_save_to_file(filenames[0], &listdb);
+	listdb_save_binary(filenames[1], &listdb);
+
+	for (i = 0; i < 2; i++) {
+		ListDBReader reader;
+		ListDB batch = listdb_create(0, 0);
+		listdb_reader_open(&reader, filenames[i], 500);
+		for (round = 0; round < 2; round++) {
+			uint read = 0;
+			while (listdb_reader_next_batch(&reader, &batch) > 0) {
+				if (batch.lists != NULL && reader.batch_start != read)
+					errors++;
+				for (b = 0; b < batch.size; b++)
+					if (read + b >= listdb.size
+					    || !list_equal(&listdb.lists[read + b], &batch.lists[b]))
+						errors++;
+				read += batch.size;
+			}
+			if (read != listdb.size || reader.size != listdb.size)
+				errors++;
+			listdb_reader_rewind(&reader);
+		}
+		listdb_destroy(&batch);
+		listdb_reader_close(&reader);
+		remove(filenames[i]);
+	}
+
+	printf("%sStreaming reader errors: %u%s\n", errors ? red : green, errors, none);
+	listdb_destroy(&listdb);
+
+	return errors;
+}
+
+uint test_arena(void)
+{
+	uint i, j, errors = 0;
+	ListDB listdb = listdb_random(100, 50, 300);
+	uint *sizes = (uint *) malloc(listdb.size * sizeof(uint));
+	for (i = 0; i < listdb.size; i++)
+		sizes[i] = listdb.lists[i].size;
+
+	ListDB arena = listdb_create_arena(listdb.size, listdb.dim, sizes);
+	for (i = 0; i < listdb.size; i++)
+		for (j = 0; j < listdb.lists[i].size; j++)
+			arena.lists[i].data[j] = listdb.lists[i].data[j];
+	free(sizes);
+
+	// copy-on-grow of a list and deletion of lists from the arena
+	Item item = {7, 3};
+	listdb_detach_list(&arena, 0);
+	list_push(&arena.lists[0], item);
+	list_push(&listdb.lists[0], item);
+	listdb_delete_position(&arena, 1);
+	listdb_delete_position(&listdb, 1);
+	listdb_add_lists_destroy(&arena, 2, 3);
+	listdb_add_lists_destroy(&listdb, 2, 3);
+	listdb_delete_smallest(&arena, 10);
+	listdb_delete_smallest(&listdb, 10);
+
+	if (arena.size != listdb.size || arena.storage != LISTDB_ARENA || !arena.detached)
+		errors++;
+	for (i = 0; !errors && i < listdb.size; i++)
+		if (!list_equal(&listdb.lists[i], &arena.lists[i]))
+			errors++;
+
+	printf("%sArena database errors: %u%s\n", errors ? red : green, errors, none);
+	listdb_destroy(&arena);
+	listdb_destroy(&listdb);
+
+	return errors;
+}
+
+uint test_access(void)
+{
+	uint i, errors = 0;
+	char *filename = "test_listdb_access.bin";
+	ListDB listdb = listdb_random(2000, 100, 300);
+	listdb_save_binary(filename, &listdb);
+	listdb_destroy(&listdb);
+
+	// reading a few lists of a mapped database only touches their pages
+	ListDB mapped = listdb_open_mmap(filename);
+	listdb_advise(&mapped, LISTDB_ACCESS_RANDOM);
+	listdb_track_access(&mapped);
+	ullong bytes = 0;
+	for (i = 0; i < 10; i++) {
+		listdb_record_access(&mapped, i * 200);
+		listdb_record_access(&mapped, i * 200); // pages are counted once
+		bytes += 2 * mapped.lists[i * 200].size * sizeof(Item);
+	}
+	ullong pages = mapped.access->pages;
+	if (mapped.access->lists != 20 || mapped.access->bytes != bytes ||
+	    (bytes > 0 && pages == 0) ||
+	    pages * mapped.access->page_size > bytes / 2 + 20 * mapped.access->page_size)
+		errors++;
+
+	listdb_track_access(&mapped);
+	if (mapped.access->lists != 0 || mapped.access->pages != 0)
+		errors++;
+
+	printf("%sAccess counters (%llu bytes in %llu pages) errors: %u%s\n", errors ? red : green,
+	       bytes, pages, errors, none);
+
+	listdb_destroy(&mapped);
+	remove(filename);
+
+	return errors;
+}
+
+uint test_manifest(void)
+{
+	uint i, errors = 0;
+	ListDB listdb = listdb_random(90, 50, 300);
+
+	// three shards (text, binary, text) with a gap of 5 ids before the last one
+	ListDB shard;
+	listdb_init(&shard);
+	shard.lists = listdb.lists;
+	shard.size = 30;
+	listdb_save_to_file("test_shard0.txt", &shard);
+	shard.lists = listdb.lists + 30;
+	listdb_save_binary("test_shard1.bin", &shard);
+	shard.lists = listdb.lists + 65;
+	shard.size = 25;
+	listdb_save_to_file("test_shard2.txt", &shard);
+	for (i = 60; i < 65; i++)
+		list_destroy(&listdb.lists[i]);
+
+	FILE *file = fopen("test_manifest.txt", "w");
+	fprintf(file, "%s\ntest_shard0.txt 0\ntest_shard1.bin 30\ntest_shard2.txt 65\n",
+		LISTDB_MANIFEST_MAGIC);
+	fclose(file);
+
+	ListDB loaded = listdb_load("test_manifest.txt");
+	if (loaded.size != listdb.size)
+		errors++;
+	for (i = 0; !errors && i < listdb.size; i++)
+		if (!list_equal(&listdb.lists[i], &loaded.lists[i]))
+			errors++;
+
+	ListDBReader reader;
+	ListDB batch = listdb_create(0, 0);
+	listdb_reader_open(&reader, "test_manifest.txt", 200);
+	while (listdb_reader_next_batch(&reader, &batch) > 0)
+		for (i = 0; i < batch.size; i++)
+			if (!list_equal(&listdb.lists[reader.batch_start + i], &batch.lists[i]))
+				errors++;
+	if (reader.size != listdb.size)
+		errors++;
+	listdb_destroy(&batch);
+	listdb_reader_close(&reader);
+
+	printf("%sManifest errors: %u%s\n", errors ? red : green, errors, none);
+	listdb_destroy(&loaded);
+	listdb_destroy(&listdb);
+	remove("test_shard0.txt");
+	remove("test_shard1.bin");
+	remove("test_shard2.txt");
+	remove("test_manifest.txt");
+
+	return errors;
+}
+
+uint test_csr(void)
+{
+	uint i, j, errors = 0;
+	ListDB listdb = listdb_random(100, 50, 300);
+	listdb_apply_to_all(&listdb, list_sort_by_item);
+	listdb_apply_to_all(&listdb, list_unique);
+	listdb.dim = 301;
+
+	// CSR arrays of the database
+	ullong *indptr = (ullong *) malloc((listdb.size + 1) * sizeof(ullong));
+	listdb_csr_indptr(&listdb, indptr);
+	uint *indices = (uint *) malloc((indptr[listdb.size] + 1) * sizeof(uint));
+	uint *data = (uint *) malloc((indptr[listdb.size] + 1) * sizeof(uint));
+	listdb_to_csr(&listdb, indices, data);
+
+	ListDB csr = listdb_from_csr(listdb.size, listdb.dim, indptr, indices, data);
+	if (csr.size != listdb.size || csr.dim != listdb.dim || csr.storage != LISTDB_HEAP)
+		errors++;
+	for (i = 0; !errors && i < listdb.size; i++)
+		if (!list_equal(&listdb.lists[i], &csr.lists[i]))
+			errors++;
+
+	// items of an arena are the entries of the CSR matrix
+	uint *sizes = (uint *) malloc(listdb.size * sizeof(uint));
+	for (i = 0; i < listdb.size; i++)
+		sizes[i] = listdb.lists[i].size;
+	ListDB arena = listdb_create_arena(listdb.size, listdb.dim, sizes);
+	for (i = 0; i < listdb.size; i++)
+		for (j = 0; j < listdb.lists[i].size; j++)
+			arena.lists[i].data[j] = csr.lists[i].data[j];
+	Item *items = listdb_contiguous_items(&arena);
+	for (i = 0; !errors && i < indptr[listdb.size]; i++)
+		if (items[i].item != indices[i] || items[i].freq != data[i])
+			errors++;
+	if (listdb_contiguous_items(&listdb) != NULL)
+		errors++;
+	listdb_destroy(&arena);
+	free(sizes);
+
+	double *array = (double *) calloc(listdb.size * listdb.dim, sizeof(double));
+	listdb_to_dense(&csr, array);
+	for (i = 0; !errors && i < listdb.size; i++)
+		for (j = 0; j < listdb.lists[i].size; j++)
+			if (array[i * listdb.dim + listdb.lists[i].data[j].item] !=
+			    listdb.lists[i].data[j].freq)
+				errors++;
+
+	printf("%sCSR interchange errors: %u%s\n", errors ? red : green, errors, none);
+	free(array);
+	free(data);
+	free(indices);
+	free(indptr);
+	listdb_destroy(&csr);
+	listdb_destroy(&listdb);
+
+	return errors;
+}
+
 int main(int argc, char **argv)
 {
+	uint errors = 0;
 	srand((long int) time(NULL));
 	/* test_load(argv[1], argv[2]); */
 	/* test_delete_insert_push(); */
 	/* test_append_add();  */
 	test_random_sort_delete_print();
+	errors += test_similarity_batch();
+	errors += test_binary();
+	errors += test_text();
+	errors += test_reader();
+	errors += test_arena();
+	errors += test_manifest();
+	errors += test_access();
+	errors += test_csr();
 
-	return 0;
+	return errors != 0;
 }
@@ -39,11 +39,115 @@ void test_prune(uint stop, uint dochits, double ovr_perc, double cooc_perc)
      listdb_print(&listdb);
 }
 
+/**
+ * Prunes co-occurring sets one at a time with plain list operations
+ */
+void prune_reference(ListDB *ifindex, ListDB *mined, uint stop, uint hits, double ovr, double cooc)
+{
+     uint i, j;
+     for (i = 0; i < mined->size; i++) {
+          uint ovr_th = (uint) round((double) mined->lists[i].size * ovr);
+          List retdoc = ifindex_query(ifindex, &mined->lists[i]);
+          list_delete_less_frequent(&retdoc, ovr_th);
+          list_sort_by_item(&retdoc);
+
+          uint cooc_th = (uint) round((double) retdoc.size * cooc);
+          for (j = 0; j < mined->lists[i].size; j++)
+               if (list_intersection_size(&ifindex->lists[mined->lists[i].data[j].item], &retdoc) < cooc_th)
+                    list_delete_position(&mined->lists[i], j);
+
+          if (retdoc.size < hits)
+               list_destroy(&mined->lists[i]);
+          list_destroy(&retdoc);
+     }
+     listdb_delete_smallest(mined, stop);
+}
+
+uint compare_pruned(ListDB *expected, ListDB *pruned)
+{
+     uint i, errors = expected->size != pruned->size;
+     for (i = 0; !errors && i < expected->size; i++)
+          if (!list_equal(&expected->lists[i], &pruned->lists[i]))
+               errors++;
+
+     return errors;
+}
+
+uint test_prune_variants(void)
+{
+     uint i, errors = 0;
+     uint stop = 3, hits = 2;
+     double ovr = 0.5, cooc = 0.6;
+     uint j;
+     ListDB corpus = listdb_random(3000, 30, 200);
+     listdb_apply_to_all(&corpus, list_sort_by_item);
+     listdb_apply_to_all(&corpus, list_unique);
+     for (i = 0; i < corpus.size; i++) // roaring bitmaps only hold sets
+          for (j = 0; j < corpus.lists[i].size; j++)
+               corpus.lists[i].data[j].freq = 1;
+     ListDB ifindex = ifindex_make_from_corpus(&corpus);
+
+     // pruned sets are stored in an arena, as when they are loaded from a file
+     ListDB mined = listdb_random(IFINDEX_QUERY_BATCH + 500, 8, 200);
+     listdb_apply_to_all(&mined, list_sort_by_item);
+     listdb_apply_to_all(&mined, list_unique);
+     listdb_delete_smallest(&mined, 2);
+     listdb_save_binary("test_prune_mined.bin", &mined);
+     uint number_of_sets = mined.size;
+     ListDB expected = mined;
+     prune_reference(&ifindex, &expected, stop, hits, ovr, cooc);
+
+     // sets pruned twice with the same cache get the second results from it
+     IFCache cache = ifindex_cache_create(IFINDEX_CACHE_CAPACITY);
+     for (i = 0; i < 2; i++) {
+          ListDB pruned = listdb_load("test_prune_mined.bin");
+          sampledmh_prune_cached(&ifindex, &pruned, stop, hits, ovr, cooc, &cache);
+          errors += compare_pruned(&expected, &pruned);
+          listdb_destroy(&pruned);
+     }
+     if (cache.hits < number_of_sets)
+          errors++;
+     ifindex_cache_destroy(&cache);
+
+     IFPartitions partitions = ifindex_partitions_make(&corpus, 3);
+     ListDB pruned = listdb_load("test_prune_mined.bin");
+     sampledmh_prune_partitioned(&partitions, &pruned, stop, hits, ovr, cooc);
+     errors += compare_pruned(&expected, &pruned);
+     listdb_destroy(&pruned);
+     ifindex_partitions_destroy(&partitions);
+
+     CListDB cifindex = clistdb_from_listdb(&ifindex);
+     pruned = listdb_load("test_prune_mined.bin");
+     sampledmh_prune_compressed(&cifindex, &pruned, stop, hits, ovr, cooc);
+     errors += compare_pruned(&expected, &pruned);
+     listdb_destroy(&pruned);
+     clistdb_destroy(&cifindex);
+
+     RoaringDB rifindex = roaringdb_from_listdb(&ifindex);
+     pruned = listdb_load("test_prune_mined.bin");
+     sampledmh_prune_roaring(&rifindex, &pruned, stop, hits, ovr, cooc);
+     errors += compare_pruned(&expected, &pruned);
+     listdb_destroy(&pruned);
+     roaringdb_destroy(&rifindex);
+
+     printf("%sPrune (%u of %u sets left) errors: %u%s\n", errors ? red : green, expected.size,
+            number_of_sets, errors, none);
+     listdb_destroy(&expected);
+     listdb_destroy(&ifindex);
+     listdb_destroy(&corpus);
+     remove("test_prune_mined.bin");
+
+     return errors;
+}
+
 int main(int argc, char **argv)
 {
+     uint errors = 0;
      /* srand((long int) time(NULL)); */
      srand(1234566);
-     test_prune(atoi(argv[1]), atoi(argv[2]), atof(argv[3]), atof(argv[4]));
+     if (argc > 4)
+          test_prune(atoi(argv[1]), atoi(argv[2]), atof(argv[3]), atof(argv[4]));
+     errors += test_prune_variants();
 	 
-     return 0;
+     return errors != 0;
 }
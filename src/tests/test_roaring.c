@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "roaring.h"
+
+#define red "\033[0;31m"
+#define cyan "\033[0;36m"
+#define green "\033[0;32m"
+#define blue "\033[0;34m"
+#define brown "\033[0;33m"
+#define magenta "\033[0;35m"
+#define none "\033[0m"
+
+#define NUMBER_OF_CHUNKS 4
+
+/**
+ * Makes a list whose chunks have very different densities so that
+ * the three types of containers are used
+ */
+List make_list(void)
+{
+     uint i, c;
+     List list;
+     list_init(&list);
+
+     for (c = 0; c < NUMBER_OF_CHUNKS; c++) {
+          uint type = rand() % 3;
+          uint start = c * ROARING_CHUNK_SIZE;
+          for (i = 0; i < ROARING_CHUNK_SIZE; i++) {
+               if ((type == 0 && rand() % 100 == 0) ||
+                   (type == 1 && rand() % 2 == 0) ||
+                   (type == 2 && (i / 1000) % 2 == 0)) {
+                    Item item = {start + i, 1};
+                    list_push(&list, item);
+               }
+          }
+     }
+
+     return list;
+}
+
+uint test_and_or(void)
+{
+     List list1 = make_list();
+     List list2 = make_list();
+
+     Roaring bitmap1 = roaring_from_list(&list1);
+     Roaring bitmap2 = roaring_from_list(&list2);
+     printf("%sBitmap 1 ::: ", brown);
+     roaring_print(&bitmap1);
+     printf("%sBitmap 2 ::: ", brown);
+     roaring_print(&bitmap2);
+     printf("%sList: %zu bytes, bitmap: %zu bytes\n", cyan, list1.size * sizeof(Item),
+            roaring_memory(&bitmap1));
+
+     uint errors = 0;
+     List decoded = roaring_to_list(&bitmap1);
+     errors += !list_equal(&list1, &decoded);
+     printf("%sDecoding %s\n", list_equal(&list1, &decoded) ? green : red,
+            list_equal(&list1, &decoded) ? "OK" : "FAILED");
+
+     List inter = list_intersection(&list1, &list2);
+     Roaring and = roaring_and(&bitmap1, &bitmap2);
+     List and_list = roaring_to_list(&and);
+     errors += !list_equal(&inter, &and_list) ||
+          inter.size != roaring_and_cardinality(&bitmap1, &bitmap2);
+     printf("%sAND %s (%u, cardinality %u)\n", list_equal(&inter, &and_list) ? green : red,
+            list_equal(&inter, &and_list) ? "OK" : "FAILED", inter.size,
+            roaring_and_cardinality(&bitmap1, &bitmap2));
+
+     List uni = list_union(&list1, &list2);
+     Roaring or = roaring_or(&bitmap1, &bitmap2);
+     List or_list = roaring_to_list(&or);
+     errors += !list_equal(&uni, &or_list);
+     printf("%sOR %s (%u)\n", list_equal(&uni, &or_list) ? green : red,
+            list_equal(&uni, &or_list) ? "OK" : "FAILED", uni.size);
+
+     uint id = rand() % (NUMBER_OF_CHUNKS * ROARING_CHUNK_SIZE);
+     Item item = {id, 1};
+     errors += !roaring_contains(&bitmap1, id) != (list_binary_search(&list1, item) == NULL);
+     printf("%sContains %u: %d (list %d)\n", magenta, id, roaring_contains(&bitmap1, id),
+            list_binary_search(&list1, item) != NULL);
+     printf("%s", none);
+
+     list_destroy(&list1);
+     list_destroy(&list2);
+     list_destroy(&decoded);
+     list_destroy(&inter);
+     list_destroy(&and_list);
+     list_destroy(&uni);
+     list_destroy(&or_list);
+     roaring_destroy(&bitmap1);
+     roaring_destroy(&bitmap2);
+     roaring_destroy(&and);
+     roaring_destroy(&or);
+
+     return errors;
+}
+
+int main()
+{
+     uint errors = 0;
+     srand((long int) time(NULL));
+
+     errors += test_and_or();
+
+     return errors != 0;
+}
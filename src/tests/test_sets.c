@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "sets.h"
+
+#define red "\033[0;31m"
+#define cyan "\033[0;36m"
+#define green "\033[0;32m"
+#define blue "\033[0;34m"
+#define brown "\033[0;33m"
+#define magenta "\033[0;35m"
+#define none "\033[0m"
+
+#define MAX_LIST_SIZE 100
+#define ELEMENT_MAX_VALUE 500
+
+uint test_conversion(void)
+{
+     ListDB listdb = listdb_random(20, MAX_LIST_SIZE, ELEMENT_MAX_VALUE);
+     listdb_apply_to_all(&listdb, list_sort_by_item);
+     listdb_apply_to_all(&listdb, list_unique);
+
+     uint i, j, errors = 0;
+     size_t bytes = 0;
+     for (i = 0; i < listdb.size; i++) {
+          bytes += listdb.lists[i].size * sizeof(Item);
+          for (j = 0; j < listdb.lists[i].size; j++)
+               listdb.lists[i].data[j].freq = 1;
+     }
+
+     SetDB setdb = setdb_from_listdb(&listdb);
+     ListDB converted = setdb_to_listdb(&setdb);
+     for (i = 0; i < listdb.size; i++)
+          if (!list_equal(&listdb.lists[i], &converted.lists[i]))
+               errors++;
+
+     printf("%s=========================\nSet\n=========================\n", brown);
+     set_print(&setdb.sets[0]);
+     printf("%sLists: %zu bytes, sets: %zu bytes\n", cyan, bytes,
+            setdb_memory(&setdb) - setdb.size * sizeof(Set));
+     printf("%sConversion errors: %u%s\n", errors ? red : green, errors, none);
+
+     listdb_destroy(&converted);
+     setdb_destroy(&setdb);
+     listdb_destroy(&listdb);
+
+     return errors;
+}
+
+uint test_similarity(void)
+{
+     uint i, errors = 0;
+     double thres = 0.1;
+     ListDB listdb = listdb_random(200, MAX_LIST_SIZE, ELEMENT_MAX_VALUE);
+     listdb_apply_to_all(&listdb, list_sort_by_item);
+     listdb_apply_to_all(&listdb, list_unique);
+     SetDB setdb = setdb_from_listdb(&listdb);
+
+     List candidates;
+     list_init(&candidates);
+     for (i = 0; i < setdb.size; i++) {
+          Item item = {i, 1};
+          list_push(&candidates, item);
+          if (set_overlap(&setdb.sets[0], &setdb.sets[i]) !=
+              list_overlap(&listdb.lists[0], &listdb.lists[i]) ||
+              set_jaccard(&setdb.sets[0], &setdb.sets[i]) !=
+              list_jaccard(&listdb.lists[0], &listdb.lists[i]))
+               errors++;
+     }
+
+     ullong *passed = (ullong *) malloc(((candidates.size + 63) / 64) * sizeof(ullong));
+     setdb_similarity_batch(&setdb, &setdb.sets[0], &candidates, LIST_OVERLAP, thres, passed);
+     for (i = 0; i < candidates.size; i++)
+          if (((passed[i / 64] >> (i % 64)) & 1ULL) !=
+              (set_overlap(&setdb.sets[0], &setdb.sets[i]) > thres))
+               errors++;
+
+     printf("%sSimilarity errors: %u%s\n", errors ? red : green, errors, none);
+
+     free(passed);
+     list_destroy(&candidates);
+     setdb_destroy(&setdb);
+     listdb_destroy(&listdb);
+
+     return errors;
+}
+
+int main()
+{
+     uint errors = 0;
+     srand((long int) time(NULL));
+
+     errors += test_conversion();
+     errors += test_similarity();
+
+     return errors != 0;
+}